@@ -0,0 +1,1080 @@
+#ifndef SIMD_GRANODI_ARRAY_H
+#define SIMD_GRANODI_ARRAY_H
+
+/*
+
+SIMD GRANODI ARRAY
+
+Copyright (c) 2021-2022 Jon Ville
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+/*
+
+Kernels over arrays of float, double, int32_t or int64_t, written in terms of
+the C++ classes in simd_granodi.h. Each kernel is a template on the element
+type, and processes one Vec_ps, Vec_pd, Vec_pi32 or Vec_pi64 at a time, with
+the last partial vector handled separately. Arrays need not be aligned.
+
+Kernels taking a thread_count split the array into that many blocks, process
+them on separate threads, and then combine the results. This allocates and
+starts threads, so is not for real-time code. Floating point results can
+differ slightly with the number of threads, as the order of additions
+changes.
+
+- sg_inclusive_scan(), sg_exclusive_scan(): prefix sums
+- sg_argmax(), sg_argmin(): index of the first maximum or minimum
+- sg_find_first_if(): index of the first element matching a vector predicate
+- sg_sort4(), sg_sort8(), sg_sort16(): sorting networks on 1, 2 or 4 vectors
+  of float or int32_t, optionally carrying a Vec_pi32 payload
+- sg_sort_small(): sorts up to 16 floats or int32_ts
+- sg_merge(): merges two sorted arrays of float or int32_t
+- sg_median_filter(): 3, 5, 7 or 9 tap median filter
+- sg_histogram(): counts float or int32_t values into bins
+- sg_dot(), sg_sum(), sg_sum_sq(): sums over float arrays, with a choice of
+  accumulation for precision
+- sg_axpy(), sg_scale(): y += alpha*x and x *= alpha
+
+*/
+
+#include "simd_granodi.h"
+
+#include <cassert>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace simd_granodi {
+
+//
+//
+//
+//
+//
+//
+//
+// Helper section
+// Functions ending in an underscore are implementation details, and may
+// change or be removed
+
+// The 128-bit vector type with elements of type T
+template <typename T>
+using sg_array_vec_t_ = typename SGType<T, 16/sizeof(T)>::value;
+
+// Every element set to the last element of v
+template <typename VecType>
+inline VecType sg_vectorcall(sg_broadcast_last_)(const VecType v,
+    std::integral_constant<std::size_t, 4>)
+{
+    return v.template shuffle<3, 3, 3, 3>();
+}
+template <typename VecType>
+inline VecType sg_vectorcall(sg_broadcast_last_)(const VecType v,
+    std::integral_constant<std::size_t, 2>)
+{
+    return v.template shuffle<1, 1>();
+}
+template <typename VecType>
+inline VecType sg_vectorcall(sg_broadcast_last_)(const VecType v) {
+    return sg_broadcast_last_(v,
+        std::integral_constant<std::size_t, VecType::elem_count>{});
+}
+
+// Every element moved up by one, with zero in element 0
+template <typename VecType>
+inline VecType sg_vectorcall(sg_shift_up_one_)(const VecType v,
+    std::integral_constant<std::size_t, 4>)
+{
+    return typename VecType::compare_t{true, true, true, false}
+        .choose_else_zero(v.template shuffle<2, 1, 0, 3>());
+}
+template <typename VecType>
+inline VecType sg_vectorcall(sg_shift_up_one_)(const VecType v,
+    std::integral_constant<std::size_t, 2>)
+{
+    return typename VecType::compare_t{true, false}
+        .choose_else_zero(v.template shuffle<0, 1>());
+}
+template <typename VecType>
+inline VecType sg_vectorcall(sg_shift_up_one_)(const VecType v) {
+    return sg_shift_up_one_(v,
+        std::integral_constant<std::size_t, VecType::elem_count>{});
+}
+
+// The vector of integers with the same element count as sg_array_vec_t_<T>,
+// used for indices
+template <typename T>
+using sg_array_index_t_ = typename SGIntType<sizeof(T), 16/sizeof(T)>::value;
+
+// Each element set to its own index
+template <typename IndexType>
+inline IndexType sg_vectorcall(sg_lane_index_)(
+    std::integral_constant<std::size_t, 4>)
+{
+    return IndexType{3, 2, 1, 0};
+}
+template <typename IndexType>
+inline IndexType sg_vectorcall(sg_lane_index_)(
+    std::integral_constant<std::size_t, 2>)
+{
+    return IndexType{1, 0};
+}
+template <typename IndexType>
+inline IndexType sg_vectorcall(sg_lane_index_)() {
+    return sg_lane_index_<IndexType>(
+        std::integral_constant<std::size_t, IndexType::elem_count>{});
+}
+
+// Size of each of thread_count blocks covering n elements, rounded up to a
+// multiple of the vector width. n must be greater than 0
+template <typename T>
+inline std::size_t sg_block_size_(const std::size_t n,
+    const std::size_t thread_count)
+{
+    const std::size_t width = sg_array_vec_t_<T>::elem_count;
+    return ((n + thread_count - 1)/thread_count + width - 1)/width*width;
+}
+
+// Calls f(begin, end) for each block of [0, n) on separate threads (the first
+// on the calling thread)
+template <typename T, typename Function>
+inline void sg_parallel_blocks_(const std::size_t n,
+    const std::size_t thread_count, Function f)
+{
+    const std::size_t block = sg_block_size_<T>(n, thread_count);
+    std::vector<std::thread> threads;
+    for (std::size_t begin = block; begin < n; begin += block) {
+        threads.emplace_back(f, begin, std::min(n, begin + block));
+    }
+    f(std::size_t(0), std::min(n, block));
+    for (std::thread& t : threads) t.join();
+}
+
+//
+//
+//
+//
+//
+//
+//
+// Scan section
+
+// Scans in[0..n) into out, starting from init. Returns init plus the sum of
+// all the elements
+template <bool exclusive, typename T>
+inline T sg_scan_serial_(const T *const in, T *const out, const std::size_t n,
+    const T init)
+{
+    typedef sg_array_vec_t_<T> vec_t;
+    vec_t carry{init};
+    const std::size_t vec_n = n - n % vec_t::elem_count;
+    std::size_t i = 0;
+    for (; i < vec_n; i += vec_t::elem_count) {
+        const vec_t x = vec_t::loadu(in + i);
+        if (exclusive) {
+            const vec_t sum = sg_shift_up_one_(x).prefix_sum() + carry;
+            sum.storeu(out + i);
+            carry = sg_broadcast_last_(sum + x);
+        } else {
+            const vec_t sum = x.prefix_sum() + carry;
+            sum.storeu(out + i);
+            carry = sg_broadcast_last_(sum);
+        }
+    }
+    // The scalar wrappers wrap on integer overflow, as the vectors do. The
+    // exclusive value is stored before adding, as subtracting it back out
+    // afterwards loses precision for floats
+    typedef typename vec_t::scalar_t scalar_t;
+    scalar_t total{carry.template get<0>()};
+    for (; i < n; ++i) {
+        const scalar_t x{in[i]};
+        if (exclusive) out[i] = total.data();
+        total += x;
+        if (!exclusive) out[i] = total.data();
+    }
+    return total.data();
+}
+
+// Adds offset to every element of data[0..n)
+template <typename T>
+inline void sg_add_offset_(T *const data, const std::size_t n, const T offset)
+{
+    typedef sg_array_vec_t_<T> vec_t;
+    const vec_t offset_v{offset};
+    std::size_t i = 0;
+    for (; i + vec_t::elem_count <= n; i += vec_t::elem_count) {
+        (vec_t::loadu(data + i) + offset_v).storeu(data + i);
+    }
+    for (; i < n; ++i) {
+        data[i] = (typename vec_t::scalar_t{data[i]} + offset).data();
+    }
+}
+
+// Blocks are scanned separately, then each block is offset by the total of
+// the blocks before it
+template <bool exclusive, typename T>
+inline T sg_scan_(const T *const in, T *const out, const std::size_t n,
+    const std::size_t thread_count)
+{
+    if (thread_count <= 1 || n == 0) {
+        return sg_scan_serial_<exclusive>(in, out, n, T(0));
+    }
+    const std::size_t block = sg_block_size_<T>(n, thread_count);
+    std::vector<T> block_totals((n + block - 1)/block);
+    sg_parallel_blocks_<T>(n, thread_count,
+        [&](const std::size_t begin, const std::size_t end) {
+            block_totals[begin/block] = sg_scan_serial_<exclusive>(in + begin,
+                out + begin, end - begin, T(0));
+        });
+    // Integer totals wrap through the scalar wrapper, as in sg_scan_serial_()
+    typename sg_array_vec_t_<T>::scalar_t total{T(0)};
+    for (T& block_total : block_totals) {
+        const T offset = total.data();
+        total += block_total;
+        block_total = offset;
+    }
+    sg_parallel_blocks_<T>(n, thread_count,
+        [&](const std::size_t begin, const std::size_t end) {
+            if (begin > 0) {
+                sg_add_offset_(out + begin, end - begin,
+                    block_totals[begin/block]);
+            }
+        });
+    return total.data();
+}
+
+// out[i] = in[0] + ... + in[i]. Returns the sum of all the elements. in may
+// equal out
+template <typename T>
+inline T sg_inclusive_scan(const T *const in, T *const out,
+    const std::size_t n, const std::size_t thread_count = 1)
+{
+    return sg_scan_<false>(in, out, n, thread_count);
+}
+
+// out[i] = in[0] + ... + in[i - 1], with out[0] = 0. Returns the sum of all
+// the elements. in may equal out
+template <typename T>
+inline T sg_exclusive_scan(const T *const in, T *const out,
+    const std::size_t n, const std::size_t thread_count = 1)
+{
+    return sg_scan_<true>(in, out, n, thread_count);
+}
+
+//
+//
+//
+//
+//
+//
+//
+// Search section
+
+// Each element keeps the best value seen in its position, and the index of
+// where it was first seen. The best of these is resolved at the end
+template <bool is_max, typename T>
+inline std::size_t sg_arg_extreme_(const T *const data, const std::size_t n) {
+    typedef sg_array_vec_t_<T> vec_t;
+    typedef sg_array_index_t_<T> index_t;
+    typedef typename index_t::compare_t index_cmp_t;
+    typedef typename index_t::elem_t index_elem_t;
+    const std::size_t width = vec_t::elem_count;
+    std::size_t i = 0, best_i = 0;
+    if (n >= width) {
+        vec_t best = vec_t::loadu(data);
+        index_t best_index = sg_lane_index_<index_t>(), index = best_index;
+        const index_t step{static_cast<index_elem_t>(width)};
+        for (i = width; i + width <= n; i += width) {
+            const vec_t x = vec_t::loadu(data + i);
+            index += step;
+            const typename vec_t::compare_t better =
+                is_max ? x > best : x < best;
+            best = better.choose(x, best);
+            best_index = better.template to<index_cmp_t>()
+                .choose(index, best_index);
+        }
+        const T best_value = is_max ? best.reduce_max() : best.reduce_min();
+        const index_elem_t none = std::numeric_limits<index_elem_t>::max();
+        const index_elem_t found = (best == best_value)
+            .template to<index_cmp_t>().choose(best_index, none).reduce_min();
+        // Only with NaNs, which then get a scalar search
+        if (found == none) {
+            i = 0;
+        } else {
+            best_i = static_cast<std::size_t>(found);
+        }
+    }
+    for (; i < n; ++i) {
+        if (is_max ? data[i] > data[best_i] : data[i] < data[best_i]) {
+            best_i = i;
+        }
+    }
+    return best_i;
+}
+
+// Index of the first maximum of data[0..n), as with std::max_element(), or 0
+// if n is 0. If there are NaNs, the result is unspecified, but is always a
+// valid index. n must be less than 2^31 for float or int32_t
+template <typename T>
+inline std::size_t sg_argmax(const T *const data, const std::size_t n) {
+    return sg_arg_extreme_<true>(data, n);
+}
+
+// Index of the first minimum of data[0..n), as with std::min_element(), or 0
+// if n is 0. NaNs and the limit on n are as with sg_argmax()
+template <typename T>
+inline std::size_t sg_argmin(const T *const data, const std::size_t n) {
+    return sg_arg_extreme_<false>(data, n);
+}
+
+// Index of the first element of data[0..n) for which pred returns true, or n
+// if there is none. pred is called on whole vectors (eg a lambda taking a
+// Vec_ps and returning a Compare_ps), and stops at the first vector with a
+// match. The last partial vector is padded with zeros, and pred's result for
+// those padding lanes is masked out by (1 << (n - i)) - 1, so pred may match
+// zero
+template <typename T, typename Predicate>
+inline std::size_t sg_find_first_if(const T *const data, const std::size_t n,
+    Predicate pred)
+{
+    typedef sg_array_vec_t_<T> vec_t;
+    const std::size_t width = vec_t::elem_count;
+    std::size_t i = 0;
+    for (; i + width <= n; i += width) {
+        const int32_t mask = pred(vec_t::loadu(data + i)).movemask();
+        if (mask != 0) {
+            return i + static_cast<std::size_t>(Vec_s32x1{mask}.ctz().data());
+        }
+    }
+    if (i < n) {
+        T tail[vec_t::elem_count] = {};
+        for (std::size_t j = i; j < n; ++j) tail[j - i] = data[j];
+        const int32_t mask = pred(vec_t::loadu(tail)).movemask() &
+            ((1 << (n - i)) - 1);
+        if (mask != 0) {
+            return i + static_cast<std::size_t>(Vec_s32x1{mask}.ctz().data());
+        }
+    }
+    return n;
+}
+
+//
+//
+//
+//
+//
+//
+//
+// Sort section
+// Bitonic sorting networks on Vec_ps or Vec_pi32, sorting ascending from
+// element 0 of the first vector. Each step compares every element with
+// another in the same vector, chosen by a shuffle, and keeps the min or the
+// max. NaNs are not supported
+
+// Keys only
+template <typename VecType>
+struct SGSortKeys_ {
+    VecType k;
+};
+
+// Keys, and a payload that is moved with them
+template <typename VecType>
+struct SGSortPairs_ {
+    VecType k;
+    Vec_pi32 v;
+};
+
+// Elements where take_max is true keep the max of themselves and their
+// partner, and the rest keep the min
+template <int i3, int i2, int i1, int i0, typename VecType>
+inline void sg_sort_step_(SGSortKeys_<VecType>& x,
+    const typename VecType::compare_t take_max)
+{
+    const VecType p = x.k.template shuffle<i3, i2, i1, i0>();
+    x.k = take_max.choose(VecType::max(x.k, p), VecType::min(x.k, p));
+}
+template <int i3, int i2, int i1, int i0, typename VecType>
+inline void sg_sort_step_(SGSortPairs_<VecType>& x,
+    const typename VecType::compare_t take_max)
+{
+    const VecType p = x.k.template shuffle<i3, i2, i1, i0>();
+    // Both elements of a pair agree on whether to swap, and equal keys never
+    // swap
+    const typename VecType::compare_t take = (take_max && p > x.k) ||
+        (!take_max && p < x.k);
+    x.k = take.choose(p, x.k);
+    x.v = take.template to<Compare_pi32>().choose(
+        x.v.template shuffle<i3, i2, i1, i0>(), x.v);
+}
+
+template <typename VecType>
+inline void sg_sort_reverse_(SGSortKeys_<VecType>& x) {
+    x.k = x.k.template shuffle<0, 1, 2, 3>();
+}
+template <typename VecType>
+inline void sg_sort_reverse_(SGSortPairs_<VecType>& x) {
+    x.k = x.k.template shuffle<0, 1, 2, 3>();
+    x.v = x.v.template shuffle<0, 1, 2, 3>();
+}
+
+// Element-wise, x keeps the min and y the max
+template <typename VecType>
+inline void sg_sort_minmax_(SGSortKeys_<VecType>& x, SGSortKeys_<VecType>& y)
+{
+    const VecType lo = VecType::min(x.k, y.k);
+    y.k = VecType::max(x.k, y.k);
+    x.k = lo;
+}
+template <typename VecType>
+inline void sg_sort_minmax_(SGSortPairs_<VecType>& x,
+    SGSortPairs_<VecType>& y)
+{
+    const typename VecType::compare_t swap = y.k < x.k;
+    const Compare_pi32 swap_v = swap.template to<Compare_pi32>();
+    const VecType lo = swap.choose(y.k, x.k);
+    const Vec_pi32 lo_v = swap_v.choose(y.v, x.v);
+    y.k = swap.choose(x.k, y.k);
+    y.v = swap_v.choose(x.v, y.v);
+    x.k = lo;
+    x.v = lo_v;
+}
+
+template <typename Lanes>
+inline void sg_sort4_(Lanes& x) {
+    sg_sort_step_<2, 3, 0, 1>(x, {true, false, true, false});
+    sg_sort_step_<1, 0, 3, 2>(x, {true, true, false, false});
+    sg_sort_step_<3, 1, 2, 0>(x, {true, true, false, false});
+}
+
+// Sorts a bitonic sequence of 4
+template <typename Lanes>
+inline void sg_bitonic_merge4_(Lanes& x) {
+    sg_sort_step_<1, 0, 3, 2>(x, {true, true, false, false});
+    sg_sort_step_<2, 3, 0, 1>(x, {true, false, true, false});
+}
+
+// Merges sorted x and y, leaving the lowest 4 in x
+template <typename Lanes>
+inline void sg_merge8_(Lanes& x, Lanes& y) {
+    sg_sort_reverse_(y);
+    sg_sort_minmax_(x, y);
+    sg_bitonic_merge4_(x);
+    sg_bitonic_merge4_(y);
+}
+
+template <typename Lanes>
+inline void sg_sort8_(Lanes& x, Lanes& y) {
+    sg_sort4_(x);
+    sg_sort4_(y);
+    sg_merge8_(x, y);
+}
+
+template <typename Lanes>
+inline void sg_sort16_(Lanes& a, Lanes& b, Lanes& c, Lanes& d) {
+    sg_sort8_(a, b);
+    sg_sort8_(c, d);
+    // Reversing c, d makes a bitonic sequence of 16, whose halves are then
+    // merged separately
+    sg_sort_reverse_(c);
+    sg_sort_reverse_(d);
+    sg_sort_minmax_(a, d);
+    sg_sort_minmax_(b, c);
+    sg_sort_minmax_(a, b);
+    sg_sort_minmax_(d, c);
+    sg_bitonic_merge4_(a);
+    sg_bitonic_merge4_(b);
+    sg_bitonic_merge4_(d);
+    sg_bitonic_merge4_(c);
+    std::swap(c, d);
+}
+
+template <typename VecType>
+inline VecType sg_vectorcall(sg_sort4)(const VecType v) {
+    static_assert(VecType::elem_count == 4, "Use Vec_ps or Vec_pi32");
+    SGSortKeys_<VecType> x{v};
+    sg_sort4_(x);
+    return x.k;
+}
+
+// Afterwards, lo holds the lowest 4 elements
+template <typename VecType>
+inline void sg_sort8(VecType& lo, VecType& hi) {
+    static_assert(VecType::elem_count == 4, "Use Vec_ps or Vec_pi32");
+    SGSortKeys_<VecType> x{lo}, y{hi};
+    sg_sort8_(x, y);
+    lo = x.k; hi = y.k;
+}
+
+template <typename VecType>
+inline void sg_sort16(VecType& v0, VecType& v1, VecType& v2, VecType& v3) {
+    static_assert(VecType::elem_count == 4, "Use Vec_ps or Vec_pi32");
+    SGSortKeys_<VecType> a{v0}, b{v1}, c{v2}, d{v3};
+    sg_sort16_(a, b, c, d);
+    v0 = a.k; v1 = b.k; v2 = c.k; v3 = d.k;
+}
+
+// Key-value sorts, where each element of values moves with the element of
+// keys in the same position. Not stable
+template <typename VecType>
+inline void sg_sort4(VecType& keys, Vec_pi32& values) {
+    static_assert(VecType::elem_count == 4, "Use Vec_ps or Vec_pi32");
+    SGSortPairs_<VecType> x{keys, values};
+    sg_sort4_(x);
+    keys = x.k; values = x.v;
+}
+
+template <typename VecType>
+inline void sg_sort8(VecType& keys_lo, VecType& keys_hi, Vec_pi32& values_lo,
+    Vec_pi32& values_hi)
+{
+    static_assert(VecType::elem_count == 4, "Use Vec_ps or Vec_pi32");
+    SGSortPairs_<VecType> x{keys_lo, values_lo}, y{keys_hi, values_hi};
+    sg_sort8_(x, y);
+    keys_lo = x.k; keys_hi = y.k;
+    values_lo = x.v; values_hi = y.v;
+}
+
+template <typename VecType>
+inline void sg_sort16(VecType& k0, VecType& k1, VecType& k2, VecType& k3,
+    Vec_pi32& v0, Vec_pi32& v1, Vec_pi32& v2, Vec_pi32& v3)
+{
+    static_assert(VecType::elem_count == 4, "Use Vec_ps or Vec_pi32");
+    SGSortPairs_<VecType> a{k0, v0}, b{k1, v1}, c{k2, v2}, d{k3, v3};
+    sg_sort16_(a, b, c, d);
+    k0 = a.k; k1 = b.k; k2 = c.k; k3 = d.k;
+    v0 = a.v; v1 = b.v; v2 = c.v; v3 = d.v;
+}
+
+// Greater than or equal to every other value of T, to pad partial vectors
+template <typename T>
+inline T sg_sort_pad_() {
+    return std::numeric_limits<T>::has_infinity ?
+        std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+}
+
+// Sorts data[0..n) ascending, for n up to 16, with the smallest network that
+// fits
+template <typename T>
+inline void sg_sort_small(T *const data, const std::size_t n) {
+    typedef sg_array_vec_t_<T> vec_t;
+    static_assert(vec_t::elem_count == 4, "Use float or int32_t");
+    assert(n <= 16);
+    T buf[16];
+    std::fill(buf, buf + 16, sg_sort_pad_<T>());
+    std::copy(data, data + n, buf);
+    vec_t a = vec_t::loadu(buf), b = vec_t::loadu(buf + 4);
+    if (n <= 4) {
+        sg_sort4(a).storeu(buf);
+    } else if (n <= 8) {
+        sg_sort8(a, b);
+        a.storeu(buf); b.storeu(buf + 4);
+    } else {
+        vec_t c = vec_t::loadu(buf + 8), d = vec_t::loadu(buf + 12);
+        sg_sort16(a, b, c, d);
+        a.storeu(buf); b.storeu(buf + 4);
+        c.storeu(buf + 8); d.storeu(buf + 12);
+    }
+    std::copy(buf, buf + n, data);
+}
+
+// Merges sorted a[0..na) and b[0..nb) into out, which must not alias either.
+// Holds the highest 4 elements so far in a vector, and merges in the next 4
+// from whichever input has the lower next element, storing the lowest 4.
+// Once that input has fewer than 4 left, the rest is merged one at a time
+template <typename T>
+inline void sg_merge(const T *const a, const std::size_t na,
+    const T *const b, const std::size_t nb, T *const out)
+{
+    typedef sg_array_vec_t_<T> vec_t;
+    static_assert(vec_t::elem_count == 4, "Use float or int32_t");
+    std::size_t ia = 0, ib = 0, io = 0, held_count = 0;
+    T held[4];
+    if (na >= 4 && nb >= 4) {
+        SGSortKeys_<vec_t> lo{vec_t::loadu(a)}, hi{vec_t::loadu(b)};
+        ia = ib = 4;
+        for (;;) {
+            sg_merge8_(lo, hi);
+            lo.k.storeu(out + io);
+            io += 4;
+            const bool from_a = ib == nb || (ia < na && a[ia] <= b[ib]);
+            if (from_a && ia + 4 <= na) {
+                lo.k = vec_t::loadu(a + ia);
+                ia += 4;
+            } else if (!from_a && ib + 4 <= nb) {
+                lo.k = vec_t::loadu(b + ib);
+                ib += 4;
+            } else {
+                break;
+            }
+        }
+        hi.k.storeu(held);
+        held_count = 4;
+    }
+    // Everything stored so far is no greater than anything left
+    std::size_t ih = 0;
+    while (io < na + nb) {
+        const bool a_left = ia < na, b_left = ib < nb,
+            held_left = ih < held_count;
+        if (a_left && (!b_left || a[ia] <= b[ib]) &&
+            (!held_left || a[ia] <= held[ih]))
+        {
+            out[io++] = a[ia++];
+        } else if (b_left && (!held_left || b[ib] <= held[ih])) {
+            out[io++] = b[ib++];
+        } else {
+            out[io++] = held[ih++];
+        }
+    }
+}
+
+//
+//
+//
+//
+//
+//
+//
+// Median filter section
+// Median selection networks (from N. Devillard, "Fast median search: an ANSI
+// C implementation"), applied element-wise to vectors of consecutive windows.
+// Only the exchanges that lead to the median are needed, and the compiler
+// removes the unused halves
+
+template <typename VecType>
+inline void sg_median_exchange_(VecType& a, VecType& b) {
+    const VecType lo = VecType::min(a, b);
+    b = VecType::max(a, b);
+    a = lo;
+}
+
+template <typename VecType>
+inline VecType sg_vectorcall(sg_median_network_)(VecType *const p,
+    std::integral_constant<std::size_t, 3>)
+{
+    sg_median_exchange_(p[0], p[1]);
+    return VecType::max(p[0], VecType::min(p[1], p[2]));
+}
+
+template <typename VecType>
+inline VecType sg_vectorcall(sg_median_network_)(VecType *const p,
+    std::integral_constant<std::size_t, 5>)
+{
+    sg_median_exchange_(p[0], p[1]); sg_median_exchange_(p[3], p[4]);
+    sg_median_exchange_(p[0], p[3]); sg_median_exchange_(p[1], p[4]);
+    sg_median_exchange_(p[1], p[2]); sg_median_exchange_(p[2], p[3]);
+    sg_median_exchange_(p[1], p[2]);
+    return p[2];
+}
+
+template <typename VecType>
+inline VecType sg_vectorcall(sg_median_network_)(VecType *const p,
+    std::integral_constant<std::size_t, 7>)
+{
+    sg_median_exchange_(p[0], p[5]); sg_median_exchange_(p[0], p[3]);
+    sg_median_exchange_(p[1], p[6]); sg_median_exchange_(p[2], p[4]);
+    sg_median_exchange_(p[0], p[1]); sg_median_exchange_(p[3], p[5]);
+    sg_median_exchange_(p[2], p[6]); sg_median_exchange_(p[2], p[3]);
+    sg_median_exchange_(p[3], p[6]); sg_median_exchange_(p[4], p[5]);
+    sg_median_exchange_(p[1], p[4]); sg_median_exchange_(p[1], p[3]);
+    sg_median_exchange_(p[3], p[4]);
+    return p[3];
+}
+
+template <typename VecType>
+inline VecType sg_vectorcall(sg_median_network_)(VecType *const p,
+    std::integral_constant<std::size_t, 9>)
+{
+    sg_median_exchange_(p[1], p[2]); sg_median_exchange_(p[4], p[5]);
+    sg_median_exchange_(p[7], p[8]); sg_median_exchange_(p[0], p[1]);
+    sg_median_exchange_(p[3], p[4]); sg_median_exchange_(p[6], p[7]);
+    sg_median_exchange_(p[1], p[2]); sg_median_exchange_(p[4], p[5]);
+    sg_median_exchange_(p[7], p[8]); sg_median_exchange_(p[0], p[3]);
+    sg_median_exchange_(p[5], p[8]); sg_median_exchange_(p[4], p[7]);
+    sg_median_exchange_(p[3], p[6]); sg_median_exchange_(p[1], p[4]);
+    sg_median_exchange_(p[2], p[5]); sg_median_exchange_(p[4], p[7]);
+    sg_median_exchange_(p[4], p[2]); sg_median_exchange_(p[6], p[4]);
+    sg_median_exchange_(p[4], p[2]);
+    return p[4];
+}
+
+// One vector of outputs from shifted loads, then one at a time
+template <std::size_t taps, typename T>
+inline void sg_median_filter_serial_(const T *const in, T *const out,
+    const std::size_t n)
+{
+    typedef sg_array_vec_t_<T> vec_t;
+    typedef typename SGType<T, 1>::value scalar_t;
+    const std::integral_constant<std::size_t, taps> network{};
+    std::size_t i = 0;
+    for (; i + vec_t::elem_count <= n; i += vec_t::elem_count) {
+        vec_t p[taps];
+        for (std::size_t k = 0; k < taps; ++k) {
+            p[k] = vec_t::loadu(in + i + k);
+        }
+        sg_median_network_(p, network).storeu(out + i);
+    }
+    for (; i < n; ++i) {
+        scalar_t p[taps];
+        for (std::size_t k = 0; k < taps; ++k) p[k] = in[i + k];
+        out[i] = sg_median_network_(p, network).data();
+    }
+}
+
+// out[i] = median(in[i], in[i + 1], ..., in[i + taps - 1]), for i in [0, n),
+// and taps 3, 5, 7 or 9. in must have n + taps - 1 readable elements, and
+// must not alias out. For a filter centred on in[i], pass in - taps/2. NaNs
+// are not supported
+template <typename T>
+inline void sg_median_filter(const T *const in, const std::size_t taps,
+    T *const out, const std::size_t n, const std::size_t thread_count = 1)
+{
+    void (*const kernel)(const T *, T *, std::size_t) =
+        taps == 3 ? sg_median_filter_serial_<3, T> :
+        taps == 5 ? sg_median_filter_serial_<5, T> :
+        taps == 7 ? sg_median_filter_serial_<7, T> :
+        taps == 9 ? sg_median_filter_serial_<9, T> : nullptr;
+    assert(kernel != nullptr && "taps must be 3, 5, 7 or 9");
+    if (kernel == nullptr) return;
+    if (thread_count <= 1 || n == 0) {
+        kernel(in, out, n);
+    } else {
+        sg_parallel_blocks_<T>(n, thread_count,
+            [&](const std::size_t begin, const std::size_t end) {
+                kernel(in + begin, out + begin, end - begin);
+            });
+    }
+}
+
+//
+//
+//
+//
+//
+//
+//
+// Histogram section
+// Each of the 4 elements of a vector counts into its own copy of the
+// histogram, so that the 4 increments never hit the same counter, and the
+// copies are summed at the end
+
+// Counts data[0..n) into sub, which is 4 histograms of bin_count counters,
+// one per element. bins(v) maps a Vec_ps or Vec_pi32 to a Vec_pi32 of bin
+// indices in [0, bin_count)
+template <typename T, typename BinFunction>
+inline void sg_histogram_serial_(const T *const data, const std::size_t n,
+    uint32_t *const sub, const std::size_t bin_count, BinFunction bins)
+{
+    typedef sg_array_vec_t_<T> vec_t;
+    const Vec_pi32 offset = Vec_pi32{3, 2, 1, 0} *
+        static_cast<int32_t>(bin_count);
+    int32_t index[4];
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        (bins(vec_t::loadu(data + i)) + offset).storeu(index);
+        ++sub[index[0]]; ++sub[index[1]];
+        ++sub[index[2]]; ++sub[index[3]];
+    }
+    if (i < n) {
+        T tail[4] = {};
+        std::copy(data + i, data + n, tail);
+        (bins(vec_t::loadu(tail)) + offset).storeu(index);
+        for (std::size_t k = 0; k < n - i; ++k) ++sub[index[k]];
+    }
+}
+
+// Splits data between threads, each with its own sub-histograms, then adds
+// all of them to counts
+template <typename T, typename BinFunction>
+inline void sg_histogram_(const T *const data, const std::size_t n,
+    uint32_t *const counts, const std::size_t bin_count,
+    const std::size_t thread_count, BinFunction bins)
+{
+    static_assert(sg_array_vec_t_<T>::elem_count == 4, "Use float or int32_t");
+    assert(bin_count > 0 && bin_count <= INT32_MAX/4);
+    if (n == 0) return;
+    const std::size_t sub_size = 4*bin_count;
+    std::vector<uint32_t> sub;
+    if (thread_count <= 1) {
+        sub.resize(sub_size);
+        sg_histogram_serial_(data, n, sub.data(), bin_count, bins);
+    } else {
+        const std::size_t block = sg_block_size_<T>(n, thread_count);
+        sub.resize((n + block - 1)/block*sub_size);
+        sg_parallel_blocks_<T>(n, thread_count,
+            [&](const std::size_t begin, const std::size_t end) {
+                sg_histogram_serial_(data + begin, end - begin,
+                    sub.data() + begin/block*sub_size, bin_count, bins);
+            });
+    }
+    // int32_t and uint32_t may alias, and addition wraps the same
+    int32_t *const counts_i = reinterpret_cast<int32_t*>(counts);
+    for (std::size_t s = 0; s < sub.size(); s += bin_count) {
+        const int32_t *const sub_i =
+            reinterpret_cast<const int32_t*>(sub.data() + s);
+        std::size_t b = 0;
+        for (; b + 4 <= bin_count; b += 4) {
+            (Vec_pi32::loadu(counts_i + b) + Vec_pi32::loadu(sub_i + b))
+                .storeu(counts_i + b);
+        }
+        for (; b < bin_count; ++b) counts[b] += sub[s + b];
+    }
+}
+
+// Adds the counts of data[0..n) to counts[0..bin_count), for bin_count equal
+// bins over [lo, hi). Values below lo are counted in bin 0, values above hi in
+// the last bin, and NaNs in bin 0. counts is not cleared first
+inline void sg_histogram(const float *const data, const std::size_t n,
+    const float lo, const float hi, uint32_t *const counts,
+    const std::size_t bin_count, const std::size_t thread_count = 1)
+{
+    const Vec_ps lo_v{lo}, scale{static_cast<float>(bin_count)/(hi - lo)},
+        last{static_cast<float>(bin_count - 1)};
+    sg_histogram_(data, n, counts, bin_count, thread_count,
+        [=](const Vec_ps x) {
+            const Vec_ps bin = (x - lo_v)*scale;
+            return (bin == bin).choose_else_zero(bin)
+                .constrain(Vec_ps{}, last).truncate<Vec_pi32>();
+        });
+}
+
+// As above, with a bin for each integer from lo to lo + bin_count - 1
+inline void sg_histogram(const int32_t *const data, const std::size_t n,
+    const int32_t lo, uint32_t *const counts, const std::size_t bin_count,
+    const std::size_t thread_count = 1)
+{
+    const Vec_pi32 lo_v{lo}, last{static_cast<int32_t>(bin_count - 1)};
+    sg_histogram_(data, n, counts, bin_count, thread_count,
+        [=](const Vec_pi32 x) {
+            return x.subs(lo_v).constrain(Vec_pi32{}, last);
+        });
+}
+
+//
+//
+//
+//
+//
+//
+//
+// Dot product section
+
+// How sg_dot(), sg_sum() and sg_sum_sq() add up their terms
+// - fast: 4 Vec_ps accumulators, each adding every 4th vector (every 16th
+//   term). Error grows with n / 16
+// - widened: terms formed and added in double precision, in 4 Vec_pd
+//   accumulators. Exact products, and error as for double
+// - kahan: 2 Vec_ps accumulators with Kahan compensation. Error is
+//   independent of n (apart from the rounding of each product)
+// - pairwise: vectors of 256 terms are summed in Vec_ps, then added up as a
+//   binary tree in double precision. Error grows with log(n)
+enum class SGSumMode { fast, widened, kahan, pairwise };
+
+struct SGDotTerm_ {
+    template <typename VecType>
+    VecType sg_vectorcall(operator())(const VecType a, const VecType b) const
+    {
+        return a*b;
+    }
+};
+struct SGSumTerm_ {
+    template <typename VecType>
+    VecType sg_vectorcall(operator())(const VecType a, const VecType) const {
+        return a;
+    }
+};
+struct SGSumSqTerm_ {
+    template <typename VecType>
+    VecType sg_vectorcall(operator())(const VecType a, const VecType) const {
+        return a*a;
+    }
+};
+
+// Elements 1 and 0, and elements 3 and 2, as doubles
+inline Vec_pd sg_vectorcall(sg_widen_lo_)(const Vec_ps x) {
+    return x.to<Vec_pd>();
+}
+inline Vec_pd sg_vectorcall(sg_widen_hi_)(const Vec_ps x) {
+    return x.shuffle<3, 2, 3, 2>().to<Vec_pd>();
+}
+
+// Sum of the elements in double precision
+inline double sg_vectorcall(sg_widen_sum_)(const Vec_ps x) {
+    return (sg_widen_lo_(x) + sg_widen_hi_(x)).reduce_add();
+}
+
+// The sum_*_ functions sum term(a[i], b[i]) for i in [0, n), where n is a
+// multiple of 4
+
+template <typename Term>
+inline Vec_ps sg_vectorcall(sg_sum_fast_)(const float *const a,
+    const float *const b, const std::size_t n, Term term)
+{
+    Vec_ps acc0, acc1, acc2, acc3;
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 += term(Vec_ps::loadu(a + i), Vec_ps::loadu(b + i));
+        acc1 += term(Vec_ps::loadu(a + i + 4), Vec_ps::loadu(b + i + 4));
+        acc2 += term(Vec_ps::loadu(a + i + 8), Vec_ps::loadu(b + i + 8));
+        acc3 += term(Vec_ps::loadu(a + i + 12), Vec_ps::loadu(b + i + 12));
+    }
+    for (; i < n; i += 4) {
+        acc0 += term(Vec_ps::loadu(a + i), Vec_ps::loadu(b + i));
+    }
+    return (acc0 + acc1) + (acc2 + acc3);
+}
+
+template <typename Term>
+inline double sg_sum_widened_(const float *const a, const float *const b,
+    const std::size_t n, Term term)
+{
+    Vec_pd acc0, acc1, acc2, acc3;
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const Vec_ps a0 = Vec_ps::loadu(a + i), b0 = Vec_ps::loadu(b + i),
+            a1 = Vec_ps::loadu(a + i + 4), b1 = Vec_ps::loadu(b + i + 4);
+        acc0 += term(sg_widen_lo_(a0), sg_widen_lo_(b0));
+        acc1 += term(sg_widen_hi_(a0), sg_widen_hi_(b0));
+        acc2 += term(sg_widen_lo_(a1), sg_widen_lo_(b1));
+        acc3 += term(sg_widen_hi_(a1), sg_widen_hi_(b1));
+    }
+    for (; i < n; i += 4) {
+        const Vec_ps a0 = Vec_ps::loadu(a + i), b0 = Vec_ps::loadu(b + i);
+        acc0 += term(sg_widen_lo_(a0), sg_widen_lo_(b0));
+        acc1 += term(sg_widen_hi_(a0), sg_widen_hi_(b0));
+    }
+    return ((acc0 + acc1) + (acc2 + acc3)).reduce_add();
+}
+
+// Adds x to sum, keeping the part lost to rounding in c (negated)
+inline void sg_vectorcall(sg_kahan_add_)(Vec_ps& sum, Vec_ps& c,
+    const Vec_ps x)
+{
+    const Vec_ps y = x - c, t = sum + y;
+    c = (t - sum) - y;
+    sum = t;
+}
+
+template <typename Term>
+inline double sg_sum_kahan_(const float *const a, const float *const b,
+    const std::size_t n, Term term)
+{
+    Vec_ps sum0, c0, sum1, c1;
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        sg_kahan_add_(sum0, c0, term(Vec_ps::loadu(a + i),
+            Vec_ps::loadu(b + i)));
+        sg_kahan_add_(sum1, c1, term(Vec_ps::loadu(a + i + 4),
+            Vec_ps::loadu(b + i + 4)));
+    }
+    for (; i < n; i += 4) {
+        sg_kahan_add_(sum0, c0, term(Vec_ps::loadu(a + i),
+            Vec_ps::loadu(b + i)));
+    }
+    return (sg_widen_sum_(sum0) - sg_widen_sum_(c0)) +
+        (sg_widen_sum_(sum1) - sg_widen_sum_(c1));
+}
+
+template <typename Term>
+inline double sg_sum_pairwise_(const float *const a, const float *const b,
+    const std::size_t n, Term term)
+{
+    if (n <= 256) return sg_widen_sum_(sg_sum_fast_(a, b, n, term));
+    const std::size_t half = n/8*4;
+    return sg_sum_pairwise_(a, b, half, term) +
+        sg_sum_pairwise_(a + half, b + half, n - half, term);
+}
+
+template <typename Term>
+inline double sg_sum_terms_(const float *const a, const float *const b,
+    const std::size_t n, const SGSumMode mode, Term term)
+{
+    const std::size_t vec_n = n - n % 4;
+    double sum;
+    switch (mode) {
+        case SGSumMode::widened:
+            sum = sg_sum_widened_(a, b, vec_n, term); break;
+        case SGSumMode::kahan:
+            sum = sg_sum_kahan_(a, b, vec_n, term); break;
+        case SGSumMode::pairwise:
+            sum = sg_sum_pairwise_(a, b, vec_n, term); break;
+        default:
+            sum = sg_widen_sum_(sg_sum_fast_(a, b, vec_n, term)); break;
+    }
+    for (std::size_t i = vec_n; i < n; ++i) {
+        sum += term(Vec_f64x1{a[i]}, Vec_f64x1{b[i]}).data();
+    }
+    return sum;
+}
+
+// a[0]*b[0] + a[1]*b[1] + ... + a[n - 1]*b[n - 1]
+inline double sg_dot(const float *const a, const float *const b,
+    const std::size_t n, const SGSumMode mode = SGSumMode::fast)
+{
+    return sg_sum_terms_(a, b, n, mode, SGDotTerm_{});
+}
+
+// a[0] + a[1] + ... + a[n - 1]
+inline double sg_sum(const float *const a, const std::size_t n,
+    const SGSumMode mode = SGSumMode::fast)
+{
+    return sg_sum_terms_(a, a, n, mode, SGSumTerm_{});
+}
+
+// a[0]*a[0] + a[1]*a[1] + ... + a[n - 1]*a[n - 1]. The square of the
+// Euclidean norm, or the energy of a signal
+inline double sg_sum_sq(const float *const a, const std::size_t n,
+    const SGSumMode mode = SGSumMode::fast)
+{
+    return sg_sum_terms_(a, a, n, mode, SGSumSqTerm_{});
+}
+
+// y[i] += alpha*x[i], for float or double. y may equal x
+template <typename T>
+inline void sg_axpy(const T alpha, const T *const x, T *const y,
+    const std::size_t n)
+{
+    typedef sg_array_vec_t_<T> vec_t;
+    typedef typename SGType<T, 1>::value scalar_t;
+    const vec_t alpha_v{alpha};
+    std::size_t i = 0;
+    for (; i + vec_t::elem_count <= n; i += vec_t::elem_count) {
+        vec_t::loadu(x + i).mul_add(alpha_v, vec_t::loadu(y + i))
+            .storeu(y + i);
+    }
+    for (; i < n; ++i) y[i] = scalar_t{x[i]}.mul_add(alpha, y[i]).data();
+}
+
+// x[i] *= alpha, for float or double
+template <typename T>
+inline void sg_scale(const T alpha, T *const x, const std::size_t n) {
+    typedef sg_array_vec_t_<T> vec_t;
+    const vec_t alpha_v{alpha};
+    std::size_t i = 0;
+    for (; i + vec_t::elem_count <= n; i += vec_t::elem_count) {
+        (vec_t::loadu(x + i) * alpha_v).storeu(x + i);
+    }
+    for (; i < n; ++i) x[i] *= alpha;
+}
+
+} // namespace simd_granodi
+
+#endif // SIMD_GRANODI_ARRAY_H
@@ -0,0 +1,1524 @@
+#ifndef SIMD_GRANODI_DSP_H
+#define SIMD_GRANODI_DSP_H
+
+/*
+
+SIMD GRANODI DSP
+
+Copyright (c) 2021-2022 Jon Ville
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+/*
+
+Audio DSP building blocks written in terms of the C++ classes in
+simd_granodi.h, and the functions in sg_math.h and sg_random.h.
+
+Block processing classes:
+- Allocate all of their memory in their constructor, and never in process()
+- Accept blocks of any length. Blocks longer than the max_block given to the
+  constructor are processed in several passes
+- Allow in-place processing (the input and output pointers may be equal)
+
+*/
+
+#include "sg_random.h"
+
+#include <cassert>
+#include <vector>
+
+namespace simd_granodi {
+
+//
+//
+//
+//
+//
+//
+//
+// Array helper section
+
+// Applies f (a function or lambda taking and returning Vec_ps) to data in
+// place. The last partial vector is padded with zeros
+template <typename Function>
+inline void sg_map_ps(float *const data, const std::size_t n, Function f) {
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) f(Vec_ps::loadu(data + i)).storeu(data + i);
+    if (i < n) {
+        float tail[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        std::copy(data + i, data + n, tail);
+        f(Vec_ps::loadu(tail)).storeu(tail);
+        std::copy(tail, tail + (n - i), data + i);
+    }
+}
+
+// Loads count (0 to 4) floats into the lowest elements, zeroing the rest
+inline Vec_ps sg_vectorcall(sg_loadu_partial_ps_)(const float *const data,
+    const std::size_t count)
+{
+    if (count >= 4) return Vec_ps::loadu(data);
+    float tail[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    std::copy(data, data + count, tail);
+    return Vec_ps::loadu(tail);
+}
+
+// Stores the lowest count (0 to 4) elements of v
+inline void sg_vectorcall(sg_storeu_partial_ps_)(const Vec_ps v,
+    float *const data, const std::size_t count)
+{
+    if (count >= 4) {
+        v.storeu(data);
+    } else {
+        float tail[4];
+        v.storeu(tail);
+        std::copy(tail, tail + count, data);
+    }
+}
+
+//
+//
+//
+//
+//
+//
+//
+// FIR section
+
+// out[i] = taps[0]*in[i] + taps[1]*in[i + 1] + ... + taps[tap_count - 1] *
+// in[i + tap_count - 1], for i in [0, n). in must have n + tap_count - 1
+// readable elements, and must not alias out.
+// Vectorized over 4 consecutive outputs, so no horizontal adds are needed.
+inline void sg_fir_kernel(const float *const in, const float *const taps,
+    const std::size_t tap_count, float *const out, const std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        Vec_ps acc;
+        for (std::size_t k = 0; k < tap_count; ++k) {
+            acc = Vec_ps::loadu(in + i + k).mul_add(taps[k], acc);
+        }
+        acc.storeu(out + i);
+    }
+    for (; i < n; ++i) {
+        float acc = 0.0f;
+        for (std::size_t k = 0; k < tap_count; ++k) {
+            acc = sg_mul_add_f32x1(in[i + k], taps[k], acc);
+        }
+        out[i] = acc;
+    }
+}
+
+// Streaming FIR filter for one channel:
+// out[t] = taps[0]*in[t] + taps[1]*in[t - 1] + ...
+class SGFir {
+    std::vector<float> taps_rev_, buf_;
+    std::size_t max_block_;
+
+    std::size_t history() const { return taps_rev_.size() - 1; }
+
+public:
+    SGFir(const float *const taps, const std::size_t tap_count,
+        const std::size_t max_block = 256)
+        : taps_rev_(taps, taps + tap_count),
+        buf_(tap_count - 1 + max_block, 0.0f), max_block_{max_block}
+    {
+        std::reverse(taps_rev_.begin(), taps_rev_.end());
+    }
+
+    std::size_t tap_count() const { return taps_rev_.size(); }
+
+    void reset() { std::fill(buf_.begin(), buf_.end(), 0.0f); }
+
+    void process(const float *in, float *out, std::size_t n) {
+        while (n > 0) {
+            const std::size_t block = std::min(n, max_block_);
+            std::copy(in, in + block, buf_.begin() + history());
+            sg_fir_kernel(buf_.data(), taps_rev_.data(), taps_rev_.size(),
+                out, block);
+            std::copy(buf_.begin() + block, buf_.begin() + block + history(),
+                buf_.begin());
+            in += block; out += block; n -= block;
+        }
+    }
+};
+
+// Streaming delay by a whole number of samples, for one channel
+class SGDelayFixed {
+    std::vector<float> buf_;
+    std::size_t delay_, max_block_;
+
+public:
+    SGDelayFixed(const std::size_t delay, const std::size_t max_block = 256)
+        : buf_(delay + max_block, 0.0f), delay_{delay}, max_block_{max_block}
+        {}
+
+    std::size_t delay() const { return delay_; }
+
+    void reset() { std::fill(buf_.begin(), buf_.end(), 0.0f); }
+
+    void process(const float *in, float *out, std::size_t n) {
+        while (n > 0) {
+            const std::size_t block = std::min(n, max_block_);
+            std::copy(in, in + block, buf_.begin() + delay_);
+            std::copy(buf_.begin(), buf_.begin() + block, out);
+            std::copy(buf_.begin() + block, buf_.begin() + block + delay_,
+                buf_.begin());
+            in += block; out += block; n -= block;
+        }
+    }
+};
+
+//
+//
+//
+//
+//
+//
+//
+// Oversampling section
+
+// Linear phase halfband lowpass, for 2x upsampling and downsampling of one
+// channel. The 2x rate signal is kept in polyphase form: the even samples and
+// the odd samples are in separate arrays, each with the same length as the 1x
+// rate signal. A memoryless waveshaper can run on both arrays without
+// interleaving them.
+//
+// The filter is a Blackman windowed sinc with 4*half_taps - 1 taps, of which
+// 2*half_taps are neither zero nor the center tap.
+// Latency (upsample followed by downsample) is 2*half_taps - 1 samples at the
+// 1x rate.
+class SGHalfband2x {
+    SGFir up_odd_, down_odd_;
+    SGDelayFixed up_even_, down_even_;
+    int32_t half_taps_;
+    std::size_t max_block_;
+
+    static std::vector<float> design(const int32_t half_taps,
+        const float gain)
+    {
+        // Odd taps h[m], m = 2k - 2*half_taps + 1, in order of increasing m
+        const int32_t tap_count = 2*half_taps;
+        const double pi = 3.14159265358979323846,
+            window_len = 4.0*half_taps;
+        std::vector<double> h(tap_count);
+        double sum = 0.0;
+        for (int32_t k = 0; k < tap_count; ++k) {
+            const double m = 2*k - 2*half_taps + 1;
+            const double w = 0.42 + 0.5*std::cos(2.0*pi*m / window_len) +
+                0.08*std::cos(4.0*pi*m / window_len);
+            h[k] = std::sin(0.5*pi*m) / (pi*m) * w;
+            sum += h[k];
+        }
+        // The odd taps of a halfband filter with unity DC gain sum to 0.5
+        std::vector<float> result(tap_count);
+        for (int32_t k = 0; k < tap_count; ++k) {
+            result[k] = static_cast<float>(h[k] * 0.5 * gain / sum);
+        }
+        return result;
+    }
+
+public:
+    // half_taps must be at least 1. Multiples of 2 vectorize best
+    SGHalfband2x(const int32_t half_taps = 16,
+        const std::size_t max_block = 256)
+        : up_odd_(design(half_taps, 2.0f).data(), 2*half_taps, max_block),
+        down_odd_(design(half_taps, 1.0f).data(), 2*half_taps, max_block),
+        up_even_(half_taps, max_block), down_even_(half_taps - 1, max_block),
+        half_taps_{half_taps}, max_block_{max_block} {}
+
+    // Latency of upsample() followed by downsample(), in 1x rate samples
+    int32_t latency() const { return 2*half_taps_ - 1; }
+
+    void reset() {
+        up_odd_.reset(); down_odd_.reset();
+        up_even_.reset(); down_even_.reset();
+    }
+
+    // n samples of in, to n samples each of even and odd
+    void upsample(const float *const in, float *const even, float *const odd,
+        const std::size_t n)
+    {
+        up_odd_.process(in, odd, n);
+        up_even_.process(in, even, n);
+    }
+
+    // n samples each of even and odd, to n samples of out.
+    // even and odd are used as scratch space, and are overwritten
+    void downsample(float *even, float *odd, float *out, std::size_t n) {
+        while (n > 0) {
+            const std::size_t block = std::min(n, max_block_);
+            down_odd_.process(odd, odd, block);
+            down_even_.process(even, even, block);
+            std::size_t i = 0;
+            for (; i + 4 <= block; i += 4) {
+                Vec_ps::loadu(even + i).mul_add(0.5f, Vec_ps::loadu(odd + i))
+                    .storeu(out + i);
+            }
+            for (; i < block; ++i) out[i] = even[i]*0.5f + odd[i];
+            even += block; odd += block; out += block; n -= block;
+        }
+    }
+};
+
+// Runs a memoryless waveshaper on one channel at 1x, 2x or 4x the input sample
+// rate, using cascaded SGHalfband2x filters.
+//
+// Example:
+// SGOversampler os{4};
+// os.process(in, out, n, [](const Vec_ps x) { return sg_tanh(x); });
+class SGOversampler {
+    SGHalfband2x stage1_, stage2_;
+    std::vector<float> even1_, odd1_, even2_, odd2_, x2_;
+    int32_t factor_;
+    std::size_t max_block_;
+
+    static void interleave(const float *const even, const float *const odd,
+        float *const out, const std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[2*i] = even[i]; out[2*i + 1] = odd[i];
+        }
+    }
+    static void deinterleave(const float *const in, float *const even,
+        float *const odd, const std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; ++i) {
+            even[i] = in[2*i]; odd[i] = in[2*i + 1];
+        }
+    }
+
+public:
+    // factor must be 1, 2 or 4
+    SGOversampler(const int32_t factor = 2, const std::size_t max_block = 256,
+        const int32_t half_taps = 16)
+        : stage1_(half_taps, max_block), stage2_(half_taps, 2*max_block),
+        even1_(max_block), odd1_(max_block),
+        even2_(factor == 4 ? 2*max_block : 0),
+        odd2_(factor == 4 ? 2*max_block : 0),
+        x2_(factor == 4 ? 2*max_block : 0),
+        factor_{factor}, max_block_{max_block} {}
+
+    int32_t factor() const { return factor_; }
+
+    // Latency in 1x rate samples. This is not a whole number when factor is 4
+    double latency() const {
+        if (factor_ == 1) return 0.0;
+        if (factor_ == 2) return stage1_.latency();
+        return stage1_.latency() + 0.5*stage2_.latency();
+    }
+
+    void reset() { stage1_.reset(); stage2_.reset(); }
+
+    template <typename Function>
+    void process(const float *in, float *out, std::size_t n, Function f) {
+        while (n > 0) {
+            const std::size_t block = std::min(n, max_block_);
+            if (factor_ == 1) {
+                std::copy(in, in + block, out);
+                sg_map_ps(out, block, f);
+            } else if (factor_ == 2) {
+                stage1_.upsample(in, even1_.data(), odd1_.data(), block);
+                sg_map_ps(even1_.data(), block, f);
+                sg_map_ps(odd1_.data(), block, f);
+                stage1_.downsample(even1_.data(), odd1_.data(), out, block);
+            } else {
+                stage1_.upsample(in, even1_.data(), odd1_.data(), block);
+                interleave(even1_.data(), odd1_.data(), x2_.data(), block);
+                stage2_.upsample(x2_.data(), even2_.data(), odd2_.data(),
+                    2*block);
+                sg_map_ps(even2_.data(), 2*block, f);
+                sg_map_ps(odd2_.data(), 2*block, f);
+                stage2_.downsample(even2_.data(), odd2_.data(), x2_.data(),
+                    2*block);
+                deinterleave(x2_.data(), even1_.data(), odd1_.data(), block);
+                stage1_.downsample(even1_.data(), odd1_.data(), out, block);
+            }
+            in += block; out += block; n -= block;
+        }
+    }
+};
+
+//
+//
+//
+//
+//
+//
+//
+// PCM conversion section
+
+enum class SGDitherType { none, tpdf, shaped };
+
+// Dither state for one channel, for the float to PCM kernels below.
+// - tpdf: triangular noise of +-1 LSB peak, which makes the quantization
+//   error independent of the signal
+// - shaped: tpdf, plus first order error feedback, moving the quantization
+//   noise towards high frequencies (noise transfer function 1 - z^-1).
+//   Error feedback is sequential, so this is calculated one sample at a time
+class SGDither {
+    SGXorshift128Plus gen_;
+    SGDitherType type_;
+    float error_;
+
+public:
+    explicit SGDither(const SGDitherType type = SGDitherType::tpdf,
+        const uint64_t seed = 0) : gen_{seed}, type_{type}, error_{0.0f} {}
+
+    SGDitherType type() const { return type_; }
+
+    void reset() { error_ = 0.0f; }
+
+    // Triangular noise in (-1, 1), the sum of two uniform values in
+    // [-0.5, 0.5)
+    Vec_ps sg_vectorcall(next_tpdf)() {
+        return (sg_random_bipolar(gen_) + sg_random_bipolar(gen_)) * 0.5f;
+    }
+
+    // Adds dither to x (already scaled so that 1 LSB is 1.0), and rounds to
+    // the nearest integer
+    Vec_pi32 sg_vectorcall(quantize)(const Vec_ps x) {
+        if (type_ == SGDitherType::none) {
+            return x.nearest<Vec_pi32>();
+        } else if (type_ == SGDitherType::tpdf) {
+            return (x + next_tpdf()).nearest<Vec_pi32>();
+        }
+        float noise[4], value[4];
+        int32_t result[4];
+        next_tpdf().storeu(noise);
+        x.storeu(value);
+        for (int32_t i = 0; i < 4; ++i) {
+            const float v = value[i] - error_;
+            result[i] = Vec_f32x1{v + noise[i]}.nearest<Vec_s32x1>().data();
+            error_ = static_cast<float>(result[i]) - v;
+        }
+        return Vec_pi32::loadu(result);
+    }
+};
+
+// Converts floats to PCM of bit_depth bits, scaled by 2^(bit_depth - 1) and
+// saturated, for 4 samples starting at i. Samples past n are zero
+inline Vec_pi32 sg_vectorcall(sg_pcm_quantize_)(const float *const in,
+    const std::size_t i, const std::size_t n, const int32_t bit_depth,
+    SGDither *const dither)
+{
+    Vec_ps x;
+    if (i + 4 <= n) {
+        x = Vec_ps::loadu(in + i);
+    } else {
+        float tail[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        std::copy(in + i, in + n, tail);
+        x = Vec_ps::loadu(tail);
+    }
+    const float scale = static_cast<float>(int64_t(1) << (bit_depth - 1));
+    // Clamp before rounding, leaving room for dither, so that the conversion
+    // to integer is always in range. The largest float below 2^31 is
+    // 2^31 - 128, and adding dither to it rounds back down
+    x = (x * scale).constrain(-scale - 2.0f,
+        bit_depth < 32 ? scale + 1.0f : 2147483520.0f);
+    const Vec_pi32 result = dither != nullptr ? dither->quantize(x) :
+        x.nearest<Vec_pi32>();
+    return bit_depth < 32 ? result.constrain(-(int32_t(1) << (bit_depth - 1)),
+        (int32_t(1) << (bit_depth - 1)) - 1) : result;
+}
+
+// Float samples in [-1, 1] to signed 16-bit PCM, rounding to nearest and
+// saturating. dither may be nullptr
+inline void sg_float_to_pcm16(const float *const in, int16_t *const out,
+    const std::size_t n, SGDither *const dither = nullptr)
+{
+    std::size_t i = 0;
+    // 8 samples at a time, packed to 16 bits with a single saturating store
+    for (; i + 8 <= n; i += 8) {
+        const Vec_pi32 lo = sg_pcm_quantize_(in, i, n, 16, dither);
+        lo.storeu_sat16(out + i, sg_pcm_quantize_(in, i + 4, n, 16, dither));
+    }
+    for (; i < n; i += 4) {
+        int32_t result[4];
+        sg_pcm_quantize_(in, i, n, 16, dither).storeu(result);
+        const std::size_t count = std::min<std::size_t>(4, n - i);
+        for (std::size_t j = 0; j < count; ++j) {
+            out[i + j] = static_cast<int16_t>(result[j]);
+        }
+    }
+}
+
+// As above, for packed signed 24-bit little-endian PCM. out has 3*n bytes
+inline void sg_float_to_pcm24(const float *const in, uint8_t *const out,
+    const std::size_t n, SGDither *const dither = nullptr)
+{
+    for (std::size_t i = 0; i < n; i += 4) {
+        int32_t result[4];
+        sg_pcm_quantize_(in, i, n, 24, dither).storeu(result);
+        const std::size_t count = std::min<std::size_t>(4, n - i);
+        for (std::size_t j = 0; j < count; ++j) {
+            const uint32_t u = static_cast<uint32_t>(result[j]);
+            uint8_t *const dst = out + 3*(i + j);
+            dst[0] = static_cast<uint8_t>(u);
+            dst[1] = static_cast<uint8_t>(u >> 8);
+            dst[2] = static_cast<uint8_t>(u >> 16);
+        }
+    }
+}
+
+// As above, for signed 32-bit PCM. Only the top 24 bits of the result can be
+// non-zero, as a float has 24 bits of precision
+inline void sg_float_to_pcm32(const float *const in, int32_t *const out,
+    const std::size_t n, SGDither *const dither = nullptr)
+{
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        sg_pcm_quantize_(in, i, n, 32, dither).storeu(out + i);
+    }
+    if (i < n) {
+        int32_t result[4];
+        sg_pcm_quantize_(in, i, n, 32, dither).storeu(result);
+        std::copy(result, result + (n - i), out + i);
+    }
+}
+
+// Signed 16-bit PCM to float samples in [-1, 1)
+inline void sg_pcm16_to_float(const int16_t *const in, float *const out,
+    const std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        (Vec_pi32{in[i + 3], in[i + 2], in[i + 1], in[i]}.to<Vec_ps>() *
+            (1.0f / 32768.0f)).storeu(out + i);
+    }
+    for (; i < n; ++i) out[i] = in[i] * (1.0f / 32768.0f);
+}
+
+// Packed signed 24-bit little-endian PCM (3*n bytes) to float samples in
+// [-1, 1)
+inline void sg_pcm24_to_float(const uint8_t *const in, float *const out,
+    const std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i < n; i += 4) {
+        int32_t value[4] = { 0, 0, 0, 0 };
+        const std::size_t count = std::min<std::size_t>(4, n - i);
+        for (std::size_t j = 0; j < count; ++j) {
+            const uint8_t *const src = in + 3*(i + j);
+            value[j] = static_cast<int32_t>(uint32_t(src[0]) << 8 |
+                uint32_t(src[1]) << 16 | uint32_t(src[2]) << 24);
+        }
+        // Shift right arithmetic to sign extend
+        const Vec_ps result = Vec_pi32::loadu(value).shift_ra_imm<8>()
+            .to<Vec_ps>() * (1.0f / 8388608.0f);
+        if (count == 4) {
+            result.storeu(out + i);
+        } else {
+            float tail[4];
+            result.storeu(tail);
+            std::copy(tail, tail + count, out + i);
+        }
+    }
+}
+
+// Signed 32-bit PCM to float samples in [-1, 1]
+inline void sg_pcm32_to_float(const int32_t *const in, float *const out,
+    const std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        (Vec_pi32::loadu(in + i).to<Vec_ps>() * (1.0f / 2147483648.0f))
+            .storeu(out + i);
+    }
+    for (; i < n; ++i) out[i] = static_cast<float>(in[i]) / 2147483648.0f;
+}
+
+//
+//
+//
+//
+//
+//
+//
+// Metering section
+
+// Largest absolute value of in[0, n), or 0 if n is 0
+inline float sg_peak(const float *const in, const std::size_t n) {
+    std::size_t i = 0;
+    Vec_ps peak;
+    for (; i + 4 <= n; i += 4) {
+        peak = Vec_ps::max(peak, Vec_ps::loadu(in + i).abs());
+    }
+    float result = peak.reduce_max();
+    for (; i < n; ++i) result = std::max(result, std::abs(in[i]));
+    return result;
+}
+
+// Root mean square of in[0, n), or 0 if n is 0. The squares are summed in
+// double precision, so long blocks do not lose accuracy
+inline float sg_rms(const float *const in, const std::size_t n) {
+    std::size_t i = 0;
+    Vec_pd sum_lo, sum_hi;
+    for (; i + 4 <= n; i += 4) {
+        const Vec_ps x = Vec_ps::loadu(in + i);
+        const Vec_pd lo = x.to<Vec_pd>(),
+            hi = x.shuffle<3, 2, 3, 2>().to<Vec_pd>();
+        sum_lo = lo.mul_add(lo, sum_lo);
+        sum_hi = hi.mul_add(hi, sum_hi);
+    }
+    double sum = (sum_lo + sum_hi).reduce_add();
+    for (; i < n; ++i) sum += static_cast<double>(in[i]) * in[i];
+    return n == 0 ? 0.0f : static_cast<float>(std::sqrt(sum / n));
+}
+
+// Loudness meter following ITU-R BS.1770-4 and EBU R 128, for any number of
+// channels. Each group of 4 channels is K-weighted in one Vec_ps (a shelving
+// biquad followed by a highpass biquad, in transposed direct form II), and the
+// squares are summed in double precision for every 100ms sub-block.
+// - momentary(): loudness of the last 400ms
+// - short_term(): loudness of the last 3s
+// - integrated(): gated loudness of everything since the last reset(), with an
+//   absolute gate of -70 LUFS and a relative gate of -10 LU. Gating blocks are
+//   kept in a histogram with 0.01 LU bins, so memory use does not grow, and
+//   the relative gate is accurate to one bin
+// All of these return -infinity for silence. The default channel weights are
+// all 1.0. For 5.1, set the surround weights to 1.41 and the LFE weight to 0.
+// Decaying filter state can become denormal after the input goes silent, so
+// consider running process() inside an SGDenormalGuard
+class SGLoudnessMeter {
+    static constexpr int32_t short_term_blocks_ = 30,
+        histogram_size_ = 8000; // -70 to +10 LUFS
+    static constexpr double histogram_min_ = -70.0;
+
+    struct Biquad {
+        Vec_ps b0, b1, b2, a1, a2, z1, z2;
+
+        Vec_ps sg_vectorcall(process)(const Vec_ps x) {
+            const Vec_ps y = x.mul_add(b0, z1);
+            z1 = x.mul_add(b1, z2) - y*a1;
+            z2 = x*b2 - y*a2;
+            return y;
+        }
+    };
+    struct Group {
+        Biquad shelf, highpass;
+        Vec_pd sum_lo, sum_hi;
+    };
+
+    std::vector<Group> groups_;
+    std::vector<double> weights_, ring_, bin_energy_;
+    std::vector<uint32_t> bin_count_;
+    double sample_rate_;
+    int32_t channel_count_, block_size_, block_pos_, ring_pos_;
+    uint64_t block_count_;
+
+    static double energy_to_lufs(const double energy) {
+        return -0.691 + 10.0*std::log10(energy);
+    }
+
+    // Mean weighted energy of the last block_count sub-blocks
+    double recent_energy(const int32_t block_count) const {
+        double sum = 0.0;
+        for (int32_t i = 1; i <= block_count; ++i) {
+            sum += ring_[(ring_pos_ - i + short_term_blocks_) %
+                short_term_blocks_];
+        }
+        return sum / (static_cast<double>(block_count) * block_size_);
+    }
+
+    void end_block() {
+        double energy = 0.0;
+        for (std::size_t g = 0; g < groups_.size(); ++g) {
+            double sums[4];
+            groups_[g].sum_lo.storeu(sums);
+            groups_[g].sum_hi.storeu(sums + 2);
+            for (int32_t k = 0; k < 4; ++k) energy += weights_[4*g + k]*sums[k];
+            groups_[g].sum_lo = Vec_pd{};
+            groups_[g].sum_hi = Vec_pd{};
+        }
+        ring_[ring_pos_] = energy;
+        ring_pos_ = (ring_pos_ + 1) % short_term_blocks_;
+        block_pos_ = 0;
+        ++block_count_;
+
+        // 400ms gating blocks, overlapping by 75%
+        if (block_count_ >= 4) {
+            const double gating_energy = recent_energy(4);
+            const double lufs = energy_to_lufs(gating_energy);
+            if (lufs > histogram_min_) {
+                const int32_t bin = std::min(histogram_size_ - 1,
+                    static_cast<int32_t>((lufs - histogram_min_) * 100.0));
+                ++bin_count_[bin];
+                bin_energy_[bin] += gating_energy;
+            }
+        }
+    }
+
+public:
+    SGLoudnessMeter(const double sample_rate, const int32_t channel_count)
+        : groups_((channel_count + 3) / 4),
+        weights_(4*groups_.size(), 0.0), ring_(short_term_blocks_, 0.0),
+        bin_energy_(histogram_size_, 0.0), bin_count_(histogram_size_, 0),
+        sample_rate_{sample_rate}, channel_count_{channel_count},
+        block_size_{static_cast<int32_t>(sample_rate*0.1 + 0.5)},
+        block_pos_{0}, ring_pos_{0}, block_count_{0}
+    {
+        std::fill(weights_.begin(), weights_.begin() + channel_count, 1.0);
+
+        // Analog prototypes of the K-weighting filters, from the BS.1770
+        // coefficients at 48kHz, so that any sample rate can be used
+        const double pi = 3.14159265358979323846;
+        double k = std::tan(pi * 1681.974450955533 / sample_rate);
+        const double q = 0.7071752369554196,
+            vh = std::pow(10.0, 3.999843853973347 / 20.0),
+            vb = std::pow(vh, 0.4996667741545416);
+        double a0 = 1.0 + k/q + k*k;
+        Biquad shelf;
+        shelf.b0 = static_cast<float>((vh + vb*k/q + k*k) / a0);
+        shelf.b1 = static_cast<float>(2.0*(k*k - vh) / a0);
+        shelf.b2 = static_cast<float>((vh - vb*k/q + k*k) / a0);
+        shelf.a1 = static_cast<float>(2.0*(k*k - 1.0) / a0);
+        shelf.a2 = static_cast<float>((1.0 - k/q + k*k) / a0);
+
+        k = std::tan(pi * 38.13547087602444 / sample_rate);
+        const double q_hp = 0.5003270373238773;
+        a0 = 1.0 + k/q_hp + k*k;
+        Biquad highpass;
+        highpass.b0 = 1.0f; highpass.b1 = -2.0f; highpass.b2 = 1.0f;
+        highpass.a1 = static_cast<float>(2.0*(k*k - 1.0) / a0);
+        highpass.a2 = static_cast<float>((1.0 - k/q_hp + k*k) / a0);
+
+        for (Group& g : groups_) { g.shelf = shelf; g.highpass = highpass; }
+    }
+
+    double sample_rate() const { return sample_rate_; }
+    int32_t channel_count() const { return channel_count_; }
+
+    void set_channel_weight(const int32_t channel, const double weight) {
+        weights_[channel] = weight;
+    }
+    double channel_weight(const int32_t channel) const {
+        return weights_[channel];
+    }
+
+    void reset() {
+        for (Group& g : groups_) {
+            g.shelf.z1 = Vec_ps{}; g.shelf.z2 = Vec_ps{};
+            g.highpass.z1 = Vec_ps{}; g.highpass.z2 = Vec_ps{};
+            g.sum_lo = Vec_pd{}; g.sum_hi = Vec_pd{};
+        }
+        std::fill(ring_.begin(), ring_.end(), 0.0);
+        std::fill(bin_energy_.begin(), bin_energy_.end(), 0.0);
+        std::fill(bin_count_.begin(), bin_count_.end(), 0);
+        block_pos_ = 0; ring_pos_ = 0; block_count_ = 0;
+    }
+
+    // channels[c] points to n samples of channel c (planar layout)
+    void process(const float *const *const channels, const std::size_t n) {
+        for (std::size_t i = 0; i < n; ) {
+            const std::size_t count = std::min(n - i,
+                static_cast<std::size_t>(block_size_ - block_pos_));
+            for (std::size_t g = 0; g < groups_.size(); ++g) {
+                Group& group = groups_[g];
+                const float *src[4] = { nullptr, nullptr, nullptr, nullptr };
+                for (int32_t k = 0; k < 4; ++k) {
+                    const int32_t c = 4*static_cast<int32_t>(g) + k;
+                    if (c < channel_count_) src[k] = channels[c] + i;
+                }
+                for (std::size_t j = 0; j < count; ++j) {
+                    float x[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                    for (int32_t k = 0; k < 4; ++k) {
+                        if (src[k] != nullptr) x[k] = src[k][j];
+                    }
+                    const Vec_ps y = group.highpass.process(
+                        group.shelf.process(Vec_ps::loadu(x)));
+                    const Vec_pd lo = y.to<Vec_pd>(),
+                        hi = y.shuffle<3, 2, 3, 2>().to<Vec_pd>();
+                    group.sum_lo = lo.mul_add(lo, group.sum_lo);
+                    group.sum_hi = hi.mul_add(hi, group.sum_hi);
+                }
+            }
+            i += count;
+            block_pos_ += static_cast<int32_t>(count);
+            if (block_pos_ == block_size_) end_block();
+        }
+    }
+
+    double momentary() const { return energy_to_lufs(recent_energy(4)); }
+    double short_term() const {
+        return energy_to_lufs(recent_energy(short_term_blocks_));
+    }
+
+    double integrated() const {
+        uint64_t count = 0;
+        double energy = 0.0;
+        for (int32_t i = 0; i < histogram_size_; ++i) {
+            count += bin_count_[i]; energy += bin_energy_[i];
+        }
+        if (count == 0) return energy_to_lufs(0.0);
+        const double gate = energy_to_lufs(energy / count) - 10.0;
+        const int32_t first_bin = std::max(0, std::min(histogram_size_ - 1,
+            static_cast<int32_t>((gate - histogram_min_) * 100.0)));
+        count = 0; energy = 0.0;
+        for (int32_t i = first_bin; i < histogram_size_; ++i) {
+            count += bin_count_[i]; energy += bin_energy_[i];
+        }
+        return energy_to_lufs(energy / count);
+    }
+};
+
+//
+//
+//
+//
+//
+//
+//
+// Gain section
+
+enum class SGRampType { linear, exponential };
+
+// Smoothed parameter for one channel, giving the values of the next 4 samples
+// at a time as a Vec_ps, to avoid zipper noise when a gain or other parameter
+// changes. The per-element offsets (linear) or factors (exponential) are
+// calculated once by set_target(), so each block of 4 costs one vector add or
+// multiply.
+// An exponential ramp sounds more even for gains, but both its start and its
+// target must be greater than zero (eg use sg_db_to_gain() of a floor such as
+// -120 dB rather than 0)
+class SGRamp {
+    Vec_ps lanes_;
+    double value_, step_[5];
+    float target_;
+    int64_t remaining_;
+    SGRampType type_;
+
+public:
+    explicit SGRamp(const float value = 0.0f,
+        const SGRampType type = SGRampType::linear)
+        : value_{value}, target_{value}, remaining_{0}, type_{type}
+    {
+        for (int32_t i = 0; i < 5; ++i) step_[i] = 0.0;
+    }
+
+    SGRampType type() const { return type_; }
+    float target() const { return target_; }
+    float value() const { return static_cast<float>(value_); }
+    bool is_ramping() const { return remaining_ > 0; }
+
+    // Jumps straight to value
+    void set_value(const float value) {
+        value_ = value; target_ = value; remaining_ = 0;
+    }
+
+    // Ramps from the current value to target over sample_count samples
+    void set_target(const float target, const int64_t sample_count) {
+        target_ = target;
+        if (sample_count <= 0 || static_cast<float>(value_) == target) {
+            set_value(target);
+            return;
+        }
+        remaining_ = sample_count;
+        if (type_ == SGRampType::linear) {
+            const double inc = (target - value_) / sample_count;
+            for (int32_t i = 0; i < 5; ++i) step_[i] = inc*i;
+        } else {
+            const double ratio = std::pow(target / value_,
+                1.0 / static_cast<double>(sample_count));
+            step_[0] = 1.0;
+            for (int32_t i = 1; i < 5; ++i) step_[i] = step_[i - 1]*ratio;
+        }
+        lanes_ = Vec_ps{static_cast<float>(step_[3]),
+            static_cast<float>(step_[2]), static_cast<float>(step_[1]),
+            static_cast<float>(step_[0])};
+    }
+
+    // The values of the next count (1 to 4) samples, in the lowest elements.
+    // Once the ramp has finished, all elements are the target
+    Vec_ps sg_vectorcall(next)(const int32_t count = 4) {
+        if (remaining_ <= 0) return target_;
+        const Vec_ps start{static_cast<float>(value_)};
+        Vec_ps result = type_ == SGRampType::linear ? start + lanes_ :
+            start * lanes_;
+        if (remaining_ < 4) {
+            result = (Vec_ps{3.0f, 2.0f, 1.0f, 0.0f} <
+                static_cast<float>(remaining_)).choose(result, target_);
+        }
+        remaining_ -= count;
+        if (remaining_ <= 0) {
+            value_ = target_;
+        } else if (type_ == SGRampType::linear) {
+            value_ += step_[count];
+        } else {
+            value_ *= step_[count];
+        }
+        return result;
+    }
+};
+
+// out = in * gain, where out may equal in
+inline void sg_apply_gain(const float *const in, float *const out,
+    const std::size_t n, SGRamp& gain)
+{
+    std::size_t i = 0;
+    if (!gain.is_ramping()) {
+        const Vec_ps g{gain.target()};
+        for (; i + 4 <= n; i += 4) {
+            (Vec_ps::loadu(in + i) * g).storeu(out + i);
+        }
+    } else {
+        for (; i + 4 <= n; i += 4) {
+            (Vec_ps::loadu(in + i) * gain.next()).storeu(out + i);
+        }
+    }
+    if (i < n) {
+        const int32_t count = static_cast<int32_t>(n - i);
+        sg_storeu_partial_ps_(sg_loadu_partial_ps_(in + i, count) *
+            gain.next(count), out + i, count);
+    }
+}
+
+// Equal power crossfade from a (position 0) to b (position 1):
+// out = a*cos(position*pi/2) + b*sin(position*pi/2).
+// out may equal a or b
+inline void sg_crossfade(const float *const a, const float *const b,
+    float *const out, const std::size_t n, SGRamp& position)
+{
+    for (std::size_t i = 0; i < n; i += 4) {
+        const int32_t count = static_cast<int32_t>(std::min<std::size_t>(4,
+            n - i));
+        Vec_ps gain_b, gain_a;
+        sg_sincospi(position.next(count) * 0.5f, gain_b, gain_a);
+        const Vec_ps result = sg_loadu_partial_ps_(a + i, count) * gain_a +
+            sg_loadu_partial_ps_(b + i, count) * gain_b;
+        sg_storeu_partial_ps_(result, out + i, count);
+    }
+}
+
+// Constant power pan of a mono input, from left (pan -1) to right (pan 1).
+// At the center, both outputs are the input * sqrt(0.5). left or right may
+// equal in
+inline void sg_pan(const float *const in, float *const left,
+    float *const right, const std::size_t n, SGRamp& pan)
+{
+    for (std::size_t i = 0; i < n; i += 4) {
+        const int32_t count = static_cast<int32_t>(std::min<std::size_t>(4,
+            n - i));
+        Vec_ps gain_r, gain_l;
+        sg_sincospi(pan.next(count).mul_add(0.25f, 0.25f), gain_r, gain_l);
+        const Vec_ps x = sg_loadu_partial_ps_(in + i, count);
+        sg_storeu_partial_ps_(x * gain_l, left + i, count);
+        sg_storeu_partial_ps_(x * gain_r, right + i, count);
+    }
+}
+
+// bus += gains[0]*inputs[0] + ... + gains[input_count - 1] *
+// inputs[input_count - 1], in one pass over bus. gains may be nullptr for
+// unity gain
+inline void sg_mix_accumulate(const float *const *const inputs,
+    const float *const gains, const std::size_t input_count,
+    float *const bus, const std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i += 4) {
+        const std::size_t count = std::min<std::size_t>(4, n - i);
+        Vec_ps acc = sg_loadu_partial_ps_(bus + i, count);
+        for (std::size_t k = 0; k < input_count; ++k) {
+            const Vec_ps x = sg_loadu_partial_ps_(inputs[k] + i, count);
+            acc = gains != nullptr ? x.mul_add(gains[k], acc) : acc + x;
+        }
+        sg_storeu_partial_ps_(acc, bus + i, count);
+    }
+}
+
+//
+//
+//
+//
+//
+//
+//
+// Dynamics section
+
+// One-pole envelope follower for 4 channels (one per element), with separate
+// attack and release times. Each element chooses its own coefficient without
+// branching, depending on whether its level is rising or falling
+class SGEnvelopeFollower {
+    Vec_ps env_;
+    float sample_rate_, attack_, release_;
+
+public:
+    // Coefficient of a one-pole smoother that moves 1 - 1/e of the way to its
+    // target in time_ms
+    static float time_to_coefficient(const float sample_rate,
+        const float time_ms)
+    {
+        return time_ms <= 0.0f ? 0.0f : static_cast<float>(
+            std::exp(-1000.0 / (static_cast<double>(time_ms) * sample_rate)));
+    }
+
+    SGEnvelopeFollower(const float sample_rate, const float attack_ms = 1.0f,
+        const float release_ms = 100.0f) : sample_rate_{sample_rate}
+    {
+        set_times(attack_ms, release_ms);
+    }
+
+    void set_times(const float attack_ms, const float release_ms) {
+        attack_ = time_to_coefficient(sample_rate_, attack_ms);
+        release_ = time_to_coefficient(sample_rate_, release_ms);
+    }
+
+    Vec_ps envelope() const { return env_; }
+    void reset() { env_ = Vec_ps{}; }
+
+    // level should be non-negative, eg the absolute value of the input
+    Vec_ps sg_vectorcall(process)(const Vec_ps level) {
+        const Vec_ps coef = (level > env_).choose(Vec_ps{attack_},
+            Vec_ps{release_});
+        env_ = (env_ - level).mul_add(coef, level);
+        return env_;
+    }
+
+    // Envelopes of the absolute values of up to 4 channels, in planar
+    // layout, one per element of the state. For more channels, use one
+    // follower per group of 4. out[c] may equal in[c]
+    void process(const float *const *const in, float *const *const out,
+        const int32_t channel_count, const std::size_t n)
+    {
+        assert(channel_count >= 0 && channel_count <= 4);
+        for (std::size_t i = 0; i < n; ++i) {
+            float x[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            for (int32_t c = 0; c < channel_count; ++c) x[c] = in[c][i];
+            float result[4];
+            process(Vec_ps::loadu(x).abs()).storeu(result);
+            for (int32_t c = 0; c < channel_count; ++c) out[c][i] = result[c];
+        }
+    }
+};
+
+// Soft knee gain computer, for compressors and limiters. Returns the gain
+// change in dB (zero or negative) for a level in dB. The knee is a quadratic
+// of width knee_db, centered on the threshold. A ratio of infinity limits
+template <typename VecType>
+inline VecType sg_vectorcall(sg_gain_computer_db)(const VecType level_db,
+    const typename VecType::elem_t threshold_db,
+    const typename VecType::elem_t ratio,
+    const typename VecType::elem_t knee_db)
+{
+    typedef typename VecType::elem_t elem_t;
+    const elem_t slope = elem_t(1) / ratio - elem_t(1),
+        half_knee = knee_db * elem_t(0.5);
+    const VecType over = level_db - threshold_db,
+        in_knee = over + half_knee;
+    // When knee_db is 0, the knee is never chosen
+    const VecType knee = in_knee * in_knee * (slope / (elem_t(2) * knee_db)),
+        above = over * slope;
+    return (over <= -half_knee).choose(VecType{},
+        (over < half_knee).choose(knee, above));
+}
+
+// Linear gain for a linear envelope, through sg_gain_computer_db(). Decibels
+// are converted using sg_log2() and sg_exp2()
+template <typename VecType>
+inline VecType sg_vectorcall(sg_compressor_gain)(const VecType envelope,
+    const typename VecType::elem_t threshold_db,
+    const typename VecType::elem_t ratio,
+    const typename VecType::elem_t knee_db)
+{
+    typedef typename VecType::elem_t elem_t;
+    const VecType level_db = sg_log2(envelope) *
+        elem_t(6.02059991327962390427477789449);
+    return sg_exp2(sg_gain_computer_db(level_db, threshold_db, ratio,
+        knee_db) * elem_t(0.166096404744368117393515971474));
+}
+
+// The sliding window kernels use the van Herk / Gil-Werman algorithm, with
+// about 3 comparisons per sample for any window length. The input is split
+// into blocks of window samples. Each window spans the end of one block and
+// the start of the next, so is the max of a suffix maximum of one block and a
+// prefix maximum of the next. Within a vector, prefix and suffix maxima take 2
+// shuffles and 2 maxima
+
+template <bool is_max>
+inline float sg_sliding_identity_() {
+    return is_max ? -std::numeric_limits<float>::infinity() :
+        std::numeric_limits<float>::infinity();
+}
+
+template <bool is_max>
+inline Vec_ps sg_vectorcall(sg_sliding_extreme_)(const Vec_ps a,
+    const Vec_ps b)
+{
+    return is_max ? Vec_ps::max(a, b) : Vec_ps::min(a, b);
+}
+
+template <bool is_max>
+inline float sg_sliding_extreme_(const float a, const float b) {
+    return is_max ? std::max(a, b) : std::min(a, b);
+}
+
+// Suffix maxima of in[0..count), of which the first out_count are stored
+template <bool is_max>
+inline void sg_sliding_suffix_(const float *const in, const std::size_t count,
+    float *const out, const std::size_t out_count)
+{
+    Vec_ps carry{sg_sliding_identity_<is_max>()};
+    std::size_t k = count;
+    for (; k >= 4; k -= 4) {
+        Vec_ps x = Vec_ps::loadu(in + k - 4);
+        x = sg_sliding_extreme_<is_max>(x, x.shuffle<3, 3, 2, 1>());
+        x = sg_sliding_extreme_<is_max>(x, x.shuffle<3, 3, 3, 2>());
+        x = sg_sliding_extreme_<is_max>(x, carry);
+        carry = x.shuffle<0, 0, 0, 0>();
+        if (k - 4 < out_count) {
+            sg_storeu_partial_ps_(x, out + k - 4, out_count - (k - 4));
+        }
+    }
+    float acc = carry.get<0>();
+    for (; k > 0; --k) {
+        acc = sg_sliding_extreme_<is_max>(acc, in[k - 1]);
+        if (k - 1 < out_count) out[k - 1] = acc;
+    }
+}
+
+// out[k] = max(carry, in[0], ..., in[k], other[k]) for k in [0, count).
+// other may equal out. Returns the max of carry and all of in
+template <bool is_max>
+inline float sg_sliding_prefix_(const float *const in, const std::size_t count,
+    const float *const other, float *const out, const float carry)
+{
+    Vec_ps carry_v{carry};
+    std::size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        Vec_ps x = Vec_ps::loadu(in + k);
+        x = sg_sliding_extreme_<is_max>(x, x.shuffle<2, 1, 0, 0>());
+        x = sg_sliding_extreme_<is_max>(x, x.shuffle<1, 0, 0, 0>());
+        x = sg_sliding_extreme_<is_max>(x, carry_v);
+        carry_v = x.shuffle<3, 3, 3, 3>();
+        sg_sliding_extreme_<is_max>(x, Vec_ps::loadu(other + k))
+            .storeu(out + k);
+    }
+    float acc = carry_v.get<0>();
+    for (; k < count; ++k) {
+        acc = sg_sliding_extreme_<is_max>(acc, in[k]);
+        out[k] = sg_sliding_extreme_<is_max>(acc, other[k]);
+    }
+    return acc;
+}
+
+template <bool is_max>
+inline void sg_sliding_kernel_(const float *const in,
+    const std::size_t window, float *const out, const std::size_t n)
+{
+    // Short windows are quicker directly
+    if (window < 16) {
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            Vec_ps acc = Vec_ps::loadu(in + i);
+            for (std::size_t k = 1; k < window; ++k) {
+                acc = sg_sliding_extreme_<is_max>(acc,
+                    Vec_ps::loadu(in + i + k));
+            }
+            acc.storeu(out + i);
+        }
+        for (; i < n; ++i) {
+            float acc = in[i];
+            for (std::size_t k = 1; k < window; ++k) {
+                acc = sg_sliding_extreme_<is_max>(acc, in[i + k]);
+            }
+            out[i] = acc;
+        }
+        return;
+    }
+    // The window starting at i is the suffix of i's block, and the prefix of
+    // the next block up to i + window - 1. out[0] is a whole block
+    for (std::size_t b = 0; b < n; b += window) {
+        sg_sliding_suffix_<is_max>(in + b, window, out + b,
+            std::min(window, n - b));
+    }
+    const std::size_t end = n + window - 1;
+    for (std::size_t b = window; b < end; b += window) {
+        float *const out_b = out + b - (window - 1);
+        sg_sliding_prefix_<is_max>(in + b, std::min(window, end - b), out_b,
+            out_b, sg_sliding_identity_<is_max>());
+    }
+}
+
+// out[i] = max(in[i], in[i + 1], ..., in[i + window - 1]), for i in [0, n).
+// in must have n + window - 1 readable elements, and must not alias out
+inline void sg_sliding_max_kernel(const float *const in,
+    const std::size_t window, float *const out, const std::size_t n)
+{
+    sg_sliding_kernel_<true>(in, window, out, n);
+}
+
+// As sg_sliding_max_kernel(), but the minimum
+inline void sg_sliding_min_kernel(const float *const in,
+    const std::size_t window, float *const out, const std::size_t n)
+{
+    sg_sliding_kernel_<false>(in, window, out, n);
+}
+
+// Streaming sliding maximum (SGSlidingMax) or minimum (SGSlidingMin) of the
+// last window samples, for blocks of any length. Until window samples have
+// been processed, it is over all samples so far. Keeps the suffix maxima of
+// the last whole block of window samples, and the running prefix maximum of
+// the current block. Allocates 2 * window floats on construction
+template <bool is_max>
+class SGSlidingWindow {
+    std::vector<float> current_, suffix_;
+    float prefix_;
+    std::size_t window_, phase_;
+
+public:
+    explicit SGSlidingWindow(const std::size_t window)
+        : current_(std::max<std::size_t>(1, window)),
+        suffix_(current_.size() + 4),
+        window_{current_.size()}
+    {
+        reset();
+    }
+
+    std::size_t window() const { return window_; }
+
+    void reset() {
+        std::fill(suffix_.begin(), suffix_.end(),
+            sg_sliding_identity_<is_max>());
+        prefix_ = sg_sliding_identity_<is_max>();
+        phase_ = 0;
+    }
+
+    // out may equal in
+    void process(const float *const in, float *const out,
+        const std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; ) {
+            const std::size_t count = std::min(n - i, window_ - phase_);
+            std::copy(in + i, in + i + count, current_.begin() + phase_);
+            // suffix_[window_] onwards are the identity, for the last output
+            // of each block
+            prefix_ = sg_sliding_prefix_<is_max>(current_.data() + phase_,
+                count, suffix_.data() + phase_ + 1, out + i, prefix_);
+            phase_ += count;
+            i += count;
+            if (phase_ == window_) {
+                sg_sliding_suffix_<is_max>(current_.data(), window_,
+                    suffix_.data(), window_);
+                prefix_ = sg_sliding_identity_<is_max>();
+                phase_ = 0;
+            }
+        }
+    }
+};
+
+typedef SGSlidingWindow<true> SGSlidingMax;
+typedef SGSlidingWindow<false> SGSlidingMin;
+
+// Brickwall lookahead peak limiter for any number of linked channels, in
+// planar layout. The gain needed for each sample is the ceiling divided by
+// the sliding maximum of the peak over all channels, which is then smoothed by
+// a moving average over the lookahead time (so that no output sample exceeds
+// the ceiling) and a one-pole release. The output is delayed by latency()
+// samples
+class SGLookaheadLimiter {
+    std::vector<SGDelayFixed> delays_;
+    std::vector<float> gain_, average_;
+    double average_sum_;
+    float ceiling_, release_, smoothed_;
+    std::size_t window_, average_pos_, max_block_;
+    SGSlidingMax peak_max_;
+
+public:
+    SGLookaheadLimiter(const int32_t channel_count, const float sample_rate,
+        const float ceiling = 1.0f, const float lookahead_ms = 5.0f,
+        const float release_ms = 50.0f, const std::size_t max_block = 256)
+        : ceiling_{ceiling}, release_{SGEnvelopeFollower::time_to_coefficient(
+            sample_rate, release_ms)},
+        window_{std::max<std::size_t>(1, static_cast<std::size_t>(
+            lookahead_ms * 0.001f * sample_rate + 0.5f))},
+        max_block_{max_block}, peak_max_{window_}
+    {
+        delays_.reserve(channel_count);
+        for (int32_t c = 0; c < channel_count; ++c) {
+            delays_.emplace_back(window_ - 1, max_block);
+        }
+        gain_.resize(max_block);
+        average_.resize(window_);
+        reset();
+    }
+
+    std::size_t latency() const { return window_ - 1; }
+    float ceiling() const { return ceiling_; }
+
+    // Gain applied to the most recent output sample
+    float gain() const { return smoothed_; }
+
+    void reset() {
+        for (SGDelayFixed& d : delays_) d.reset();
+        peak_max_.reset();
+        std::fill(average_.begin(), average_.end(), 1.0f);
+        average_sum_ = static_cast<double>(window_);
+        average_pos_ = 0;
+        smoothed_ = 1.0f;
+    }
+
+    // out[c] may equal in[c]
+    void process(const float *const *const in, float *const *const out,
+        const std::size_t n)
+    {
+        for (std::size_t pos = 0; pos < n; ) {
+            const std::size_t block = std::min(n - pos, max_block_);
+
+            // Peak over all channels, then over the lookahead window
+            for (std::size_t i = 0; i < block; i += 4) {
+                const std::size_t count = std::min<std::size_t>(4, block - i);
+                Vec_ps peak;
+                for (std::size_t c = 0; c < delays_.size(); ++c) {
+                    peak = Vec_ps::max(peak,
+                        sg_loadu_partial_ps_(in[c] + pos + i, count).abs());
+                }
+                sg_storeu_partial_ps_(peak, gain_.data() + i, count);
+            }
+            peak_max_.process(gain_.data(), gain_.data(), block);
+            sg_map_ps(gain_.data(), block, [&](const Vec_ps peak) {
+                return Vec_ps{ceiling_} / Vec_ps::max(peak, ceiling_);
+            });
+
+            // The moving average and release are sequential
+            for (std::size_t i = 0; i < block; ++i) {
+                average_sum_ += gain_[i] - average_[average_pos_];
+                average_[average_pos_] = gain_[i];
+                average_pos_ = average_pos_ + 1 == window_ ? 0 :
+                    average_pos_ + 1;
+                const float target = std::min(1.0f,
+                    static_cast<float>(average_sum_ / window_));
+                smoothed_ = target < smoothed_ ? target :
+                    target + release_*(smoothed_ - target);
+                gain_[i] = smoothed_;
+            }
+
+            for (std::size_t c = 0; c < delays_.size(); ++c) {
+                delays_[c].process(in[c] + pos, out[c] + pos, block);
+                std::size_t i = 0;
+                for (; i + 4 <= block; i += 4) {
+                    (Vec_ps::loadu(out[c] + pos + i) *
+                        Vec_ps::loadu(gain_.data() + i))
+                        .storeu(out[c] + pos + i);
+                }
+                for (; i < block; ++i) out[c][pos + i] *= gain_[i];
+            }
+            pos += block;
+        }
+    }
+};
+
+//
+//
+//
+//
+//
+//
+//
+// Delay line section
+
+enum class SGInterpType { none, linear, hermite };
+
+// Linear interpolation between x0 (u = 0) and x1 (u = 1)
+template <typename VecType>
+inline VecType sg_vectorcall(sg_interp_linear)(const VecType x0,
+    const VecType x1, const VecType u)
+{
+    return (x1 - x0).mul_add(u, x0);
+}
+
+// 4 point, 3rd order Hermite (Catmull-Rom) interpolation between x0 (u = 0)
+// and x1 (u = 1)
+template <typename VecType>
+inline VecType sg_vectorcall(sg_interp_hermite)(const VecType xm1,
+    const VecType x0, const VecType x1, const VecType x2, const VecType u)
+{
+    typedef typename VecType::elem_t elem_t;
+    const VecType c1 = (x1 - xm1) * elem_t(0.5),
+        c2 = xm1 - x0*elem_t(2.5) + x1*elem_t(2) - x2*elem_t(0.5),
+        c3 = (x2 - xm1)*elem_t(0.5) + (x0 - x1)*elem_t(1.5);
+    return c3.mul_add(u, c2).mul_add(u, c1).mul_add(u, x0);
+}
+
+// Circular delay line for any number of channels. Each channel is a power of
+// two length ring buffer, followed by a mirror of its first few samples, so
+// that reading 4 consecutive samples (plus interpolation taps) from any index
+// is a plain Vec_ps::loadu() and never needs to handle wrapping.
+//
+// write() adds n samples to every channel, then the read functions give n
+// samples of one channel for the same block, each delayed by a fractional
+// number of samples:
+// - none rounds the delay to a whole number of samples, from 0
+// - linear needs a delay of at least 1
+// - hermite needs a delay of at least 2
+// Delays may be up to the max_delay given to the constructor.
+class SGDelayLine {
+    static constexpr int32_t guard_ = 8;
+
+    std::vector<float> buf_;
+    int32_t channel_count_, size_, mask_, stride_, write_pos_, max_block_,
+        max_delay_;
+
+    static int32_t ring_size(const int32_t min_size) {
+        int32_t size = 4;
+        while (size < min_size) size *= 2;
+        return size;
+    }
+
+    // Position of the first sample of the last block written, and a pointer
+    // to the channel
+    int32_t block_start(const std::size_t n) const {
+        return (write_pos_ - static_cast<int32_t>(n)) & mask_;
+    }
+    const float *channel_data(const int32_t channel) const {
+        return buf_.data() + static_cast<std::size_t>(channel)*stride_;
+    }
+
+    // 4 consecutive outputs, with the oldest interpolation tap at p
+    static Vec_ps sg_vectorcall(interpolate)(const float *const p,
+        const Vec_ps u, const SGInterpType interp)
+    {
+        if (interp == SGInterpType::none) return Vec_ps::loadu(p + 1);
+        if (interp == SGInterpType::linear) {
+            return sg_interp_linear(Vec_ps::loadu(p + 1),
+                Vec_ps::loadu(p + 2), u);
+        }
+        return sg_interp_hermite(Vec_ps::loadu(p), Vec_ps::loadu(p + 1),
+            Vec_ps::loadu(p + 2), Vec_ps::loadu(p + 3), u);
+    }
+
+    // out[i] = gain * x[t + i - delay] (+ out[i] if accumulate)
+    void tap(const int32_t channel, const float delay, const float gain,
+        float *const out, const std::size_t n, const SGInterpType interp,
+        const bool accumulate) const
+    {
+        const float *const data = channel_data(channel);
+        // Split the delay so that 0 <= u < 1, and the result is between
+        // x[whole] (u = 0) and x[whole + 1]
+        int32_t whole;
+        float u = 0.0f;
+        if (interp == SGInterpType::none) {
+            whole = static_cast<int32_t>(std::floor(0.5f - delay));
+        } else {
+            whole = -static_cast<int32_t>(std::ceil(delay));
+            u = static_cast<float>(-whole) - delay;
+        }
+        const int32_t start = block_start(n) + whole - 1;
+        for (std::size_t i = 0; i < n; i += 4) {
+            const std::size_t count = std::min<std::size_t>(4, n - i);
+            Vec_ps y = interpolate(data + ((start + static_cast<int32_t>(i)) &
+                mask_), u, interp) * gain;
+            if (accumulate) y += sg_loadu_partial_ps_(out + i, count);
+            sg_storeu_partial_ps_(y, out + i, count);
+        }
+    }
+
+public:
+    SGDelayLine(const int32_t max_delay, const int32_t channel_count = 1,
+        const int32_t max_block = 256)
+        : channel_count_{channel_count},
+        size_{ring_size(max_delay + max_block + 4)}, mask_{size_ - 1},
+        stride_{size_ + guard_}, write_pos_{0}, max_block_{max_block},
+        max_delay_{max_delay}
+    {
+        buf_.resize(static_cast<std::size_t>(stride_) * channel_count, 0.0f);
+    }
+
+    int32_t channel_count() const { return channel_count_; }
+    int32_t max_delay() const { return max_delay_; }
+    int32_t max_block() const { return max_block_; }
+
+    void reset() { std::fill(buf_.begin(), buf_.end(), 0.0f); write_pos_ = 0; }
+
+    // Writes n (at most max_block) samples to each channel, in planar layout
+    void write(const float *const *const in, const std::size_t n) {
+        const int32_t count = static_cast<int32_t>(n);
+        for (int32_t c = 0; c < channel_count_; ++c) {
+            float *const data = buf_.data() +
+                static_cast<std::size_t>(c)*stride_;
+            const int32_t first = std::min(count, size_ - write_pos_);
+            std::copy(in[c], in[c] + first, data + write_pos_);
+            std::copy(in[c] + first, in[c] + count, data);
+            std::copy(data, data + guard_, data + size_);
+        }
+        write_pos_ = (write_pos_ + count) & mask_;
+    }
+
+    // The last block written to channel, delayed by delay samples
+    void read(const int32_t channel, const float delay, float *const out,
+        const std::size_t n,
+        const SGInterpType interp = SGInterpType::linear) const
+    {
+        tap(channel, delay, 1.0f, out, n, interp, false);
+    }
+
+    // The sum of tap_count taps of the last block written to channel, each
+    // with its own delay and gain
+    void read_taps(const int32_t channel, const float *const delays,
+        const float *const gains, const std::size_t tap_count,
+        float *const out, const std::size_t n,
+        const SGInterpType interp = SGInterpType::linear) const
+    {
+        std::fill(out, out + n, 0.0f);
+        for (std::size_t k = 0; k < tap_count; ++k) {
+            tap(channel, delays[k], gains[k], out, n, interp, true);
+        }
+    }
+
+    // As read(), with a different delay for each sample, eg for chorus and
+    // flanging. The ring buffer indices are calculated in a Vec_pi32
+    void read_modulated(const int32_t channel, const float *const delays,
+        float *const out, const std::size_t n,
+        const SGInterpType interp = SGInterpType::linear) const
+    {
+        const float *const data = channel_data(channel);
+        const Vec_pi32 start = Vec_pi32{3, 2, 1, 0} + block_start(n);
+        for (std::size_t i = 0; i < n; i += 4) {
+            const std::size_t count = std::min<std::size_t>(4, n - i);
+            Vec_ps position = (start + static_cast<int32_t>(i)).to<Vec_ps>()
+                - sg_loadu_partial_ps_(delays + i, count);
+            if (interp == SGInterpType::none) position += 0.5f;
+            const Vec_pi32 whole = position.floor<Vec_pi32>();
+            const Vec_ps u = position - whole.to<Vec_ps>();
+            int32_t index[4];
+            ((whole - 1) & mask_).storeu(index);
+            // Transpose the taps of each element into one vector per tap
+            float taps[4][4];
+            for (int32_t k = 0; k < 4; ++k) {
+                Vec_ps::loadu(data + index[k]).storeu(taps[k]);
+            }
+            Vec_ps x[4];
+            for (int32_t j = 0; j < 4; ++j) {
+                x[j] = Vec_ps{taps[3][j], taps[2][j], taps[1][j], taps[0][j]};
+            }
+            Vec_ps y;
+            if (interp == SGInterpType::none) {
+                y = x[1];
+            } else if (interp == SGInterpType::linear) {
+                y = sg_interp_linear(x[1], x[2], u);
+            } else {
+                y = sg_interp_hermite(x[0], x[1], x[2], x[3], u);
+            }
+            sg_storeu_partial_ps_(y, out + i, count);
+        }
+    }
+};
+
+} // namespace simd_granodi
+
+#endif // SIMD_GRANODI_DSP_H
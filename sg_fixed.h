@@ -0,0 +1,185 @@
+#ifndef SIMD_GRANODI_FIXED_H
+#define SIMD_GRANODI_FIXED_H
+
+/*
+
+SIMD GRANODI FIXED
+
+Copyright (c) 2021-2022 Jon Ville
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+/*
+
+Fixed point types written in terms of the C++ classes in simd_granodi.h, for
+pipelines that must give bit-exact results on every platform. All arithmetic
+is integer arithmetic, and saturates instead of wrapping. Conversions from
+float round to nearest and saturate.
+
+- SGQ31: 4 x Q31 (range [-1, 1), step 2^-31), held in a Vec_pi32. Multiply
+  uses qrdmulh() (vqrdmulhq_s32 on NEON)
+- SGQ15: 4 x Q15 (range [-1, 1), step 2^-15), held in the 32-bit elements
+  of a Vec_pi32, so that products are exact before rounding. Loads from and
+  stores to int16_t arrays
+
+*/
+
+#include "simd_granodi.h"
+
+namespace simd_granodi {
+
+//
+//
+//
+//
+//
+//
+//
+// Q31 section
+
+class SGQ31 {
+    Vec_pi32 data_;
+
+public:
+    SGQ31() {}
+    // From the raw Q31 values
+    explicit SGQ31(const Vec_pi32 raw) : data_{raw} {}
+
+    Vec_pi32 sg_vectorcall(raw)() const { return data_; }
+
+    // The largest float below 1.0 in Q31 is 2^31 - 128
+    static SGQ31 sg_vectorcall(from_ps)(const Vec_ps x) {
+        return SGQ31{(x * 2147483648.0f).constrain(-2147483648.0f,
+            2147483520.0f).nearest<Vec_pi32>()};
+    }
+    // Rounds to the nearest float
+    Vec_ps sg_vectorcall(to_ps)() const {
+        return data_.to<Vec_ps>() * (1.0f / 2147483648.0f);
+    }
+
+    SGQ31 sg_vectorcall(operator+)(const SGQ31 rhs) const {
+        return SGQ31{data_.adds(rhs.data_)};
+    }
+    SGQ31 sg_vectorcall(operator-)(const SGQ31 rhs) const {
+        return SGQ31{data_.subs(rhs.data_)};
+    }
+    SGQ31 sg_vectorcall(operator-)() const {
+        return SGQ31{Vec_pi32{}.subs(data_)};
+    }
+    // Rounds to nearest, with ties upwards. -1 * -1 saturates to 1 - 2^-31
+    SGQ31 sg_vectorcall(operator*)(const SGQ31 rhs) const {
+        return SGQ31{data_.qrdmulh(rhs.data_)};
+    }
+    // this*mul + add, rounding the product before adding
+    SGQ31 sg_vectorcall(mul_add)(const SGQ31 mul, const SGQ31 add) const {
+        return SGQ31{data_.qrdmulh(mul.data_).adds(add.data_)};
+    }
+
+    SGQ31& sg_vectorcall(operator+=)(const SGQ31 rhs) {
+        *this = *this + rhs; return *this;
+    }
+    SGQ31& sg_vectorcall(operator-=)(const SGQ31 rhs) {
+        *this = *this - rhs; return *this;
+    }
+    SGQ31& sg_vectorcall(operator*=)(const SGQ31 rhs) {
+        *this = *this * rhs; return *this;
+    }
+};
+
+//
+//
+//
+//
+//
+//
+//
+// Q15 section
+
+class SGQ15 {
+    Vec_pi32 data_; // Always in [-32768, 32767]
+
+    static Vec_pi32 sg_vectorcall(saturate_)(const Vec_pi32 x) {
+        return x.constrain(-32768, 32767);
+    }
+
+public:
+    SGQ15() {}
+    // From the raw Q15 values, which are saturated to the int16_t range
+    explicit SGQ15(const Vec_pi32 raw) : data_{saturate_(raw)} {}
+
+    Vec_pi32 sg_vectorcall(raw)() const { return data_; }
+
+    static SGQ15 sg_vectorcall(loadu)(const int16_t *const s) {
+        return SGQ15{Vec_pi32{s[3], s[2], s[1], s[0]}};
+    }
+    void sg_vectorcall(storeu)(int16_t *const s) const {
+        int32_t raw[4];
+        data_.storeu(raw);
+        for (int32_t i = 0; i < 4; ++i) s[i] = static_cast<int16_t>(raw[i]);
+    }
+    // Stores lo then hi as 8 x int16_t
+    static void sg_vectorcall(storeu)(int16_t *const s, const SGQ15 lo,
+        const SGQ15 hi)
+    {
+        lo.data_.storeu_sat16(s, hi.data_);
+    }
+
+    static SGQ15 sg_vectorcall(from_ps)(const Vec_ps x) {
+        return SGQ15{(x * 32768.0f).constrain(-32768.0f, 32767.0f)
+            .nearest<Vec_pi32>()};
+    }
+    // Exact
+    Vec_ps sg_vectorcall(to_ps)() const {
+        return data_.to<Vec_ps>() * (1.0f / 32768.0f);
+    }
+
+    SGQ15 sg_vectorcall(operator+)(const SGQ15 rhs) const {
+        return SGQ15{data_ + rhs.data_};
+    }
+    SGQ15 sg_vectorcall(operator-)(const SGQ15 rhs) const {
+        return SGQ15{data_ - rhs.data_};
+    }
+    SGQ15 sg_vectorcall(operator-)() const { return SGQ15{-data_}; }
+    // Rounds to nearest, with ties upwards, as vqrdmulhq_s16. The product of
+    // two Q15 values fits in 31 bits, so this is exact before rounding
+    SGQ15 sg_vectorcall(operator*)(const SGQ15 rhs) const {
+        return SGQ15{(data_*rhs.data_ + 16384).shift_ra_imm<15>()};
+    }
+    // this*mul + add, with one rounding. The sum fits in an int32_t
+    SGQ15 sg_vectorcall(mul_add)(const SGQ15 mul, const SGQ15 add) const {
+        return SGQ15{(data_*mul.data_ + add.data_.shift_l_imm<15>() + 16384)
+            .shift_ra_imm<15>()};
+    }
+
+    SGQ15& sg_vectorcall(operator+=)(const SGQ15 rhs) {
+        *this = *this + rhs; return *this;
+    }
+    SGQ15& sg_vectorcall(operator-=)(const SGQ15 rhs) {
+        *this = *this - rhs; return *this;
+    }
+    SGQ15& sg_vectorcall(operator*=)(const SGQ15 rhs) {
+        *this = *this * rhs; return *this;
+    }
+};
+
+} // namespace simd_granodi
+
+#endif // SIMD_GRANODI_FIXED_H
@@ -0,0 +1,1001 @@
+#ifndef SIMD_GRANODI_MATH_H
+#define SIMD_GRANODI_MATH_H
+
+/*
+
+SIMD GRANODI MATH
+
+Copyright (c) 2021-2022 Jon Ville
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+/*
+
+Vectorized math functions, written as templates in terms of the C++ classes
+in simd_granodi.h.
+
+Every function accepts any of the floating point Vec_ types: Vec_ps, Vec_pd,
+Vec_f32x2, and the scalar wrappers Vec_f32x1 and Vec_f64x1. Separate
+polynomials are used for float and double elements, so each type gets close to
+full precision for its element type.
+
+All functions are branch-free: where a function has several input ranges, every
+range is calculated and the result selected with Compare_::choose().
+
+Corner cases:
+- NaN inputs are NOT guaranteed to propagate to the output
+- Infinite inputs give the limit of the function where it has one
+- Results that would be denormal may be flushed to zero
+
+*/
+
+#include "simd_granodi.h"
+
+#include <limits>
+
+#ifndef __cplusplus
+#error "sg_math.h requires C++"
+#endif
+
+namespace simd_granodi {
+
+//
+//
+//
+//
+//
+//
+//
+// Float traits section
+
+template <typename ElemType>
+struct SGFloatTraits {};
+
+template <> struct SGFloatTraits<float> {
+    static constexpr int32_t mantissa_bits = 23, exponent_bias = 127;
+    // Adding this to an integer-valued float in [-bias, bias] places the
+    // biased exponent in the low mantissa bits
+    static constexpr float exponent_magic() { return 8388608.0f + 127.0f; }
+    // Cody-Waite split of ln(2): n * ln2_hi() is exact for |n| < 2^15
+    static constexpr float ln2_hi() { return 0.693359375f; }
+    static constexpr float ln2_lo() { return -2.12194440e-4f; }
+    // Range of x for which e^x is calculated before clamping. Outside this
+    // range, the result is always 0 or infinity
+    static constexpr float exp_min() { return -174.0f; }
+    static constexpr float exp_max() { return 176.0f; }
+    // |x| above which tanh(x) rounds to 1
+    static constexpr float tanh_max() { return 20.0f; }
+    // |x| above which sqrt(x^2 + 1) rounds to |x|
+    static constexpr float asinh_large() { return 4096.0f; }
+    // Veltkamp splitting constant, 2^ceil(mantissa_bits / 2) + 1
+    static constexpr float split() { return 4097.0f; }
+    // |y| above which x^y is always 0, 1 or infinity
+    static constexpr float pow_y_max() { return 4294967296.0f; }
+    // ln(10) / 20 (nepers per decibel), and 20 / ln(10), split in two
+    static constexpr float ln10_div_20_hi() { return 1.151292548e-1f; }
+    static constexpr float ln10_div_20_lo() { return -1.086557164e-10f; }
+    static constexpr float twenty_div_ln10_hi() { return 8.685889244f; }
+    static constexpr float twenty_div_ln10_lo() { return 3.939854594e-7f; }
+    // pi, split in two
+    static constexpr float pi_hi() { return 3.14159274101e+0f; }
+    static constexpr float pi_lo() { return -8.74227765735e-8f; }
+};
+
+template <> struct SGFloatTraits<double> {
+    static constexpr int32_t mantissa_bits = 52, exponent_bias = 1023;
+    static constexpr double exponent_magic() {
+        return 4503599627370496.0 + 1023.0;
+    }
+    // n * ln2_hi() is exact for |n| < 2^20
+    static constexpr double ln2_hi() { return 6.93147180369123816490e-1; }
+    static constexpr double ln2_lo() { return 1.90821492927058770002e-10; }
+    static constexpr double exp_min() { return -1416.0; }
+    static constexpr double exp_max() { return 1418.0; }
+    static constexpr double tanh_max() { return 20.0; }
+    static constexpr double asinh_large() { return 268435456.0; }
+    static constexpr double split() { return 134217729.0; }
+    static constexpr double pow_y_max() { return 18446744073709551616.0; }
+    static constexpr double ln10_div_20_hi() {
+        return 1.15129254649702278401e-1;
+    }
+    static constexpr double ln10_div_20_lo() {
+        return 5.79956425246610058218e-18;
+    }
+    static constexpr double twenty_div_ln10_hi() {
+        return 8.68588963806503677745;
+    }
+    static constexpr double twenty_div_ln10_lo() {
+        return -2.24425279806709595459e-16;
+    }
+    static constexpr double pi_hi() { return 3.14159265358979311600e+0; }
+    static constexpr double pi_lo() { return 1.22464679914735317723e-16; }
+};
+
+//
+//
+//
+//
+//
+//
+//
+// Helper section
+// Functions ending in an underscore are implementation details, and may
+// change or be removed
+
+// c[0] + c[1]*x + c[2]*x^2 ... by Horner's method
+template <typename VecType, std::size_t N>
+inline VecType sg_vectorcall(sg_poly_)(const VecType x,
+    const typename VecType::elem_t (&c)[N])
+{
+    VecType result = c[N - 1];
+    for (std::size_t i = N - 1; i > 0; --i) {
+        result = result.mul_add(x, c[i - 1]);
+    }
+    return result;
+}
+
+template <typename VecType>
+inline VecType sg_vectorcall(sg_signbit_mask_)() {
+    return VecType{typename VecType::elem_t(-0.0)};
+}
+
+// Round to nearest integer, staying in floating point. Only valid for inputs
+// that fit in the fast conversion integer type
+template <typename VecType>
+inline VecType sg_vectorcall(sg_round_)(const VecType x) {
+    return x.template nearest<typename VecType::fast_convert_int_t>()
+        .template to<VecType>();
+}
+
+// Round to nearest integer, for any x
+template <typename VecType>
+inline VecType sg_vectorcall(sg_round_any_)(const VecType x) {
+    typedef typename VecType::elem_t elem_t;
+    typedef typename SGEquivIntType<VecType>::value::elem_t int_elem_t;
+    // Above 2^mantissa_bits, every float is an integer. Below it, adding and
+    // subtracting 2^mantissa_bits rounds away the fraction
+    const VecType ax = x.abs(), magic = elem_t(
+        int_elem_t(1) << SGFloatTraits<elem_t>::mantissa_bits);
+    return (ax < magic).choose((ax + magic) - magic, ax) |
+        (x & sg_signbit_mask_<VecType>());
+}
+
+// 2^n, where n is integer valued and a valid (not denormal) exponent
+template <typename VecType>
+inline VecType sg_vectorcall(sg_pow2_int_)(const VecType n) {
+    typedef SGFloatTraits<typename VecType::elem_t> traits;
+    typedef typename SGEquivIntType<VecType>::value int_t;
+    // The magic number's own bits are masked off first, so that the shift
+    // never overflows
+    const int_t exponent_mask{typename int_t::elem_t(
+        2*traits::exponent_bias + 1)};
+    return ((n + traits::exponent_magic()).template bitcast<int_t>() &
+        exponent_mask).template shift_l_imm<traits::mantissa_bits>()
+        .template bitcast<VecType>();
+}
+
+// x * 2^n, where n is integer valued and x * 2^n is in range. n is split in two
+// so that each half is a valid exponent, and x * 2^n may be denormal
+template <typename VecType>
+inline VecType sg_vectorcall(sg_scale_pow2_)(const VecType x, const VecType n) {
+    const VecType n_half = sg_round_(n * 0.5f);
+    return x * sg_pow2_int_(n_half) * sg_pow2_int_(n - n_half);
+}
+
+// Error-free transformations, for extra precision where it is needed.
+// a + b = sum + err exactly
+template <typename VecType>
+inline void sg_vectorcall(sg_two_sum_)(const VecType a, const VecType b,
+    VecType& sum, VecType& err)
+{
+    sum = a + b;
+    const VecType b_virtual = sum - a;
+    err = (a - (sum - b_virtual)) + (b - b_virtual);
+}
+// As above, but only valid if the exponent of a is at least that of b
+template <typename VecType>
+inline void sg_vectorcall(sg_fast_two_sum_)(const VecType a, const VecType b,
+    VecType& sum, VecType& err)
+{
+    sum = a + b;
+    err = b - (sum - a);
+}
+// a = hi + lo exactly, with each half having half of the mantissa bits
+template <typename VecType>
+inline void sg_vectorcall(sg_split_)(const VecType a, VecType& hi,
+    VecType& lo)
+{
+    const VecType c = a * SGFloatTraits<typename VecType::elem_t>::split();
+    hi = c - (c - a);
+    lo = a - hi;
+}
+// a * b = prod + err exactly, if no overflow or underflow
+template <typename VecType>
+inline void sg_vectorcall(sg_two_prod_)(const VecType a, const VecType b,
+    VecType& prod, VecType& err)
+{
+    VecType a_hi, a_lo, b_hi, b_lo;
+    sg_split_(a, a_hi, a_lo);
+    sg_split_(b, b_hi, b_lo);
+    prod = a * b;
+    err = (((a_hi * b_hi - prod) + a_hi * b_lo) + a_lo * b_hi) + a_lo * b_lo;
+}
+
+// e^r - 1 for |r| <= ln(2)/2, by Taylor series
+template <typename VecType>
+inline VecType sg_vectorcall(sg_expm1_kernel_)(const VecType r, float) {
+    static const float c[] = { 1.0f, 1.0f/2, 1.0f/6, 1.0f/24, 1.0f/120,
+        1.0f/720, 1.0f/5040 };
+    return r * sg_poly_(r, c);
+}
+template <typename VecType>
+inline VecType sg_vectorcall(sg_expm1_kernel_)(const VecType r, double) {
+    static const double c[] = { 1.0, 1.0/2, 1.0/6, 1.0/24, 1.0/120, 1.0/720,
+        1.0/5040, 1.0/40320, 1.0/362880, 1.0/3628800, 1.0/39916800,
+        1.0/479001600, 1.0/6227020800 };
+    return r * sg_poly_(r, c);
+}
+
+// Splits x into n * ln(2) + r, and returns e^r - 1, setting n
+template <typename VecType>
+inline VecType sg_vectorcall(sg_exp_reduce_)(const VecType x, VecType& n) {
+    typedef typename VecType::elem_t elem_t;
+    typedef SGFloatTraits<elem_t> traits;
+    const VecType xc = x.constrain(traits::exp_min(), traits::exp_max());
+    n = sg_round_(xc * elem_t(1.44269504088896340736));
+    const VecType r = (xc - n * traits::ln2_hi()) - n * traits::ln2_lo();
+    return sg_expm1_kernel_(r, elem_t{});
+}
+// As above, for x = hi + lo, where |lo| is much smaller than |hi|
+template <typename VecType>
+inline VecType sg_vectorcall(sg_exp_reduce_)(const VecType hi,
+    const VecType lo, VecType& n)
+{
+    typedef typename VecType::elem_t elem_t;
+    typedef SGFloatTraits<elem_t> traits;
+    const VecType xc = hi.constrain(traits::exp_min(), traits::exp_max());
+    n = sg_round_(xc * elem_t(1.44269504088896340736));
+    // If hi was clamped, the result is 0 or infinity, and lo may be large
+    const VecType r = ((xc - n * traits::ln2_hi()) - n * traits::ln2_lo()) +
+        (xc == hi).choose_else_zero(lo);
+    return sg_expm1_kernel_(r, elem_t{});
+}
+
+// atan(x) for x >= 0
+template <typename VecType>
+inline VecType sg_vectorcall(sg_atan_kernel_)(const VecType x, float) {
+    // Cephes atanf(): reduce to |t| <= tan(pi/8)
+    typedef typename VecType::compare_t compare_t;
+    const compare_t big = x > 2.414213562373095f,
+        mid = x > 0.4142135623730950f;
+    const VecType t = big.choose(-1.0f, mid.choose(x - 1.0f, x)) /
+        big.choose(x, mid.choose(x + 1.0f, 1.0f));
+    const VecType offset = big.choose(1.5707963267948966f,
+        mid.choose_else_zero(0.7853981633974483f));
+    static const float c[] = { -3.33329491539e-1f, 1.99777106478e-1f,
+        -1.38776856032e-1f, 8.05374449538e-2f };
+    const VecType z = t * t;
+    return offset + (z * sg_poly_(z, c)).mul_add(t, t);
+}
+template <typename VecType>
+inline VecType sg_vectorcall(sg_atan_kernel_)(const VecType x, double) {
+    // Cephes atan(): reduce to |t| <= 0.66, and evaluate a rational function
+    typedef typename VecType::compare_t compare_t;
+    const compare_t big = x > 2.41421356237309504880,
+        mid = x > 0.66;
+    const VecType t = big.choose(-1.0, mid.choose(x - 1.0, x)) /
+        big.choose(x, mid.choose(x + 1.0, 1.0));
+    // The low bits of pi/2 and pi/4, respectively
+    const VecType offset_lo = big.choose(6.123233995736765886130e-17,
+        mid.choose_else_zero(3.061616997868382943065e-17));
+    const VecType offset = big.choose(1.57079632679489661923,
+        mid.choose_else_zero(0.78539816339744830962));
+    static const double p[] = { -6.485021904942025371773e1,
+        -1.228866684490136173410e2, -7.500855792314704667340e1,
+        -1.615753718733365076637e1, -8.750608600031904122785e-1 };
+    static const double q[] = { 1.945506571482613964425e2,
+        4.853903996359136964868e2, 4.328810604912902668951e2,
+        1.650270098316988542046e2, 2.485846490142306297962e1, 1.0 };
+    const VecType z = t * t;
+    const VecType poly = z * sg_poly_(z, p) / sg_poly_(z, q);
+    return offset + (poly.mul_add(t, t) + offset_lo);
+}
+
+// Splits x > 0 into 2^e * (1 + f), with 1 + f in [sqrt(0.5), sqrt(2)), and
+// returns f, setting e. Denormal x is normalized first
+template <typename VecType>
+inline VecType sg_vectorcall(sg_log_reduce_)(const VecType x, VecType& e) {
+    typedef typename VecType::elem_t elem_t;
+    typedef SGFloatTraits<elem_t> traits;
+    typedef typename SGEquivIntType<VecType>::value int_t;
+    typedef typename int_t::elem_t int_elem_t;
+    const typename VecType::compare_t denormal =
+        x < std::numeric_limits<elem_t>::min();
+    const VecType xn = denormal.choose(
+        x * elem_t(int_elem_t(1) << (traits::mantissa_bits + 1)), x);
+    const int_t bits = xn.template bitcast<int_t>();
+    // Inverse of sg_pow2_int_(): place the biased exponent in the mantissa
+    // bits of exponent_magic()
+    e = (bits.template shift_rl_imm<traits::mantissa_bits>() |
+        VecType{elem_t(int_elem_t(1) << traits::mantissa_bits)}
+            .template bitcast<int_t>()).template bitcast<VecType>() -
+        traits::exponent_magic();
+    e -= denormal.choose_else_zero(elem_t(traits::mantissa_bits + 1));
+    VecType m = ((bits & ((int_elem_t(1) << traits::mantissa_bits) - 1)) |
+        VecType{1.0f}.template bitcast<int_t>()).template bitcast<VecType>();
+    const typename VecType::compare_t big = m > elem_t(1.41421356237309504880);
+    m = big.choose(m * 0.5f, m);
+    e = big.choose(e + 1.0f, e);
+    return m - 1.0f;
+}
+
+// log(1 + f) - f + f^2/2, for f in [sqrt(0.5) - 1, sqrt(2) - 1)
+template <typename VecType>
+inline VecType sg_vectorcall(sg_log_tail_)(const VecType f, float) {
+    // Cephes logf()
+    static const float c[] = { 3.3333331174e-1f, -2.4999993993e-1f,
+        2.0000714765e-1f, -1.6668057665e-1f, 1.4249322787e-1f,
+        -1.2420140846e-1f, 1.1676998740e-1f, -1.1514610310e-1f,
+        7.0376836292e-2f };
+    return f * f * f * sg_poly_(f, c);
+}
+template <typename VecType>
+inline VecType sg_vectorcall(sg_log_tail_)(const VecType f, double) {
+    // fdlibm log(): log(1 + f) = f - f^2/2 + s*(f^2/2 + R(s^2)), where
+    // s = f / (2 + f)
+    static const double c[] = { 6.666666666666735130e-1,
+        3.999999999940941908e-1, 2.857142874366239149e-1,
+        2.222219843214978396e-1, 1.818357216161805012e-1,
+        1.531383769920937332e-1, 1.479819860511658591e-1 };
+    const VecType s = f / (f + 2.0), z = s * s;
+    return s * (z.mul_add(sg_poly_(z, c), f * f * 0.5));
+}
+
+// log(2^e * (1 + f)) for f in [sqrt(0.5) - 1, sqrt(2) - 1)
+template <typename VecType>
+inline VecType sg_vectorcall(sg_log_kernel_)(const VecType f,
+    const VecType e)
+{
+    typedef SGFloatTraits<typename VecType::elem_t> traits;
+    const VecType hfsq = f * f * 0.5f,
+        tail = sg_log_tail_(f, typename VecType::elem_t{});
+    return e.mul_add(traits::ln2_hi(),
+        f - (hfsq - e.mul_add(traits::ln2_lo(), tail)));
+}
+
+// log(x) as hi + lo, for finite x > 0, with more precision than sg_log()
+template <typename VecType>
+inline void sg_vectorcall(sg_log_dw_)(const VecType x, VecType& hi,
+    VecType& lo)
+{
+    typedef SGFloatTraits<typename VecType::elem_t> traits;
+    VecType e;
+    const VecType f = sg_log_reduce_(x, e);
+    VecType f2, f2_err, s1, s1_err, s2, s2_err;
+    sg_two_prod_(f, f, f2, f2_err);
+    // e * ln2_hi() is exact
+    sg_two_sum_(e * traits::ln2_hi(), f, s1, s1_err);
+    sg_two_sum_(s1, f2 * -0.5f, s2, s2_err);
+    const VecType tail = ((s1_err + s2_err) - f2_err * 0.5f) +
+        e.mul_add(traits::ln2_lo(), sg_log_tail_(f,
+            typename VecType::elem_t{}));
+    sg_fast_two_sum_(s2, tail, hi, lo);
+}
+
+// The result of a log function, with special cases: -inf for x = 0, inf for
+// x = inf, and NaN for x < 0
+template <typename VecType>
+inline VecType sg_vectorcall(sg_log_special_)(const VecType x,
+    const VecType result)
+{
+    return (x > 0.0f).choose(
+        (x == VecType::infinity()).choose(x, result),
+        (x == 0.0f).choose(VecType::minus_infinity(), VecType{
+            std::numeric_limits<typename VecType::elem_t>::quiet_NaN()}));
+}
+
+// R(z) such that asin(t) = t + t*R(t^2), for |t| <= 0.5
+template <typename VecType>
+inline VecType sg_vectorcall(sg_asin_kernel_)(const VecType z, float) {
+    // Cephes asinf()
+    static const float c[] = { 1.6666752422e-1f, 7.4953002686e-2f,
+        4.5470025998e-2f, 2.4181311049e-2f, 4.2163199048e-2f };
+    return z * sg_poly_(z, c);
+}
+template <typename VecType>
+inline VecType sg_vectorcall(sg_asin_kernel_)(const VecType z, double) {
+    // fdlibm asin()
+    static const double p[] = { 1.66666666666666657415e-1,
+        -3.25565818622400915405e-1, 2.01212532134862925881e-1,
+        -4.00555345006794114027e-2, 7.91534994289814532176e-4,
+        3.47933107596021167570e-5 };
+    static const double q[] = { 1.0, -2.40339491173441421878,
+        2.02094576023350569471, -6.88283971605453293030e-1,
+        7.70381505559019352791e-2 };
+    return z * sg_poly_(z, p) / sg_poly_(z, q);
+}
+
+// Returns t + t*R(t^2), where t = x for |x| <= 0.5, and
+// t = sqrt((1 - |x|) / 2) otherwise. Sets big to |x| > 0.5
+template <typename VecType>
+inline VecType sg_vectorcall(sg_asin_reduce_)(const VecType x,
+    typename VecType::compare_t& big)
+{
+    const VecType ax = x.abs();
+    big = ax > 0.5f;
+    const VecType z = big.choose((VecType{1.0f} - ax) * 0.5f, x * x);
+    const VecType t = big.choose(z.sqrt(), x);
+    return sg_asin_kernel_(z, typename VecType::elem_t{}).mul_add(t, t);
+}
+
+// -1.0 where the sign bit of x is set, and 1.0 otherwise
+template <typename VecType>
+inline VecType sg_vectorcall(sg_sign_)(const VecType x) {
+    return (x & sg_signbit_mask_<VecType>()) | 1.0f;
+}
+
+// sin(x + y) and cos(x + y) for |x| <= pi/4, where |y| is much smaller than
+// |x| (as with fdlibm's __kernel_sin() and __kernel_cos())
+template <typename VecType>
+inline VecType sg_vectorcall(sg_sin_kernel_)(const VecType x, const VecType y,
+    float)
+{
+    static const float c[] = { 8.3321608736e-3f, -1.9515295891e-4f };
+    const VecType z = x * x, v = z * x;
+    return x - ((z * (y * 0.5f - v * sg_poly_(z, c)) - y) -
+        v * -1.6666654611e-1f);
+}
+template <typename VecType>
+inline VecType sg_vectorcall(sg_sin_kernel_)(const VecType x, const VecType y,
+    double)
+{
+    static const double c[] = { 8.33333333332248946124e-03,
+        -1.98412698298579493134e-04, 2.75573137070700676789e-06,
+        -2.50507602534068634195e-08, 1.58969099521155010221e-10 };
+    const VecType z = x * x, v = z * x;
+    return x - ((z * (y * 0.5 - v * sg_poly_(z, c)) - y) -
+        v * -1.66666666666666324348e-01);
+}
+template <typename VecType>
+inline VecType sg_vectorcall(sg_cos_kernel_)(const VecType x, const VecType y,
+    float)
+{
+    static const float c[] = { 4.166664568298827e-2f, -1.388731625493765e-3f,
+        2.443315711809948e-5f };
+    const VecType z = x * x, hz = z * 0.5f, w = VecType{1.0f} - hz;
+    return w + (((VecType{1.0f} - w) - hz) + (z * z * sg_poly_(z, c) - x * y));
+}
+template <typename VecType>
+inline VecType sg_vectorcall(sg_cos_kernel_)(const VecType x, const VecType y,
+    double)
+{
+    static const double c[] = { 4.16666666666666019037e-02,
+        -1.38888888888741095749e-03, 2.48015872894767294178e-05,
+        -2.75573143513906633035e-07, 2.08757232129817482790e-09,
+        -1.13596475577881948265e-11 };
+    const VecType z = x * x, hz = z * 0.5, w = VecType{1.0} - hz;
+    return w + (((VecType{1.0} - w) - hz) + (z * z * sg_poly_(z, c) - x * y));
+}
+
+//
+//
+//
+//
+//
+//
+//
+// Exponential section
+
+// e^x. Max error approx 1 ulp
+template <typename VecType>
+inline VecType sg_vectorcall(sg_exp)(const VecType x) {
+    VecType n;
+    const VecType p = sg_exp_reduce_(x, n);
+    return sg_scale_pow2_(p + 1.0f, n);
+}
+
+// e^x - 1, accurate for x close to 0. Max error approx 2 ulp
+template <typename VecType>
+inline VecType sg_vectorcall(sg_expm1)(const VecType x) {
+    VecType n;
+    const VecType p = sg_exp_reduce_(x, n);
+    const VecType n_half = sg_round_(n * 0.5f);
+    const VecType scale = sg_pow2_int_(n_half) * sg_pow2_int_(n - n_half);
+    // 2^n * (p + 1) - 1, which is exactly p when n is 0
+    return p.mul_add(scale, scale - 1.0f);
+}
+
+// 2^x. Max error approx 1 ulp
+template <typename VecType>
+inline VecType sg_vectorcall(sg_exp2)(const VecType x) {
+    typedef typename VecType::elem_t elem_t;
+    typedef SGFloatTraits<elem_t> traits;
+    const VecType xc = x.constrain(
+        traits::exp_min() * elem_t(1.44269504088896340736),
+        traits::exp_max() * elem_t(1.44269504088896340736));
+    const VecType n = sg_round_(xc);
+    const VecType p = sg_expm1_kernel_((xc - n) *
+        elem_t(0.693147180559945309417), elem_t{});
+    return sg_scale_pow2_(p + 1.0f, n);
+}
+
+//
+//
+//
+//
+//
+//
+//
+// Logarithm section
+
+// Natural logarithm. Max error approx 1 ulp
+template <typename VecType>
+inline VecType sg_vectorcall(sg_log)(const VecType x) {
+    VecType e;
+    const VecType f = sg_log_reduce_(x, e);
+    return sg_log_special_(x, sg_log_kernel_(f, e));
+}
+
+// Base 2 logarithm. Max error approx 2 ulp
+template <typename VecType>
+inline VecType sg_vectorcall(sg_log2)(const VecType x) {
+    typedef typename VecType::elem_t elem_t;
+    VecType e;
+    const VecType f = sg_log_reduce_(x, e);
+    // The exponent is added exactly, after the fraction is scaled
+    const VecType log_m = sg_log_kernel_(f, VecType{});
+    return sg_log_special_(x,
+        log_m.mul_add(elem_t(1.44269504088896340736), e));
+}
+
+// Base 10 logarithm. Max error approx 2 ulp
+template <typename VecType>
+inline VecType sg_vectorcall(sg_log10)(const VecType x) {
+    typedef typename VecType::elem_t elem_t;
+    return sg_log(x) * elem_t(0.434294481903251827651);
+}
+
+// log(1 + x), accurate for x close to 0. Max error approx 2 ulp
+template <typename VecType>
+inline VecType sg_vectorcall(sg_log1p)(const VecType x) {
+    const VecType u = x + 1.0f;
+    // u - 1 is exact, so this corrects for the rounding error in 1 + x
+    const VecType correction = (u > 0.0f && u < VecType::infinity())
+        .choose_else_zero(((u - 1.0f) - x) / u);
+    return (u == 1.0f).choose(x, sg_log(u) - correction);
+}
+
+//
+//
+//
+//
+//
+//
+//
+// Fast approximation section
+// Lower degree polynomials, and no extra precision. Max relative error approx
+// 1e-5, whatever the element type
+
+// 2^x
+template <typename VecType>
+inline VecType sg_vectorcall(sg_exp2_fast)(const VecType x) {
+    typedef typename VecType::elem_t elem_t;
+    typedef SGFloatTraits<elem_t> traits;
+    static const elem_t c[] = { 1.0000001507568868, 6.931210357981361e-1,
+        2.4021866529739416e-1, 5.5922026011749885e-2,
+        9.685669997030829e-3 };
+    const VecType xc = x.constrain(
+        traits::exp_min() * elem_t(1.44269504088896340736),
+        traits::exp_max() * elem_t(1.44269504088896340736));
+    const VecType n = sg_round_(xc);
+    return sg_scale_pow2_(sg_poly_(xc - n, c), n);
+}
+
+// Base 2 logarithm, with the same special cases as sg_log2()
+template <typename VecType>
+inline VecType sg_vectorcall(sg_log2_fast)(const VecType x) {
+    typedef typename VecType::elem_t elem_t;
+    static const elem_t c[] = { 1.4427030241203733, -7.212234517826147e-1,
+        4.796715996237161e-1, -3.6585755952897464e-1, 3.198222313516715e-1,
+        -2.1151559887442872e-1 };
+    VecType e;
+    const VecType f = sg_log_reduce_(x, e);
+    return sg_log_special_(x, f.mul_add(sg_poly_(f, c), e));
+}
+
+// x^y, for x > 0 only
+template <typename VecType>
+inline VecType sg_vectorcall(sg_pow_fast)(const VecType x, const VecType y) {
+    return sg_exp2_fast(y * sg_log2_fast(x));
+}
+template <typename VecType>
+inline VecType sg_vectorcall(sg_pow_fast)(const VecType x,
+    const typename VecType::elem_t y)
+{
+    return sg_pow_fast(x, VecType{y});
+}
+
+//
+//
+//
+//
+//
+//
+//
+// Power section
+
+// x^y, with the special cases of std::pow(). Max error approx 1 ulp, rising
+// for very large and very small results
+template <typename VecType>
+inline VecType sg_vectorcall(sg_pow)(const VecType x, const VecType y) {
+    typedef SGFloatTraits<typename VecType::elem_t> traits;
+    typedef typename VecType::compare_t compare_t;
+    const VecType ax = x.abs(),
+        yc = y.constrain(-traits::pow_y_max(), traits::pow_y_max());
+    // |x|^y = e^(y * log|x|), with log|x| and the product in extra precision
+    VecType log_hi, log_lo, prod, prod_err, n;
+    sg_log_dw_(ax, log_hi, log_lo);
+    sg_two_prod_(yc, log_hi, prod, prod_err);
+    const VecType p = sg_exp_reduce_(prod, yc.mul_add(log_lo, prod_err), n);
+    VecType result = sg_scale_pow2_(p + 1.0f, n);
+
+    const compare_t ax_inf = ax == VecType::infinity();
+    result = (ax == 0.0f || ax_inf).choose((ax_inf != (y < 0.0f)).choose(
+        VecType::infinity(), VecType{}), result);
+    // Negative x: the result is negative for odd integer y, and NaN for
+    // non-integer y
+    const compare_t y_int = sg_round_any_(y) == y,
+        y_odd = y_int && sg_round_any_(y * 0.5f) != y * 0.5f;
+    result |= y_odd.choose_else_zero(x & sg_signbit_mask_<VecType>());
+    result = (x < 0.0f && !ax_inf && !y_int).choose(VecType{
+        std::numeric_limits<typename VecType::elem_t>::quiet_NaN()}, result);
+    return (y == 0.0f || x == 1.0f).choose(1.0f, result);
+}
+template <typename VecType>
+inline VecType sg_vectorcall(sg_pow)(const VecType x,
+    const typename VecType::elem_t y)
+{
+    return sg_pow(x, VecType{y});
+}
+
+// Cube root. Max error approx 1 ulp
+template <typename VecType>
+inline VecType sg_vectorcall(sg_cbrt)(const VecType x) {
+    typedef typename VecType::elem_t elem_t;
+    const VecType ax = x.abs();
+    VecType e;
+    const VecType m = sg_log_reduce_(ax, e) + 1.0f;
+    // Split e into 3q + rem, with rem in {0, 1, 2}. Adding 0.5 keeps e / 3
+    // away from an integer, so rounding cannot affect the floor
+    const VecType q = ((e + 0.5f) * elem_t(1.0/3.0)).template
+        floor<typename VecType::fast_convert_int_t>().template to<VecType>();
+    const VecType a = m * sg_pow2_int_(e - q * 3.0f);
+    // Initial approximation of cbrt(a) for a in [sqrt(0.5), 4*sqrt(2)), with
+    // max relative error approx 6e-3, followed by 2 iterations of Halley's
+    // method, each of which triples the number of correct bits
+    static const elem_t c[] = { 6.167774158271437e-1, 4.444964533376193e-1,
+        -7.140710577288907e-2, 5.203397447636648e-3 };
+    VecType r = sg_poly_(a, c);
+    for (int32_t i = 0; i < 2; ++i) {
+        const VecType r3 = r * r * r;
+        r *= (r3 + a * 2.0f) / r3.mul_add(2.0f, a);
+    }
+    // Final Newton step, with the residual a - r^3 in extra precision, to
+    // remove the rounding error of the iterations above
+    VecType r2, r2_err, r3, r3_err;
+    sg_two_prod_(r, r, r2, r2_err);
+    sg_two_prod_(r2, r, r3, r3_err);
+    const VecType residual = (a - r3) - r2_err.mul_add(r, r3_err);
+    r = (r * residual / (a * 3.0f)) + r;
+    const VecType result = r * sg_pow2_int_(q);
+    return (ax == 0.0f || ax == VecType::infinity()).choose(ax, result) |
+        (x & sg_signbit_mask_<VecType>());
+}
+
+// sqrt(x^2 + y^2), without overflow or underflow of the intermediate result.
+// Max error approx 1 ulp
+template <typename VecType>
+inline VecType sg_vectorcall(sg_hypot)(const VecType x, const VecType y) {
+    const VecType ax = x.abs(), ay = y.abs(),
+        hi = VecType::max(ax, ay), lo = VecType::min(ax, ay);
+    VecType e;
+    sg_log_reduce_(hi, e);
+    // Scaling by 2^-e is exact, and brings hi close to 1
+    const VecType hs = sg_scale_pow2_(hi, -e), ls = sg_scale_pow2_(lo, -e);
+    const VecType result = sg_scale_pow2_(ls.mul_add(ls, hs * hs).sqrt(), e);
+    return (hi == VecType::infinity()).choose(hi,
+        (hi == 0.0f).choose(VecType{}, result));
+}
+
+//
+//
+//
+//
+//
+//
+//
+// Decibel section
+
+// Converts decibels to a linear gain, 10^(db / 20). Max error approx 1 ulp
+template <typename VecType>
+inline VecType sg_vectorcall(sg_db_to_gain)(const VecType db) {
+    typedef SGFloatTraits<typename VecType::elem_t> traits;
+    VecType prod, prod_err, n;
+    sg_two_prod_(db, VecType{traits::ln10_div_20_hi()}, prod, prod_err);
+    const VecType p = sg_exp_reduce_(prod,
+        db.mul_add(traits::ln10_div_20_lo(), prod_err), n);
+    return sg_scale_pow2_(p + 1.0f, n);
+}
+
+// Converts a linear gain to decibels, 20 * log10(gain). A gain of 0 gives
+// -infinity. Max error approx 1 ulp
+template <typename VecType>
+inline VecType sg_vectorcall(sg_gain_to_db)(const VecType gain) {
+    typedef SGFloatTraits<typename VecType::elem_t> traits;
+    VecType log_hi, log_lo, prod, prod_err;
+    sg_log_dw_(gain, log_hi, log_lo);
+    sg_two_prod_(log_hi, VecType{traits::twenty_div_ln10_hi()}, prod,
+        prod_err);
+    return sg_log_special_(gain, prod + log_lo.mul_add(
+        traits::twenty_div_ln10_hi(),
+        log_hi.mul_add(traits::twenty_div_ln10_lo(), prod_err)));
+}
+
+// As sg_db_to_gain(), with max relative error approx 1e-5
+template <typename VecType>
+inline VecType sg_vectorcall(sg_db_to_gain_fast)(const VecType db) {
+    typedef typename VecType::elem_t elem_t;
+    return sg_exp2_fast(db * elem_t(0.166096404744368117393515971474));
+}
+
+// As sg_gain_to_db(), with max absolute error approx 1e-4 dB
+template <typename VecType>
+inline VecType sg_vectorcall(sg_gain_to_db_fast)(const VecType gain) {
+    typedef typename VecType::elem_t elem_t;
+    return sg_log2_fast(gain) * elem_t(6.02059991327962390427477789449);
+}
+
+//
+//
+//
+//
+//
+//
+//
+// Sigmoid and soft clipping section
+
+// Hyperbolic tangent. Max error approx 3 ulp
+template <typename VecType>
+inline VecType sg_vectorcall(sg_tanh)(const VecType x) {
+    typedef SGFloatTraits<typename VecType::elem_t> traits;
+    // tanh(|x|) = e / (e + 2), where e = e^(2|x|) - 1
+    const VecType e = sg_expm1(VecType::min(x.abs(), traits::tanh_max()) *
+        2.0f);
+    return (e / (e + 2.0f)) | (x & sg_signbit_mask_<VecType>());
+}
+
+// Logistic function 1 / (1 + e^-x), with range (0, 1)
+template <typename VecType>
+inline VecType sg_vectorcall(sg_sigmoid)(const VecType x) {
+    return VecType{1.0f} / (sg_exp(-x) + 1.0f);
+}
+
+// Arctangent, with range [-pi/2, pi/2]. Max error approx 2 ulp
+template <typename VecType>
+inline VecType sg_vectorcall(sg_atan)(const VecType x) {
+    return sg_atan_kernel_(x.abs(), typename VecType::elem_t{}) |
+        (x & sg_signbit_mask_<VecType>());
+}
+
+// (2/pi) * atan((pi/2) * x), with range (-1, 1) and unity gain at 0
+template <typename VecType>
+inline VecType sg_vectorcall(sg_soft_clip_atan)(const VecType x) {
+    typedef typename VecType::elem_t elem_t;
+    return sg_atan(x * elem_t(1.57079632679489661923)) *
+        elem_t(0.63661977236758134308);
+}
+
+// Cubic soft clipper 1.5x - 0.5x^3, with range [-1, 1] and unity gain at 0.
+// Reaches exactly +-1 for |x| >= 1
+template <typename VecType>
+inline VecType sg_vectorcall(sg_soft_clip_poly)(const VecType x) {
+    const VecType xc = x.constrain(-1.0f, 1.0f);
+    return (xc * xc).mul_add(xc * -0.5f, xc * 1.5f);
+}
+
+//
+//
+//
+//
+//
+//
+//
+// Trigonometric section
+
+// sin(pi * x) and cos(pi * x), as with C23 sinpi() and cospi(). The argument
+// reduction is exact, so the error does not grow with |x|. Infinite x gives
+// NaN. Max error approx 1 ulp
+template <typename VecType>
+inline void sg_vectorcall(sg_sincospi)(const VecType x, VecType& s,
+    VecType& c)
+{
+    typedef typename VecType::elem_t elem_t;
+    typedef typename SGEquivIntType<VecType>::value::elem_t int_elem_t;
+    // Above 2^(mantissa_bits + 1), every float is an even integer
+    const VecType x_even = elem_t(
+        int_elem_t(2) << SGFloatTraits<elem_t>::mantissa_bits);
+    const VecType xr = (x.abs() < x_even).choose(x,
+        x & sg_signbit_mask_<VecType>());
+    // x = n/2 + r, with |r| <= 1/4, exactly
+    const VecType n = sg_round_any_(xr * 2.0f), r = xr - n * 0.5f;
+    // Quadrant q = n mod 4, in [-2, 2]
+    const VecType q = n - sg_round_any_(n * 0.25f) * 4.0f;
+    // pi * r as hi + lo
+    typedef SGFloatTraits<elem_t> traits;
+    VecType hi, lo;
+    sg_two_prod_(r, VecType{traits::pi_hi()}, hi, lo);
+    lo = r.mul_add(traits::pi_lo(), lo);
+    const VecType sin_r = sg_sin_kernel_(hi, lo, elem_t{}),
+        cos_r = sg_cos_kernel_(hi, lo, elem_t{});
+    const typename VecType::compare_t odd = (q == 1.0f) || (q == -1.0f);
+    const VecType s_mag = odd.choose(cos_r, sin_r),
+        c_mag = odd.choose(sin_r, cos_r);
+    // sin is negated for q = -1 and q = +-2, and cos for q = 1 and q = +-2
+    const VecType s_sign = ((q < 0.0f) || (q == 2.0f)).choose_else_zero(
+        sg_signbit_mask_<VecType>()), c_sign = ((q == 1.0f) ||
+        (q.abs() == 2.0f)).choose_else_zero(sg_signbit_mask_<VecType>());
+    // A zero sin(pi * x) has the sign of x, as with C23 sinpi()
+    const VecType s_result = s_mag ^ s_sign;
+    const typename VecType::compare_t finite = x.abs() < VecType::infinity();
+    s = finite.choose((s_result == 0.0f).choose(
+        x & sg_signbit_mask_<VecType>(), s_result), x - x);
+    // + 0 so that cos(pi * (n + 1/2)) is +0, as with C23 cospi()
+    c = finite.choose((c_mag ^ c_sign) + 0.0f, x - x);
+}
+
+// sin(pi * x). Max error approx 1 ulp
+template <typename VecType>
+inline VecType sg_vectorcall(sg_sinpi)(const VecType x) {
+    VecType s, c;
+    sg_sincospi(x, s, c);
+    return s;
+}
+
+// cos(pi * x). Max error approx 1 ulp
+template <typename VecType>
+inline VecType sg_vectorcall(sg_cospi)(const VecType x) {
+    VecType s, c;
+    sg_sincospi(x, s, c);
+    return c;
+}
+
+//
+//
+//
+//
+//
+//
+//
+// Inverse trigonometric section
+
+// Arcsine, with range [-pi/2, pi/2]. Max error approx 2 ulp
+template <typename VecType>
+inline VecType sg_vectorcall(sg_asin)(const VecType x) {
+    typedef typename VecType::elem_t elem_t;
+    typename VecType::compare_t big;
+    const VecType p = sg_asin_reduce_(x, big);
+    // asin(x) = pi/2 - 2*asin(sqrt((1 - x) / 2)) for x > 0.5
+    const VecType big_result = VecType{elem_t(1.57079632679489655800)} -
+        (p * 2.0f - elem_t(6.12323399573676603587e-17));
+    return big.choose(big_result | (x & sg_signbit_mask_<VecType>()), p);
+}
+
+// Arccosine, with range [0, pi]. Max error approx 2 ulp
+template <typename VecType>
+inline VecType sg_vectorcall(sg_acos)(const VecType x) {
+    typedef typename VecType::elem_t elem_t;
+    typename VecType::compare_t big;
+    const VecType p = sg_asin_reduce_(x, big);
+    // acos(x) = 2*asin(sqrt((1 - x) / 2)) for x > 0.5, and
+    // pi - 2*asin(sqrt((1 + x) / 2)) for x < -0.5
+    const VecType big_result = (x < 0.0f).choose(
+        VecType{elem_t(3.14159265358979311600)} -
+            (p * 2.0f - elem_t(1.22464679914735317720e-16)),
+        p * 2.0f);
+    return big.choose(big_result, VecType{elem_t(1.57079632679489655800)} -
+        (p - elem_t(6.12323399573676603587e-17)));
+}
+
+// Angle of the point (x, y) from the positive x axis, with range [-pi, pi].
+// The sign of zero is taken into account as with std::atan2().
+// Max error approx 3 ulp
+template <typename VecType>
+inline VecType sg_vectorcall(sg_atan2)(const VecType y, const VecType x) {
+    typedef typename VecType::elem_t elem_t;
+    typedef typename VecType::compare_t compare_t;
+    const VecType ax = x.abs(), ay = y.abs(),
+        lo = VecType::min(ax, ay), hi = VecType::max(ax, ay);
+    // lo / hi is in [0, 1]. Both zero gives 0, and both infinite gives 1
+    const VecType ratio = (lo == VecType::infinity()).choose(1.0f,
+        (hi == 0.0f).choose(VecType{}, lo / hi));
+    const VecType a = sg_atan_kernel_(ratio, elem_t{});
+    const compare_t swap = ay > ax, x_neg = sg_sign_(x) < 0.0f;
+    // Reflect about pi/4 if |y| > |x|, and about pi/2 if x is negative
+    const VecType b = swap.choose(
+        VecType{elem_t(1.57079632679489661923)} - a, a);
+    const VecType c = x_neg.choose(
+        VecType{elem_t(3.14159265358979323846)} - b, b);
+    return c | (y & sg_signbit_mask_<VecType>());
+}
+
+//
+//
+//
+//
+//
+//
+//
+// Hyperbolic section
+
+// Hyperbolic sine. Max error approx 3 ulp
+template <typename VecType>
+inline VecType sg_vectorcall(sg_sinh)(const VecType x) {
+    const VecType ax = x.abs();
+    VecType n;
+    const VecType p = sg_exp_reduce_(ax, n);
+    // e^|x| / 2, which does not overflow unless sinh(x) does
+    const VecType half_e = sg_scale_pow2_(p + 1.0f, n - 1.0f);
+    // Small |x|: with em = e^|x| - 1, sinh(|x|) = (em + em / (em + 1)) / 2
+    const VecType scale = sg_pow2_int_(VecType::min(n, 1.0f)),
+        em = p.mul_add(scale, scale - 1.0f);
+    const VecType small_result = (em + em / (em + 1.0f)) * 0.5f;
+    return (ax < 1.0f).choose(small_result, half_e - 0.25f / half_e) |
+        (x & sg_signbit_mask_<VecType>());
+}
+
+// Hyperbolic cosine. Max error approx 2 ulp
+template <typename VecType>
+inline VecType sg_vectorcall(sg_cosh)(const VecType x) {
+    VecType n;
+    const VecType p = sg_exp_reduce_(x.abs(), n);
+    const VecType half_e = sg_scale_pow2_(p + 1.0f, n - 1.0f);
+    return half_e + 0.25f / half_e;
+}
+
+// Inverse hyperbolic sine. Max error approx 2 ulp
+template <typename VecType>
+inline VecType sg_vectorcall(sg_asinh)(const VecType x) {
+    typedef typename VecType::elem_t elem_t;
+    typedef SGFloatTraits<elem_t> traits;
+    const VecType ax = x.abs(), axc = VecType::min(ax, traits::asinh_large());
+    // asinh(x) = log1p(x + x^2 / (1 + sqrt(1 + x^2))) for x >= 0
+    const VecType x2 = axc * axc;
+    const VecType small_result = sg_log1p(axc + x2 / ((x2 + 1.0f).sqrt() +
+        1.0f));
+    // asinh(x) = log(2x) for large x
+    const VecType large_result = sg_log(ax) + elem_t(0.693147180559945309417);
+    return (ax < traits::asinh_large()).choose(small_result, large_result) |
+        (x & sg_signbit_mask_<VecType>());
+}
+
+} // namespace simd_granodi
+
+#endif // SIMD_GRANODI_MATH_H
@@ -0,0 +1,641 @@
+#ifndef SIMD_GRANODI_MEMORY_H
+#define SIMD_GRANODI_MEMORY_H
+
+/*
+
+SIMD GRANODI MEMORY
+
+Copyright (c) 2021-2022 Jon Ville
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+/*
+
+Containers and memory utilities for blocks of the C++ vector classes in
+simd_granodi.h, for use in real-time code. Nothing here allocates memory
+after construction.
+
+- SGSpscRing: wait-free single-producer, single-consumer ring buffer, for
+  passing blocks between a real-time thread and another thread
+- SGSoa: structure of arrays of 32-bit fields, padded to whole Vec_ps /
+  Vec_pi32 groups, with compaction and conversion to and from arrays of
+  structs
+- SGArena, SGArenaScope: bump-pointer arena for per-block scratch buffers
+- sg_bitset_count(), sg_bitset_find_next(), sg_bitset_for_each(): scanning
+  bitsets stored as arrays of uint32_t, 128 bits at a time
+
+*/
+
+#include "simd_granodi.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace simd_granodi {
+
+//
+//
+//
+//
+//
+//
+//
+// Ring buffer section
+
+// Wait-free ring buffer of T (eg Vec_ps), for exactly one producer thread and
+// one consumer thread. The capacity is rounded up to a power of two.
+// The head and tail indices are on separate cache lines, and each thread keeps
+// a cached copy of the other thread's index, so that the other thread's cache
+// line is only read when the cached copy shows too little free space (or too
+// few readable elements).
+//
+// Elements can be copied in and out in batches with push() and pop(), or
+// accessed in place: write_span() gives the contiguous free space, which is
+// published with commit_write(), and read_span() gives the contiguous
+// readable elements, which are released with commit_read().
+template <typename T>
+class SGSpscRing {
+    // An index, and the owning thread's copy of the other thread's index,
+    // padded to be on a cache line of their own
+    struct Index {
+        char pad_before[64];
+        std::atomic<std::size_t> value;
+        std::size_t cached_other;
+        char pad_after[64];
+    };
+
+    std::vector<T> buf_;
+    std::size_t mask_;
+    Index head_, tail_; // Written by the producer and consumer respectively
+
+    static std::size_t ring_size(const std::size_t min_size) {
+        std::size_t size = 1;
+        while (size < min_size) size *= 2;
+        return size;
+    }
+
+public:
+    explicit SGSpscRing(const std::size_t capacity)
+        : buf_(ring_size(capacity)), mask_{buf_.size() - 1}
+    {
+        head_.value.store(0); head_.cached_other = 0;
+        tail_.value.store(0); tail_.cached_other = 0;
+    }
+
+    SGSpscRing(const SGSpscRing&) = delete;
+    SGSpscRing& operator=(const SGSpscRing&) = delete;
+
+    std::size_t capacity() const { return buf_.size(); }
+
+    // Producer thread only
+
+    // Free space, only reading the consumer's index if the cached copy shows
+    // less than wanted
+    std::size_t write_available(const std::size_t wanted = SIZE_MAX) {
+        const std::size_t head = head_.value.load(std::memory_order_relaxed);
+        if (buf_.size() - (head - head_.cached_other) < wanted) {
+            head_.cached_other = tail_.value.load(std::memory_order_acquire);
+        }
+        return buf_.size() - (head - head_.cached_other);
+    }
+
+    // Contiguous free space. count is set to the number of elements that can
+    // be written before calling commit_write(). This may be less than
+    // write_available() when the free space wraps around the end
+    T *write_span(std::size_t& count) {
+        const std::size_t head = head_.value.load(std::memory_order_relaxed);
+        count = std::min(write_available(),
+            buf_.size() - (head & mask_));
+        return buf_.data() + (head & mask_);
+    }
+
+    // Publishes n elements written through write_span()
+    void commit_write(const std::size_t n) {
+        head_.value.store(head_.value.load(std::memory_order_relaxed) + n,
+            std::memory_order_release);
+    }
+
+    // Copies in up to n elements, and publishes them together. Returns the
+    // number copied, which is less than n if the ring is too full
+    std::size_t push(const T *const data, const std::size_t n) {
+        const std::size_t head = head_.value.load(std::memory_order_relaxed);
+        const std::size_t count = std::min(n, write_available(n)),
+            first = std::min(count, buf_.size() - (head & mask_));
+        std::copy(data, data + first, buf_.data() + (head & mask_));
+        std::copy(data + first, data + count, buf_.data());
+        commit_write(count);
+        return count;
+    }
+
+    // Consumer thread only
+
+    // Readable elements, only reading the producer's index if the cached copy
+    // shows less than wanted
+    std::size_t read_available(const std::size_t wanted = SIZE_MAX) {
+        const std::size_t tail = tail_.value.load(std::memory_order_relaxed);
+        if (tail_.cached_other - tail < wanted) {
+            tail_.cached_other = head_.value.load(std::memory_order_acquire);
+        }
+        return tail_.cached_other - tail;
+    }
+
+    // Contiguous readable elements, as with write_span()
+    const T *read_span(std::size_t& count) {
+        const std::size_t tail = tail_.value.load(std::memory_order_relaxed);
+        count = std::min(read_available(), buf_.size() - (tail & mask_));
+        return buf_.data() + (tail & mask_);
+    }
+
+    // Releases n elements read through read_span()
+    void commit_read(const std::size_t n) {
+        tail_.value.store(tail_.value.load(std::memory_order_relaxed) + n,
+            std::memory_order_release);
+    }
+
+    // Copies out up to n elements. Returns the number copied
+    std::size_t pop(T *const data, const std::size_t n) {
+        const std::size_t tail = tail_.value.load(std::memory_order_relaxed);
+        const std::size_t count = std::min(n, read_available(n)),
+            first = std::min(count, buf_.size() - (tail & mask_));
+        std::copy(buf_.data() + (tail & mask_),
+            buf_.data() + (tail & mask_) + first, data);
+        std::copy(buf_.data(), buf_.data() + (count - first), data + first);
+        commit_read(count);
+        return count;
+    }
+};
+
+//
+//
+//
+//
+//
+//
+//
+// Arena section
+
+// Bump-pointer arena for scratch buffers that only live for one block (eg of
+// an audio callback). The memory is allocated once on construction.
+// Allocations are aligned to 64 bytes (a cache line, and wider than any
+// vector type), and are freed all at once, either by reset() at the start of
+// each block, or by an SGArenaScope going out of scope.
+//
+// alloc() returns nullptr if there is not enough room, and sets overflowed(),
+// which stays set until clear_overflowed(). peak() gives the most bytes ever
+// used, for sizing the arena. In debug builds (NDEBUG not defined), alloc()
+// also asserts that there was enough room, and each allocation is followed
+// by a guard cache line of check bytes, so that writes past the end of an
+// allocation are found by guards_intact(). The guards are included in used()
+// and peak(), so size the arena from a release build
+class SGArena {
+    static constexpr unsigned char guard_byte_ = 0xa5;
+
+    std::vector<unsigned char> storage_;
+    unsigned char *base_;
+    std::size_t capacity_, used_, peak_;
+    bool overflowed_;
+    #ifndef NDEBUG
+    std::vector<std::size_t> guards_; // Offsets, sized on construction
+    std::size_t guard_count_;
+    #endif
+
+public:
+    static constexpr std::size_t alignment = 64;
+
+    static std::size_t round_up(const std::size_t bytes) {
+        return (bytes + alignment - 1) & ~(alignment - 1);
+    }
+
+    // max_allocations is only used in debug builds, and is the number of
+    // live allocations whose guards are checked
+    explicit SGArena(const std::size_t capacity,
+        const std::size_t max_allocations = 64)
+        : storage_(round_up(capacity) + alignment),
+        capacity_{round_up(capacity)}, used_{0}, peak_{0}, overflowed_{false}
+        #ifndef NDEBUG
+        , guards_(max_allocations), guard_count_{0}
+        #endif
+    {
+        (void) max_allocations;
+        // Round the start of the memory up to the alignment. The storage has
+        // one extra alignment of bytes for this
+        const std::size_t misalign = reinterpret_cast<std::uintptr_t>(
+            storage_.data()) & (alignment - 1);
+        base_ = storage_.data() + (misalign ? alignment - misalign : 0);
+    }
+
+    SGArena(const SGArena&) = delete;
+    SGArena& operator=(const SGArena&) = delete;
+
+    std::size_t capacity() const { return capacity_; }
+    std::size_t used() const { return used_; }
+    std::size_t peak() const { return peak_; }
+    bool overflowed() const { return overflowed_; }
+    void clear_overflowed() { overflowed_ = false; }
+
+    // Space for n default-constructed T. T must not need destroying, as the
+    // arena never calls destructors
+    template <typename T>
+    T *alloc(const std::size_t n) {
+        static_assert(std::is_trivially_destructible<T>::value,
+            "SGArena cannot destroy objects");
+        static_assert(alignof(T) <= alignment, "T is over-aligned");
+        std::size_t bytes = round_up(n*sizeof(T));
+        #ifndef NDEBUG
+        bytes += alignment;
+        #endif
+        if (n > capacity_/sizeof(T) || bytes > capacity_ - used_) {
+            overflowed_ = true;
+            assert(false && "SGArena overflowed");
+            return nullptr;
+        }
+        T *const result = reinterpret_cast<T*>(base_ + used_);
+        for (std::size_t i = 0; i < n; ++i) new (result + i) T;
+        #ifndef NDEBUG
+        // The guard fills from the end of the objects to the end of the
+        // allocation
+        std::memset(base_ + used_ + n*sizeof(T), guard_byte_,
+            bytes - n*sizeof(T));
+        if (guard_count_ < guards_.size()) {
+            guards_[guard_count_++] = used_ + n*sizeof(T);
+        }
+        #endif
+        used_ += bytes;
+        peak_ = std::max(peak_, used_);
+        return result;
+    }
+
+    // Frees everything allocated after mark() returned m
+    std::size_t mark() const { return used_; }
+    void release(const std::size_t m) {
+        used_ = m;
+        #ifndef NDEBUG
+        while (guard_count_ > 0 && guards_[guard_count_ - 1] >= m) {
+            --guard_count_;
+        }
+        #endif
+    }
+
+    // Frees everything
+    void reset() { release(0); }
+
+    // Whether all live allocations were written inside their bounds. Always
+    // true in release builds
+    bool guards_intact() const {
+        #ifndef NDEBUG
+        for (std::size_t g = 0; g < guard_count_; ++g) {
+            const std::size_t end = round_up(guards_[g]) + alignment;
+            for (std::size_t i = guards_[g]; i < end; ++i) {
+                if (base_[i] != guard_byte_) return false;
+            }
+        }
+        #endif
+        return true;
+    }
+};
+
+// Frees everything allocated from arena during its lifetime
+class SGArenaScope {
+    SGArena& arena_;
+    const std::size_t mark_;
+
+public:
+    explicit SGArenaScope(SGArena& arena)
+        : arena_(arena), mark_{arena.mark()} {}
+    ~SGArenaScope() { arena_.release(mark_); }
+
+    SGArenaScope(const SGArenaScope&) = delete;
+    SGArenaScope& operator=(const SGArenaScope&) = delete;
+};
+
+//
+//
+//
+//
+//
+//
+//
+// Structure of arrays section
+
+// Checks that every field of an SGSoa is 4 bytes and has a vector type
+template <typename... Fields>
+struct SGSoaFieldsCheck_ { static constexpr bool value = true; };
+template <typename Field, typename... Fields>
+struct SGSoaFieldsCheck_<Field, Fields...> {
+    static constexpr bool value = sizeof(Field) == 4 &&
+        (std::is_same<Field, float>::value ||
+            std::is_same<Field, int32_t>::value) &&
+        SGSoaFieldsCheck_<Fields...>::value;
+};
+
+// Structure of arrays, with one array per field. Each field is float or
+// int32_t, and the arrays are padded to a whole number of groups of 4
+// elements, so that group g of field I can be loaded as a Vec_ps or Vec_pi32
+// with load<I>(g). Lanes past size() in the last group hold unspecified
+// values of the right type. The capacity is fixed on construction.
+//
+// Elements are removed either one at a time with swap_remove(), which does
+// not keep the order, or in bulk with compact(), which keeps the order and
+// uses Vec_pi32::compress() on each group. Arrays of structs with the same
+// layout as the fields (eg struct { float x, y, z; int32_t id; }) are
+// converted with assign_aos() and copy_to_aos(), which transpose 4 elements
+// and 4 fields at a time.
+template <typename... Fields>
+class SGSoa {
+    static_assert(sizeof...(Fields) > 0, "SGSoa needs at least one field");
+    static_assert(SGSoaFieldsCheck_<Fields...>::value,
+        "SGSoa fields must be float or int32_t");
+
+    std::vector<Vec_pi32> data_; // [field][group]
+    std::vector<int32_t> masks_; // Used by compact()
+    std::size_t group_capacity_, size_;
+
+    // Element i of field f. All fields are copied as 4-byte bit patterns
+    char *element_(const std::size_t f, const std::size_t i) {
+        return reinterpret_cast<char*>(data_.data() + f*group_capacity_) +
+            4*i;
+    }
+    const char *element_(const std::size_t f, const std::size_t i) const {
+        return reinterpret_cast<const char*>(
+            data_.data() + f*group_capacity_) + 4*i;
+    }
+
+public:
+    static constexpr std::size_t field_count = sizeof...(Fields);
+
+    template <std::size_t I>
+    using field_t = typename std::tuple_element<I, std::tuple<Fields...>>::type;
+    template <std::size_t I>
+    using vec_t = typename SGType<field_t<I>, 4>::value;
+
+    explicit SGSoa(const std::size_t capacity)
+        : data_(field_count*((capacity + 3)/4)), masks_((capacity + 3)/4),
+        group_capacity_{(capacity + 3)/4}, size_{0} {}
+
+    std::size_t capacity() const { return 4*group_capacity_; }
+    std::size_t size() const { return size_; }
+    std::size_t group_count() const { return (size_ + 3)/4; }
+    void clear() { size_ = 0; }
+
+    // Group g (elements 4*g to 4*g + 3) of field I
+    template <std::size_t I>
+    vec_t<I> load(const std::size_t g) const {
+        return data_[I*group_capacity_ + g].template bitcast<vec_t<I>>();
+    }
+    template <std::size_t I>
+    void store(const std::size_t g, const vec_t<I>& v) {
+        data_[I*group_capacity_ + g] = v.template bitcast<Vec_pi32>();
+    }
+
+    // Single elements
+    template <std::size_t I>
+    field_t<I> get(const std::size_t i) const {
+        field_t<I> result;
+        std::memcpy(&result, element_(I, i), 4);
+        return result;
+    }
+    template <std::size_t I>
+    void set(const std::size_t i, const field_t<I> value) {
+        std::memcpy(element_(I, i), &value, 4);
+    }
+
+    // Returns false if full
+    bool push_back(const Fields... values) {
+        if (size_ == capacity()) return false;
+        std::size_t f = 0;
+        const int expand[] = {
+            (std::memcpy(element_(f++, size_), &values, 4), 0)... };
+        (void) expand;
+        ++size_;
+        return true;
+    }
+
+    // Moves the last element into element i
+    void swap_remove(const std::size_t i) {
+        --size_;
+        if (i == size_) return;
+        for (std::size_t f = 0; f < field_count; ++f) {
+            std::memcpy(element_(f, i), element_(f, size_), 4);
+        }
+    }
+
+    // Keeps the elements for which keep(g) is true, in order. keep() takes a
+    // group index and returns a Compare_pi32 or Compare_ps, and is called
+    // once per group before anything is moved. Returns the new size
+    template <typename KeepFn>
+    std::size_t compact(KeepFn keep) {
+        const std::size_t groups = group_count();
+        std::size_t new_size = 0;
+        for (std::size_t g = 0; g < groups; ++g) {
+            int32_t mask = keep(g).movemask();
+            if (4*g + 4 > size_) mask &= (1 << (size_ - 4*g)) - 1;
+            masks_[g] = mask;
+            new_size += (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) +
+                ((mask >> 3) & 1);
+        }
+        for (std::size_t f = 0; f < field_count; ++f) {
+            // The write position never passes the start of the group being
+            // read, so a whole group can be stored there
+            std::size_t w = 0;
+            for (std::size_t g = 0; g < groups; ++g) {
+                const int32_t mask = masks_[g];
+                const Vec_pi32 kept = data_[f*group_capacity_ + g].compress(
+                    Compare_pi32{(mask & 8) != 0, (mask & 4) != 0,
+                        (mask & 2) != 0, (mask & 1) != 0});
+                int32_t lanes[4];
+                kept.storeu(lanes);
+                std::memcpy(element_(f, w), lanes, 16);
+                w += (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) +
+                    ((mask >> 3) & 1);
+            }
+        }
+        size_ = new_size;
+        return size_;
+    }
+
+    // Replaces the contents with n structs, which must be laid out as the
+    // fields in order (4 bytes each, no padding). n is limited to capacity()
+    template <typename Struct>
+    void assign_aos(const Struct *const rows, const std::size_t n) {
+        static_assert(sizeof(Struct) == 4*field_count,
+            "struct layout must match the SGSoa fields");
+        size_ = std::min(n, capacity());
+        const char *const bytes = reinterpret_cast<const char*>(rows);
+        const std::size_t whole_groups = size_/4;
+        std::size_t f = 0;
+        for (; f + 4 <= field_count; f += 4) {
+            for (std::size_t g = 0; g < whole_groups; ++g) {
+                Vec_pi32 r[4];
+                for (std::size_t k = 0; k < 4; ++k) {
+                    int32_t row[4];
+                    std::memcpy(row, bytes + sizeof(Struct)*(4*g + k) + 4*f,
+                        16);
+                    r[k] = Vec_pi32::loadu(row);
+                }
+                Vec_pi32::transpose(r[0], r[1], r[2], r[3]);
+                for (std::size_t k = 0; k < 4; ++k) {
+                    data_[(f + k)*group_capacity_ + g] = r[k];
+                }
+            }
+        }
+        for (std::size_t i = 0; i < size_; ++i) {
+            for (std::size_t f2 = i < 4*whole_groups ? f : 0;
+                f2 < field_count; ++f2)
+            {
+                std::memcpy(element_(f2, i),
+                    bytes + sizeof(Struct)*i + 4*f2, 4);
+            }
+        }
+    }
+
+    // Copies the size() elements out to structs laid out as in assign_aos()
+    template <typename Struct>
+    void copy_to_aos(Struct *const rows) const {
+        static_assert(sizeof(Struct) == 4*field_count,
+            "struct layout must match the SGSoa fields");
+        char *const bytes = reinterpret_cast<char*>(rows);
+        const std::size_t whole_groups = size_/4;
+        std::size_t f = 0;
+        for (; f + 4 <= field_count; f += 4) {
+            for (std::size_t g = 0; g < whole_groups; ++g) {
+                Vec_pi32 r[4];
+                for (std::size_t k = 0; k < 4; ++k) {
+                    r[k] = data_[(f + k)*group_capacity_ + g];
+                }
+                Vec_pi32::transpose(r[0], r[1], r[2], r[3]);
+                for (std::size_t k = 0; k < 4; ++k) {
+                    int32_t row[4];
+                    r[k].storeu(row);
+                    std::memcpy(bytes + sizeof(Struct)*(4*g + k) + 4*f, row,
+                        16);
+                }
+            }
+        }
+        for (std::size_t i = 0; i < size_; ++i) {
+            for (std::size_t f2 = i < 4*whole_groups ? f : 0;
+                f2 < field_count; ++f2)
+            {
+                std::memcpy(bytes + sizeof(Struct)*i + 4*f2,
+                    element_(f2, i), 4);
+            }
+        }
+    }
+};
+
+//
+//
+//
+//
+//
+//
+//
+// Bitset section
+// Bit i of a bitset is bit (i % 32) of words[i / 32]
+
+// Loads 4 words as a Vec_pi32 (signed and unsigned types may alias)
+inline Vec_pi32 sg_vectorcall(sg_bitset_load_)(const uint32_t *const words) {
+    return Vec_pi32::loadu(reinterpret_cast<const int32_t*>(words));
+}
+
+// Number of set bits
+inline std::size_t sg_bitset_count(const uint32_t *const words,
+    const std::size_t word_count)
+{
+    // Each element of the sum grows by at most 32 per group, so the sum is
+    // moved to total every 2^22 groups, before reduce_add() can overflow
+    std::size_t total = 0, i = 0;
+    while (i + 4 <= word_count) {
+        const std::size_t end = i + std::min<std::size_t>(
+            (word_count - i) & ~std::size_t(3), std::size_t(1) << 24);
+        Vec_pi32 sum;
+        for (; i < end; i += 4) sum += sg_bitset_load_(words + i).popcount();
+        total += static_cast<uint32_t>(sum.reduce_add());
+    }
+    for (; i < word_count; ++i) {
+        total += static_cast<std::size_t>(Vec_s32x1{
+            static_cast<int32_t>(words[i])}.popcount().data());
+    }
+    return total;
+}
+
+// Index of the first set bit at or after bit start, or SIZE_MAX if there is
+// none. Groups of 4 empty words are skipped with one comparison
+inline std::size_t sg_bitset_find_next(const uint32_t *const words,
+    const std::size_t word_count, const std::size_t start)
+{
+    std::size_t w = start / 32;
+    if (w >= word_count) return SIZE_MAX;
+    // The first word, with the bits below start cleared
+    const uint32_t first = words[w] & (~uint32_t(0) << (start % 32));
+    if (first != 0) {
+        return 32*w + static_cast<std::size_t>(Vec_s32x1{
+            static_cast<int32_t>(first)}.ctz().data());
+    }
+    ++w;
+    for (; w + 4 <= word_count; w += 4) {
+        const int32_t nonzero = (sg_bitset_load_(words + w) != 0).movemask();
+        if (nonzero != 0) {
+            w += static_cast<std::size_t>(Vec_s32x1{nonzero}.ctz().data());
+            break;
+        }
+    }
+    for (; w < word_count; ++w) {
+        if (words[w] != 0) {
+            return 32*w + static_cast<std::size_t>(Vec_s32x1{
+                static_cast<int32_t>(words[w])}.ctz().data());
+        }
+    }
+    return SIZE_MAX;
+}
+
+// Calls f(i) for each set bit i, in increasing order
+template <typename Function>
+inline void sg_bitset_for_each(const uint32_t *const words,
+    const std::size_t word_count, Function f)
+{
+    const auto for_each_in_word = [&f](const std::size_t w, uint32_t word) {
+        while (word != 0) {
+            f(32*w + static_cast<std::size_t>(Vec_s32x1{
+                static_cast<int32_t>(word)}.ctz().data()));
+            word &= word - 1; // Clears the lowest set bit
+        }
+    };
+    std::size_t w = 0;
+    for (; w + 4 <= word_count; w += 4) {
+        int32_t nonzero = (sg_bitset_load_(words + w) != 0).movemask();
+        while (nonzero != 0) {
+            const std::size_t k = static_cast<std::size_t>(
+                Vec_s32x1{nonzero}.ctz().data());
+            for_each_in_word(w + k, words[w + k]);
+            nonzero &= nonzero - 1;
+        }
+    }
+    for (; w < word_count; ++w) for_each_in_word(w, words[w]);
+}
+
+} // namespace simd_granodi
+
+#endif // SIMD_GRANODI_MEMORY_H
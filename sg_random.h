@@ -0,0 +1,286 @@
+#ifndef SIMD_GRANODI_RANDOM_H
+#define SIMD_GRANODI_RANDOM_H
+
+/*
+
+SIMD GRANODI RANDOM
+
+Copyright (c) 2021-2022 Jon Ville
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+*/
+
+/*
+
+Pseudo-random number generators, written in terms of the C++ classes in
+simd_granodi.h. Not suitable for cryptography.
+
+Each generator has a next_pi32() method, returning a Vec_pi32 of 32 random
+bits per element. Each element comes from a separate stream, so the four
+elements are independent. The free functions sg_random_unit(),
+sg_random_bipolar() and sg_random_gaussian() turn these into floats, for any
+of the generators.
+
+- SGXorshift128Plus: fastest, with 128 bits of state per stream
+- SGPcg32: PCG32 (XSH RR), matching the reference implementation. Slower on
+  SSE2 and NEON, where 64-bit multiplication is non-vector
+- SGPhilox4x32: counter-based Philox4x32-10. Any point in the sequence can be
+  reached in constant time with seek(), and sg_philox4x32_10() can be used
+  directly as a hash of the counter
+
+*/
+
+#include "sg_math.h"
+
+namespace simd_granodi {
+
+//
+//
+//
+//
+//
+//
+//
+// Helper section
+// Functions ending in an underscore are implementation details, and may
+// change or be removed
+
+// SplitMix64, for expanding a seed into generator states
+inline uint64_t sg_splitmix64_(uint64_t& x) {
+    uint64_t z = (x += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+// Packs the low 32 bits of each element of lo and hi into a Vec_pi32, in the
+// order lo.l0, hi.l0, lo.l1, hi.l1
+inline Vec_pi32 sg_vectorcall(sg_interleave_lo32_)(const Vec_pi64 lo,
+    const Vec_pi64 hi)
+{
+    return ((lo & Vec_pi64{0xffffffff}) | hi.shift_l_imm<32>())
+        .bitcast<Vec_pi32>();
+}
+
+//
+//
+//
+//
+//
+//
+//
+// Generator section
+
+// xorshift128+ (Vigna, with shifts 23, 18, 5). The high 32 bits of each 64-bit
+// output are used, as the low bits are weaker
+class SGXorshift128Plus {
+    // Streams 0 and 2 in a, streams 1 and 3 in b
+    Vec_pi64 a0_, a1_, b0_, b1_;
+
+    static Vec_pi64 sg_vectorcall(step)(Vec_pi64& s0, Vec_pi64& s1) {
+        Vec_pi64 x = s0;
+        const Vec_pi64 y = s1, result = x + y;
+        s0 = y;
+        x ^= x.shift_l_imm<23>();
+        s1 = x ^ y ^ x.shift_rl_imm<18>() ^ y.shift_rl_imm<5>();
+        return result;
+    }
+
+public:
+    explicit SGXorshift128Plus(uint64_t seed = 0) {
+        // Stream i has state s[i][0], s[i][1]
+        uint64_t s[4][2];
+        for (int32_t i = 0; i < 4; ++i) {
+            s[i][0] = sg_splitmix64_(seed);
+            s[i][1] = sg_splitmix64_(seed);
+        }
+        a0_ = Vec_pi64::bitcast_from_u64(s[2][0], s[0][0]);
+        a1_ = Vec_pi64::bitcast_from_u64(s[2][1], s[0][1]);
+        b0_ = Vec_pi64::bitcast_from_u64(s[3][0], s[1][0]);
+        b1_ = Vec_pi64::bitcast_from_u64(s[3][1], s[1][1]);
+    }
+
+    Vec_pi32 sg_vectorcall(next_pi32)() {
+        const Vec_pi64 a = step(a0_, a1_), b = step(b0_, b1_);
+        return sg_interleave_lo32_(a.shift_rl_imm<32>(), b.shift_rl_imm<32>());
+    }
+};
+
+// PCG32 (O'Neill, "PCG: A Family of Simple Fast Space-Efficient Statistically
+// Good Algorithms for Random Number Generation"), with the XSH RR output
+// function. Element i gives the same sequence as pcg32_srandom_r(seed,
+// 4*stream + i) in the reference implementation
+class SGPcg32 {
+    // Streams 0 and 2 in a, streams 1 and 3 in b
+    Vec_pi64 state_a_, state_b_, inc_a_, inc_b_;
+
+    static constexpr uint64_t multiplier = 6364136223846793005u;
+
+    static Vec_pi64 sg_vectorcall(step)(Vec_pi64& state, const Vec_pi64 inc) {
+        const Vec_pi64 old = state;
+        state = old * Vec_pi64::bitcast_from_u64(multiplier) + inc;
+        const Vec_pi64 xorshifted = (old.shift_rl_imm<18>() ^ old)
+            .shift_rl_imm<27>() & Vec_pi64{0xffffffff};
+        // Rotate right, by shifting two copies side by side
+        return (xorshifted | xorshifted.shift_l_imm<32>())
+            .shift_rl(old.shift_rl_imm<59>());
+    }
+
+public:
+    explicit SGPcg32(const uint64_t seed = 0, const uint64_t stream = 0) {
+        uint64_t state[4], inc[4];
+        for (int32_t i = 0; i < 4; ++i) {
+            // pcg32_srandom_r()
+            inc[i] = ((4*stream + i) << 1) | 1u;
+            state[i] = inc[i];
+            state[i] += seed;
+            state[i] = state[i] * multiplier + inc[i];
+        }
+        state_a_ = Vec_pi64::bitcast_from_u64(state[2], state[0]);
+        state_b_ = Vec_pi64::bitcast_from_u64(state[3], state[1]);
+        inc_a_ = Vec_pi64::bitcast_from_u64(inc[2], inc[0]);
+        inc_b_ = Vec_pi64::bitcast_from_u64(inc[3], inc[1]);
+    }
+
+    Vec_pi32 sg_vectorcall(next_pi32)() {
+        const Vec_pi64 a = step(state_a_, inc_a_), b = step(state_b_, inc_b_);
+        return sg_interleave_lo32_(a, b);
+    }
+};
+
+// Philox4x32-10 (Salmon et al, "Parallel Random Numbers: As Easy as 1, 2, 3"),
+// on four blocks at once. Element i of c0, c1, c2, c3 is the 128-bit counter
+// of block i, and element i of k0, k1 its 64-bit key. The counter is replaced
+// by the 128-bit output
+inline void sg_philox4x32_10(Vec_pi32& c0, Vec_pi32& c1, Vec_pi32& c2,
+    Vec_pi32& c3, Vec_pi32 k0, Vec_pi32 k1)
+{
+    const Vec_pi32 m0 = Vec_pi32::bitcast_from_u32(0xd2511f53),
+        m1 = Vec_pi32::bitcast_from_u32(0xcd9e8d57),
+        w0 = Vec_pi32::bitcast_from_u32(0x9e3779b9),
+        w1 = Vec_pi32::bitcast_from_u32(0xbb67ae85);
+    for (int32_t round = 0; round < 10; ++round) {
+        if (round > 0) { k0 += w0; k1 += w1; }
+        const Vec_pi32 hi0 = c0.mulhi_unsigned(m0), lo0 = c0 * m0,
+            hi1 = c2.mulhi_unsigned(m1), lo1 = c2 * m1;
+        c0 = hi1 ^ c1 ^ k0;
+        c1 = lo1;
+        c2 = hi0 ^ c3 ^ k1;
+        c3 = lo0;
+    }
+}
+
+// Block n has the counter (n, stream), with n in the low 64 bits, and the
+// seed as its key. Element i of the output comes from blocks 4*j + i, so the
+// four elements are independent streams
+class SGPhilox4x32 {
+    Vec_pi32 out_[4];
+    uint64_t seed_, stream_, block_;
+    int32_t index_;
+
+    void refill() {
+        const uint64_t n[4] = { block_, block_ + 1, block_ + 2, block_ + 3 };
+        Vec_pi32 c0 = Vec_pi32::bitcast_from_u32(uint32_t(n[3]),
+            uint32_t(n[2]), uint32_t(n[1]), uint32_t(n[0]));
+        Vec_pi32 c1 = Vec_pi32::bitcast_from_u32(uint32_t(n[3] >> 32),
+            uint32_t(n[2] >> 32), uint32_t(n[1] >> 32), uint32_t(n[0] >> 32));
+        Vec_pi32 c2 = Vec_pi32::bitcast_from_u32(uint32_t(stream_));
+        Vec_pi32 c3 = Vec_pi32::bitcast_from_u32(uint32_t(stream_ >> 32));
+        sg_philox4x32_10(c0, c1, c2, c3,
+            Vec_pi32::bitcast_from_u32(uint32_t(seed_)),
+            Vec_pi32::bitcast_from_u32(uint32_t(seed_ >> 32)));
+        out_[0] = c0; out_[1] = c1; out_[2] = c2; out_[3] = c3;
+        block_ += 4;
+        index_ = 0;
+    }
+
+public:
+    explicit SGPhilox4x32(const uint64_t seed = 0, const uint64_t stream = 0)
+        : seed_{seed}, stream_{stream}, block_{0}, index_{4} {}
+
+    // Moves to block n (a multiple of 4), so that the next 4 calls to
+    // next_pi32() give the output of blocks n to n + 3
+    void seek(const uint64_t n) { block_ = n; index_ = 4; }
+
+    Vec_pi32 sg_vectorcall(next_pi32)() {
+        if (index_ == 4) refill();
+        return out_[index_++];
+    }
+};
+
+//
+//
+//
+//
+//
+//
+//
+// Distribution section
+
+// Converts 32 random bits per element to a float in [0, 1), by placing the
+// top 23 bits in the mantissa of a float in [1, 2)
+inline Vec_ps sg_vectorcall(sg_bits_to_unit_ps)(const Vec_pi32 bits) {
+    return (bits.shift_rl_imm<9>() | 0x3f800000).bitcast<Vec_ps>() - 1.0f;
+}
+
+// As above, for a float in [-1, 1), using a float in [2, 4)
+inline Vec_ps sg_vectorcall(sg_bits_to_bipolar_ps)(const Vec_pi32 bits) {
+    return (bits.shift_rl_imm<9>() | 0x40000000).bitcast<Vec_ps>() - 3.0f;
+}
+
+// Uniform in [0, 1)
+template <typename Generator>
+inline Vec_ps sg_vectorcall(sg_random_unit)(Generator& gen) {
+    return sg_bits_to_unit_ps(gen.next_pi32());
+}
+
+// Uniform in [-1, 1)
+template <typename Generator>
+inline Vec_ps sg_vectorcall(sg_random_bipolar)(Generator& gen) {
+    return sg_bits_to_bipolar_ps(gen.next_pi32());
+}
+
+// Two vectors of independent normally distributed values, with mean 0 and
+// variance 1, by the Box-Muller transform. |z| is at most approx 5.6
+template <typename Generator>
+inline void sg_vectorcall(sg_random_gaussian_pair)(Generator& gen, Vec_ps& z0,
+    Vec_ps& z1)
+{
+    // u1 is in (0, 1], so that log(u1) is finite
+    const Vec_ps u1 = Vec_ps{1.0f} - sg_random_unit(gen),
+        u2 = sg_random_unit(gen);
+    const Vec_ps radius = (sg_log(u1) * -2.0f).sqrt();
+    Vec_ps s, c;
+    sg_sincospi(u2 * 2.0f, s, c);
+    z0 = radius * c;
+    z1 = radius * s;
+}
+
+// As above, for a single vector. Half as fast per value
+template <typename Generator>
+inline Vec_ps sg_vectorcall(sg_random_gaussian)(Generator& gen) {
+    Vec_ps z0, z1;
+    sg_random_gaussian_pair(gen, z0, z1);
+    return z0;
+}
+
+} // namespace simd_granodi
+
+#endif // SIMD_GRANODI_RANDOM_H
@@ -55,6 +55,10 @@ operators.
 
 Avoid UB (obey strict aliasing rules & use memcpy where necessary). No unions
 
+Generic (and scalar wrapper) integer addition, subtraction, negation,
+multiplication and left shifts wrap as two's complement, computed using unsigned
+arithmetic, to match SSE2 / NEON
+
 Generic, SSE, and NEON definitions grouped per section for comparison, education,
 documentation, reference etc
 
@@ -99,19 +103,25 @@ sg_cmpgt_pi64
 sg_abs_pi64
 sg_min_pi64
 sg_max_pi64
+sg_reduce_min_pi64
+sg_reduce_max_pi64
 
 SSE2 in vector registers, but slower:
 - sg_sl_pi32, sg_sl_pi64, sg_srl_pi32, sg_srl_pi64, sg_sra_pi32, shift one
   element at a time
 - sg_mul_pi32 combines two _mm_mul_epu32 (unsigned mul) with a lot of other ops
+- sg_compress_pi32, sg_compress_ps switch between 16 shuffles
 
 Non-vector on NEON:
 sg_srl_pi32
 sg_srl_pi64
 sg_sra_pi32
+sg_reduce_min_pi64
+sg_reduce_max_pi64
 
 Non-vector on SSE2 and NEON:
 sg_mul_pi64
+sg_mulhi_pi64
 sg_div_pi32
 sg_div_pi64
 sg_safediv_pi32
@@ -327,7 +337,7 @@ static inline sg_pi32 sg_vectorcall(sg_choose_pi32)(const sg_cmp_pi32,
 // Load and store section
 
 static inline sg_generic_pi32 sg_vectorcall(sg_load_generic_pi32)(
-    int32_t *const i)
+    const int32_t *const i)
 {
     sg_generic_pi32 result;
     memcpy(&result, i, sizeof(sg_generic_pi32));
@@ -337,7 +347,7 @@ static inline sg_generic_pi32 sg_vectorcall(sg_load_generic_pi32)(
     sizeof(sg_generic_pi32))
 
 static inline sg_generic_pi64 sg_vectorcall(sg_load_generic_pi64)(
-    int64_t *const l)
+    const int64_t *const l)
 {
     sg_generic_pi64 result;
     memcpy(&result, l, sizeof(sg_generic_pi64));
@@ -347,7 +357,7 @@ static inline sg_generic_pi64 sg_vectorcall(sg_load_generic_pi64)(
     sizeof(sg_generic_pi64))
 
 static inline sg_generic_ps sg_vectorcall(sg_load_generic_ps)(
-    float *const f)
+    const float *const f)
 {
     sg_generic_ps result;
     memcpy(&result, f, sizeof(sg_generic_ps));
@@ -357,7 +367,7 @@ static inline sg_generic_ps sg_vectorcall(sg_load_generic_ps)(
     sizeof(sg_generic_ps))
 
 static inline sg_generic_pd sg_vectorcall(sg_load_generic_pd)(
-    double *const d)
+    const double *const d)
 {
     sg_generic_pd result;
     memcpy(&result, d, sizeof(sg_generic_pd));
@@ -367,7 +377,7 @@ static inline sg_generic_pd sg_vectorcall(sg_load_generic_pd)(
     sizeof(sg_generic_pd))
 
 static inline sg_generic_s32x2 sg_vectorcall(sg_load_generic_s32x2)(
-    int32_t *const i)
+    const int32_t *const i)
 {
     sg_generic_s32x2 result;
     memcpy(&result, i, sizeof(sg_generic_s32x2));
@@ -377,7 +387,7 @@ static inline sg_generic_s32x2 sg_vectorcall(sg_load_generic_s32x2)(
     sizeof(sg_generic_s32x2))
 
 static inline sg_generic_f32x2 sg_vectorcall(sg_load_generic_f32x2)(
-    float *const f)
+    const float *const f)
 {
     sg_generic_f32x2 result;
     memcpy(&result, f, sizeof(sg_generic_f32x2));
@@ -408,10 +418,10 @@ static inline sg_generic_f32x2 sg_vectorcall(sg_load_generic_f32x2)(
 #elif defined SIMD_GRANODI_SSE2
 // This would be UB, but the intel spec specifically says that any
 // implementation must allow vec pointers to alias some non-vec pointers
-#define sg_loadu_pi32(i) _mm_loadu_si128((__m128i *) (i))
-#define sg_load_pi32(i) _mm_load_si128((__m128i *) (i))
-#define sg_loadu_pi64(l) _mm_loadu_si128((__m128i *) (l))
-#define sg_load_pi64(l) _mm_load_si128((__m128i *) (l))
+#define sg_loadu_pi32(i) _mm_loadu_si128((const __m128i *) (i))
+#define sg_load_pi32(i) _mm_load_si128((const __m128i *) (i))
+#define sg_loadu_pi64(l) _mm_loadu_si128((const __m128i *) (l))
+#define sg_load_pi64(l) _mm_load_si128((const __m128i *) (l))
 #define sg_loadu_ps _mm_loadu_ps
 #define sg_load_ps _mm_load_ps
 #define sg_loadu_pd _mm_loadu_pd
@@ -3832,19 +3842,49 @@ static inline sg_generic_s32x2 sg_vectorcall(sg_cvtf_generic_f32x2_s32x2)(
 //
 // Add section
 
+// Signed overflow is UB, so integer addition and subtraction wrap using
+// unsigned arithmetic
+static inline int32_t sg_vectorcall(sg_add_wrap_s32x1_)(const int32_t a,
+    const int32_t b)
+{
+    return sg_bitcast_u32x1_s32x1(sg_bitcast_s32x1_u32x1(a) +
+        sg_bitcast_s32x1_u32x1(b));
+}
+static inline int64_t sg_vectorcall(sg_add_wrap_s64x1_)(const int64_t a,
+    const int64_t b)
+{
+    return sg_bitcast_u64x1_s64x1(sg_bitcast_s64x1_u64x1(a) +
+        sg_bitcast_s64x1_u64x1(b));
+}
+static inline int32_t sg_vectorcall(sg_sub_wrap_s32x1_)(const int32_t a,
+    const int32_t b)
+{
+    return sg_bitcast_u32x1_s32x1(sg_bitcast_s32x1_u32x1(a) -
+        sg_bitcast_s32x1_u32x1(b));
+}
+static inline int64_t sg_vectorcall(sg_sub_wrap_s64x1_)(const int64_t a,
+    const int64_t b)
+{
+    return sg_bitcast_u64x1_s64x1(sg_bitcast_s64x1_u64x1(a) -
+        sg_bitcast_s64x1_u64x1(b));
+}
+
 static inline sg_generic_pi32 sg_vectorcall(sg_add_generic_pi32)(
     const sg_generic_pi32 a, const sg_generic_pi32 b)
 {
     sg_generic_pi32 result;
-    result.i0 = a.i0 + b.i0; result.i1 = a.i1 + b.i1;
-    result.i2 = a.i2 + b.i2; result.i3 = a.i3 + b.i3;
+    result.i0 = sg_add_wrap_s32x1_(a.i0, b.i0);
+    result.i1 = sg_add_wrap_s32x1_(a.i1, b.i1);
+    result.i2 = sg_add_wrap_s32x1_(a.i2, b.i2);
+    result.i3 = sg_add_wrap_s32x1_(a.i3, b.i3);
     return result;
 }
 static inline sg_generic_pi64 sg_vectorcall(sg_add_generic_pi64)(
     const sg_generic_pi64 a, const sg_generic_pi64 b)
 {
     sg_generic_pi64 result;
-    result.l0 = a.l0 + b.l0; result.l1 = a.l1 + b.l1;
+    result.l0 = sg_add_wrap_s64x1_(a.l0, b.l0);
+    result.l1 = sg_add_wrap_s64x1_(a.l1, b.l1);
     return result;
 }
 static inline sg_generic_ps sg_vectorcall(sg_add_generic_ps)(
@@ -3866,7 +3906,8 @@ static inline sg_generic_s32x2 sg_vectorcall(sg_add_generic_s32x2)(
     const sg_generic_s32x2 a, const sg_generic_s32x2 b)
 {
     sg_generic_s32x2 result;
-    result.i0 = a.i0 + b.i0; result.i1 = a.i1 + b.i1;
+    result.i0 = sg_add_wrap_s32x1_(a.i0, b.i0);
+    result.i1 = sg_add_wrap_s32x1_(a.i1, b.i1);
     return result;
 }
 static inline sg_generic_f32x2 sg_vectorcall(sg_add_generic_f32x2)(
@@ -3916,15 +3957,18 @@ static inline sg_generic_pi32 sg_vectorcall(sg_sub_generic_pi32)(
     const sg_generic_pi32 a, const sg_generic_pi32 b)
 {
     sg_generic_pi32 result;
-    result.i0 = a.i0 - b.i0; result.i1 = a.i1 - b.i1;
-    result.i2 = a.i2 - b.i2; result.i3 = a.i3 - b.i3;
+    result.i0 = sg_sub_wrap_s32x1_(a.i0, b.i0);
+    result.i1 = sg_sub_wrap_s32x1_(a.i1, b.i1);
+    result.i2 = sg_sub_wrap_s32x1_(a.i2, b.i2);
+    result.i3 = sg_sub_wrap_s32x1_(a.i3, b.i3);
     return result;
 }
 static inline sg_generic_pi64 sg_vectorcall(sg_sub_generic_pi64)(
     const sg_generic_pi64 a, const sg_generic_pi64 b)
 {
     sg_generic_pi64 result;
-    result.l0 = a.l0 - b.l0; result.l1 = a.l1 - b.l1;
+    result.l0 = sg_sub_wrap_s64x1_(a.l0, b.l0);
+    result.l1 = sg_sub_wrap_s64x1_(a.l1, b.l1);
     return result;
 }
 static inline sg_generic_ps sg_vectorcall(sg_sub_generic_ps)(
@@ -3946,7 +3990,8 @@ static inline sg_generic_s32x2 sg_vectorcall(sg_sub_generic_s32x2)(
     const sg_generic_s32x2 a, const sg_generic_s32x2 b)
 {
     sg_generic_s32x2 result;
-    result.i0 = a.i0 - b.i0; result.i1 = a.i1 - b.i1;
+    result.i0 = sg_sub_wrap_s32x1_(a.i0, b.i0);
+    result.i1 = sg_sub_wrap_s32x1_(a.i1, b.i1);
     return result;
 }
 static inline sg_generic_f32x2 sg_vectorcall(sg_sub_generic_f32x2)(
@@ -3992,19 +4037,37 @@ static inline sg_generic_f32x2 sg_vectorcall(sg_sub_generic_f32x2)(
 //
 // Multiply section
 
+// As with addition, integer multiplication keeps the low bits, wrapping
+// using unsigned arithmetic
+static inline int32_t sg_vectorcall(sg_mul_wrap_s32x1_)(const int32_t a,
+    const int32_t b)
+{
+    return sg_bitcast_u32x1_s32x1(sg_bitcast_s32x1_u32x1(a) *
+        sg_bitcast_s32x1_u32x1(b));
+}
+static inline int64_t sg_vectorcall(sg_mul_wrap_s64x1_)(const int64_t a,
+    const int64_t b)
+{
+    return sg_bitcast_u64x1_s64x1(sg_bitcast_s64x1_u64x1(a) *
+        sg_bitcast_s64x1_u64x1(b));
+}
+
 static inline sg_generic_pi32 sg_vectorcall(sg_mul_generic_pi32)(
     const sg_generic_pi32 a, const sg_generic_pi32 b)
 {
     sg_generic_pi32 result;
-    result.i0 = a.i0 * b.i0; result.i1 = a.i1 * b.i1;
-    result.i2 = a.i2 * b.i2; result.i3 = a.i3 * b.i3;
+    result.i0 = sg_mul_wrap_s32x1_(a.i0, b.i0);
+    result.i1 = sg_mul_wrap_s32x1_(a.i1, b.i1);
+    result.i2 = sg_mul_wrap_s32x1_(a.i2, b.i2);
+    result.i3 = sg_mul_wrap_s32x1_(a.i3, b.i3);
     return result;
 }
 static inline sg_generic_pi64 sg_vectorcall(sg_mul_generic_pi64)(
     const sg_generic_pi64 a, const sg_generic_pi64 b)
 {
     sg_generic_pi64 result;
-    result.l0 = a.l0 * b.l0; result.l1 = a.l1 * b.l1;
+    result.l0 = sg_mul_wrap_s64x1_(a.l0, b.l0);
+    result.l1 = sg_mul_wrap_s64x1_(a.l1, b.l1);
     return result;
 }
 static inline sg_generic_ps sg_vectorcall(sg_mul_generic_ps)(
@@ -4026,7 +4089,8 @@ static inline sg_generic_s32x2 sg_vectorcall(sg_mul_generic_s32x2)(
     const sg_generic_s32x2 a, const sg_generic_s32x2 b)
 {
     sg_generic_s32x2 result;
-    result.i0 = a.i0 * b.i0; result.i1 = a.i1 * b.i1;
+    result.i0 = sg_mul_wrap_s32x1_(a.i0, b.i0);
+    result.i1 = sg_mul_wrap_s32x1_(a.i1, b.i1);
     return result;
 }
 static inline sg_generic_f32x2 sg_vectorcall(sg_mul_generic_f32x2)(
@@ -4180,6 +4244,56 @@ static inline sg_generic_f32x2 sg_vectorcall(sg_div_generic_f32x2)(
 #define sg_div_f32x2 sg_div_generic_f32x2
 #endif
 
+//
+//
+//
+//
+//
+//
+//
+// Square root section
+
+static inline sg_generic_ps sg_vectorcall(sg_sqrt_generic_ps)(
+    const sg_generic_ps a)
+{
+    sg_generic_ps result;
+    result.f0 = sqrtf(a.f0); result.f1 = sqrtf(a.f1);
+    result.f2 = sqrtf(a.f2); result.f3 = sqrtf(a.f3);
+    return result;
+}
+static inline sg_generic_pd sg_vectorcall(sg_sqrt_generic_pd)(
+    const sg_generic_pd a)
+{
+    sg_generic_pd result;
+    result.d0 = sqrt(a.d0); result.d1 = sqrt(a.d1);
+    return result;
+}
+static inline sg_generic_f32x2 sg_vectorcall(sg_sqrt_generic_f32x2)(
+    const sg_generic_f32x2 a)
+{
+    sg_generic_f32x2 result;
+    result.f0 = sqrtf(a.f0); result.f1 = sqrtf(a.f1);
+    return result;
+}
+
+#ifdef SIMD_GRANODI_FORCE_GENERIC
+#define sg_sqrt_ps sg_sqrt_generic_ps
+#define sg_sqrt_pd sg_sqrt_generic_pd
+
+#elif defined SIMD_GRANODI_SSE2
+#define sg_sqrt_ps _mm_sqrt_ps
+#define sg_sqrt_pd _mm_sqrt_pd
+
+#elif defined SIMD_GRANODI_NEON
+#define sg_sqrt_ps vsqrtq_f32
+#define sg_sqrt_pd vsqrtq_f64
+#define sg_sqrt_f32x2 vsqrt_f32
+#endif
+
+#if defined SIMD_GRANODI_FORCE_GENERIC || defined SIMD_GRANODI_SSE2
+#define sg_sqrt_f32x2 sg_sqrt_generic_f32x2
+#endif
+
 //
 //
 // FMA section
@@ -4606,28 +4720,43 @@ static inline sg_generic_s32x2 sg_vectorcall(sg_xor_generic_s32x2)(
 //
 // Shift left by register section
 
+// Left shifts of negative values, or into the sign bit, are UB, so shift
+// the unsigned equivalent
+static inline int32_t sg_vectorcall(sg_sl_wrap_s32x1_)(const int32_t a,
+    const int32_t shift)
+{
+    return sg_bitcast_u32x1_s32x1(sg_bitcast_s32x1_u32x1(a) << shift);
+}
+static inline int64_t sg_vectorcall(sg_sl_wrap_s64x1_)(const int64_t a,
+    const int64_t shift)
+{
+    return sg_bitcast_u64x1_s64x1(sg_bitcast_s64x1_u64x1(a) << shift);
+}
+
 static inline sg_generic_pi32 sg_vectorcall(sg_sl_generic_pi32)(
     const sg_generic_pi32 a, const sg_generic_pi32 shift)
 {
     sg_generic_pi32 result;
-    result.i0 = a.i0 << shift.i0; result.i1 = a.i1 << shift.i1;
-    result.i2 = a.i2 << shift.i2; result.i3 = a.i3 << shift.i3;
+    result.i0 = sg_sl_wrap_s32x1_(a.i0, shift.i0);
+    result.i1 = sg_sl_wrap_s32x1_(a.i1, shift.i1);
+    result.i2 = sg_sl_wrap_s32x1_(a.i2, shift.i2);
+    result.i3 = sg_sl_wrap_s32x1_(a.i3, shift.i3);
     return result;
 }
 static inline sg_generic_pi64 sg_vectorcall(sg_sl_generic_pi64)(
     const sg_generic_pi64 a, const sg_generic_pi64 shift)
 {
     sg_generic_pi64 result;
-    result.l0 = a.l0 << shift.l0;
-    result.l1 = a.l1 << shift.l1;
+    result.l0 = sg_sl_wrap_s64x1_(a.l0, shift.l0);
+    result.l1 = sg_sl_wrap_s64x1_(a.l1, shift.l1);
     return result;
 }
 static inline sg_generic_s32x2 sg_vectorcall(sg_sl_generic_s32x2)(
     const sg_generic_s32x2 a, const sg_generic_s32x2 shift)
 {
     sg_generic_s32x2 result;
-    result.i0 = a.i0 << shift.i0;
-    result.i1 = a.i1 << shift.i1;
+    result.i0 = sg_sl_wrap_s32x1_(a.i0, shift.i0);
+    result.i1 = sg_sl_wrap_s32x1_(a.i1, shift.i1);
     return result;
 }
 
@@ -4686,23 +4815,26 @@ static inline sg_generic_pi32 sg_vectorcall(sg_sl_imm_generic_pi32)(
     const sg_generic_pi32 a, const int32_t shift)
 {
     sg_generic_pi32 result;
-    result.i0 = a.i0 << shift; result.i1 = a.i1 << shift;
-    result.i2 = a.i2 << shift; result.i3 = a.i3 << shift;
+    result.i0 = sg_sl_wrap_s32x1_(a.i0, shift);
+    result.i1 = sg_sl_wrap_s32x1_(a.i1, shift);
+    result.i2 = sg_sl_wrap_s32x1_(a.i2, shift);
+    result.i3 = sg_sl_wrap_s32x1_(a.i3, shift);
     return result;
 }
 static inline sg_generic_pi64 sg_vectorcall(sg_sl_imm_generic_pi64)(
     const sg_generic_pi64 a, const int32_t shift)
 {
     sg_generic_pi64 result;
-    result.l0 = a.l0 << (int64_t) shift;
-    result.l1 = a.l1 << (int64_t) shift;
+    result.l0 = sg_sl_wrap_s64x1_(a.l0, shift);
+    result.l1 = sg_sl_wrap_s64x1_(a.l1, shift);
     return result;
 }
 static inline sg_generic_s32x2 sg_vectorcall(sg_sl_imm_generic_s32x2)(
     const sg_generic_s32x2 a, const int32_t shift)
 {
     sg_generic_s32x2 result;
-    result.i0 = a.i0 << shift; result.i1 = a.i1 << shift;
+    result.i0 = sg_sl_wrap_s32x1_(a.i0, shift);
+    result.i1 = sg_sl_wrap_s32x1_(a.i1, shift);
     return result;
 }
 
@@ -6904,15 +7036,18 @@ static inline sg_generic_pi32 sg_vectorcall(sg_neg_generic_pi32)(
     const sg_generic_pi32 a)
 {
     sg_generic_pi32 result;
-    result.i0 = -a.i0; result.i1 = -a.i1;
-    result.i2 = -a.i2; result.i3 = -a.i3;
+    result.i0 = sg_sub_wrap_s32x1_(0, a.i0);
+    result.i1 = sg_sub_wrap_s32x1_(0, a.i1);
+    result.i2 = sg_sub_wrap_s32x1_(0, a.i2);
+    result.i3 = sg_sub_wrap_s32x1_(0, a.i3);
     return result;
 }
 static inline sg_generic_pi64 sg_vectorcall(sg_neg_generic_pi64)(
     const sg_generic_pi64 a)
 {
     sg_generic_pi64 result;
-    result.l0 = -a.l0; result.l1 = -a.l1;
+    result.l0 = sg_sub_wrap_s64x1_(0, a.l0);
+    result.l1 = sg_sub_wrap_s64x1_(0, a.l1);
     return result;
 }
 static inline sg_generic_ps sg_vectorcall(sg_neg_generic_ps)(
@@ -6934,7 +7069,8 @@ static inline sg_generic_s32x2 sg_vectorcall(sg_neg_generic_s32x2)(
     const sg_generic_s32x2 a)
 {
     sg_generic_s32x2 result;
-    result.i0 = -a.i0; result.i1 = -a.i1;
+    result.i0 = sg_sub_wrap_s32x1_(0, a.i0);
+    result.i1 = sg_sub_wrap_s32x1_(0, a.i1);
     return result;
 }
 static inline sg_generic_f32x2 sg_vectorcall(sg_neg_generic_f32x2)(
@@ -7275,103 +7411,2134 @@ static inline sg_pi64 sg_vectorcall(sg_max_pi64)(const sg_pi64 a,
 #define sg_constrain_s32x2(lowerb, upperb, a) sg_min_s32x2(sg_max_s32x2(lowerb, a), upperb)
 #define sg_constrain_f32x2(lowerb, upperb, a) sg_min_f32x2(sg_max_f32x2(lowerb, a), upperb)
 
-#ifdef __cplusplus
+//
+//
+//
+//
+//
+//
+//
+// Horizontal reduction section
+// Sum, min or max of all the elements of a vector, as a scalar.
+// The order of floating point additions differs between implementations, so
+// the last bit of the result may differ
 
-namespace simd_granodi {
+#define sg_min_scalar_(a, b) ((a) < (b) ? (a) : (b))
+#define sg_max_scalar_(a, b) ((a) > (b) ? (a) : (b))
 
-// C++ classes for operator overloading:
-// - Have no setters, but can be changed via += etc (semi-immutable)
-// - Are default constructed to zero
-// - All type casts or type conversions must be explicit
-// - Should never use any SSE2 or NEON types or intrinsics directly
+static inline int32_t sg_vectorcall(sg_reduce_add_generic_pi32)(
+    const sg_generic_pi32 a)
+{
+    return sg_add_wrap_s32x1_(sg_add_wrap_s32x1_(a.i0, a.i2),
+        sg_add_wrap_s32x1_(a.i1, a.i3));
+}
+static inline int64_t sg_vectorcall(sg_reduce_add_generic_pi64)(
+    const sg_generic_pi64 a)
+{
+    return sg_add_wrap_s64x1_(a.l0, a.l1);
+}
+static inline float sg_vectorcall(sg_reduce_add_generic_ps)(
+    const sg_generic_ps a)
+{
+    return (a.f0 + a.f2) + (a.f1 + a.f3);
+}
+static inline double sg_vectorcall(sg_reduce_add_generic_pd)(
+    const sg_generic_pd a)
+{
+    return a.d0 + a.d1;
+}
+static inline int32_t sg_vectorcall(sg_reduce_add_generic_s32x2)(
+    const sg_generic_s32x2 a)
+{
+    return sg_add_wrap_s32x1_(a.i0, a.i1);
+}
+static inline float sg_vectorcall(sg_reduce_add_generic_f32x2)(
+    const sg_generic_f32x2 a)
+{
+    return a.f0 + a.f1;
+}
 
-class Compare_pi32; class Compare_pi64; class Compare_ps; class Compare_pd;
-class Compare_s32x2; class Compare_f32x2;
-class Vec_pi32; class Vec_pi64; class Vec_ps; class Vec_pd;
-class Vec_s32x2; class Vec_f32x2;
+static inline int32_t sg_vectorcall(sg_reduce_min_generic_pi32)(
+    const sg_generic_pi32 a)
+{
+    return sg_min_scalar_(sg_min_scalar_(a.i0, a.i2),
+        sg_min_scalar_(a.i1, a.i3));
+}
+static inline int64_t sg_vectorcall(sg_reduce_min_generic_pi64)(
+    const sg_generic_pi64 a)
+{
+    return sg_min_scalar_(a.l0, a.l1);
+}
+static inline float sg_vectorcall(sg_reduce_min_generic_ps)(
+    const sg_generic_ps a)
+{
+    return sg_min_scalar_(sg_min_scalar_(a.f0, a.f2),
+        sg_min_scalar_(a.f1, a.f3));
+}
+static inline double sg_vectorcall(sg_reduce_min_generic_pd)(
+    const sg_generic_pd a)
+{
+    return sg_min_scalar_(a.d0, a.d1);
+}
+static inline int32_t sg_vectorcall(sg_reduce_min_generic_s32x2)(
+    const sg_generic_s32x2 a)
+{
+    return sg_min_scalar_(a.i0, a.i1);
+}
+static inline float sg_vectorcall(sg_reduce_min_generic_f32x2)(
+    const sg_generic_f32x2 a)
+{
+    return sg_min_scalar_(a.f0, a.f1);
+}
 
-// Shim types - for using double / float etc in template code that expects
-// a vector type
-class Vec_s32x1; class Vec_s64x1; class Vec_f32x1; class Vec_f64x1;
+static inline int32_t sg_vectorcall(sg_reduce_max_generic_pi32)(
+    const sg_generic_pi32 a)
+{
+    return sg_max_scalar_(sg_max_scalar_(a.i0, a.i2),
+        sg_max_scalar_(a.i1, a.i3));
+}
+static inline int64_t sg_vectorcall(sg_reduce_max_generic_pi64)(
+    const sg_generic_pi64 a)
+{
+    return sg_max_scalar_(a.l0, a.l1);
+}
+static inline float sg_vectorcall(sg_reduce_max_generic_ps)(
+    const sg_generic_ps a)
+{
+    return sg_max_scalar_(sg_max_scalar_(a.f0, a.f2),
+        sg_max_scalar_(a.f1, a.f3));
+}
+static inline double sg_vectorcall(sg_reduce_max_generic_pd)(
+    const sg_generic_pd a)
+{
+    return sg_max_scalar_(a.d0, a.d1);
+}
+static inline int32_t sg_vectorcall(sg_reduce_max_generic_s32x2)(
+    const sg_generic_s32x2 a)
+{
+    return sg_max_scalar_(a.i0, a.i1);
+}
+static inline float sg_vectorcall(sg_reduce_max_generic_f32x2)(
+    const sg_generic_f32x2 a)
+{
+    return sg_max_scalar_(a.f0, a.f1);
+}
 
-template <typename From, typename To>
-inline To sg_vectorcall(sg_convert)(const From x) = delete;
+#ifdef SIMD_GRANODI_FORCE_GENERIC
+#define sg_reduce_add_pi32 sg_reduce_add_generic_pi32
+#define sg_reduce_add_pi64 sg_reduce_add_generic_pi64
+#define sg_reduce_add_ps sg_reduce_add_generic_ps
+#define sg_reduce_add_pd sg_reduce_add_generic_pd
+#define sg_reduce_min_pi32 sg_reduce_min_generic_pi32
+#define sg_reduce_min_pi64 sg_reduce_min_generic_pi64
+#define sg_reduce_min_ps sg_reduce_min_generic_ps
+#define sg_reduce_min_pd sg_reduce_min_generic_pd
+#define sg_reduce_max_pi32 sg_reduce_max_generic_pi32
+#define sg_reduce_max_pi64 sg_reduce_max_generic_pi64
+#define sg_reduce_max_ps sg_reduce_max_generic_ps
+#define sg_reduce_max_pd sg_reduce_max_generic_pd
 
-template <typename From, typename To>
-inline To sg_vectorcall(sg_convert_nearest)(const From x) = delete;
+#elif defined SIMD_GRANODI_SSE2
+// Combine the high and low halves, then the two remaining elements
+static inline int32_t sg_vectorcall(sg_reduce_add_pi32)(const sg_pi32 a) {
+    const __m128i t = _mm_add_epi32(a,
+        _mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtsi128_si32(_mm_add_epi32(t,
+        _mm_shuffle_epi32(t, _MM_SHUFFLE(2, 3, 0, 1))));
+}
+static inline int32_t sg_vectorcall(sg_reduce_min_pi32)(const sg_pi32 a) {
+    const __m128i t = sg_min_pi32(a,
+        _mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtsi128_si32(sg_min_pi32(t,
+        _mm_shuffle_epi32(t, _MM_SHUFFLE(2, 3, 0, 1))));
+}
+static inline int32_t sg_vectorcall(sg_reduce_max_pi32)(const sg_pi32 a) {
+    const __m128i t = sg_max_pi32(a,
+        _mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtsi128_si32(sg_max_pi32(t,
+        _mm_shuffle_epi32(t, _MM_SHUFFLE(2, 3, 0, 1))));
+}
+static inline int64_t sg_vectorcall(sg_reduce_add_pi64)(const sg_pi64 a) {
+    return sg_get0_pi64(_mm_add_epi64(a, _mm_unpackhi_epi64(a, a)));
+}
+#define sg_reduce_min_pi64(a) sg_reduce_min_generic_pi64( \
+    sg_to_generic_pi64(a))
+#define sg_reduce_max_pi64(a) sg_reduce_max_generic_pi64( \
+    sg_to_generic_pi64(a))
+static inline float sg_vectorcall(sg_reduce_add_ps)(const sg_ps a) {
+    const __m128 t = _mm_add_ps(a, _mm_movehl_ps(a, a));
+    return _mm_cvtss_f32(_mm_add_ss(t, _mm_shuffle_ps(t, t, 1)));
+}
+static inline float sg_vectorcall(sg_reduce_min_ps)(const sg_ps a) {
+    const __m128 t = _mm_min_ps(a, _mm_movehl_ps(a, a));
+    return _mm_cvtss_f32(_mm_min_ss(t, _mm_shuffle_ps(t, t, 1)));
+}
+static inline float sg_vectorcall(sg_reduce_max_ps)(const sg_ps a) {
+    const __m128 t = _mm_max_ps(a, _mm_movehl_ps(a, a));
+    return _mm_cvtss_f32(_mm_max_ss(t, _mm_shuffle_ps(t, t, 1)));
+}
+static inline double sg_vectorcall(sg_reduce_add_pd)(const sg_pd a) {
+    return _mm_cvtsd_f64(_mm_add_sd(a, _mm_unpackhi_pd(a, a)));
+}
+static inline double sg_vectorcall(sg_reduce_min_pd)(const sg_pd a) {
+    return _mm_cvtsd_f64(_mm_min_sd(a, _mm_unpackhi_pd(a, a)));
+}
+static inline double sg_vectorcall(sg_reduce_max_pd)(const sg_pd a) {
+    return _mm_cvtsd_f64(_mm_max_sd(a, _mm_unpackhi_pd(a, a)));
+}
 
-template <typename From, typename To>
-inline To sg_vectorcall(sg_convert_truncate)(const From x) = delete;
+#elif defined SIMD_GRANODI_NEON
+#define sg_reduce_add_pi32 vaddvq_s32
+#define sg_reduce_add_pi64 vaddvq_s64
+#define sg_reduce_add_ps vaddvq_f32
+#define sg_reduce_add_pd vaddvq_f64
+#define sg_reduce_add_s32x2 vaddv_s32
+#define sg_reduce_add_f32x2 vaddv_f32
+#define sg_reduce_min_pi32 vminvq_s32
+static inline int64_t sg_vectorcall(sg_reduce_min_pi64)(const sg_pi64 a) {
+    return sg_min_scalar_(vgetq_lane_s64(a, 0), vgetq_lane_s64(a, 1));
+}
+#define sg_reduce_min_ps vminvq_f32
+#define sg_reduce_min_pd vminvq_f64
+#define sg_reduce_min_s32x2 vminv_s32
+#define sg_reduce_min_f32x2 vminv_f32
+#define sg_reduce_max_pi32 vmaxvq_s32
+static inline int64_t sg_vectorcall(sg_reduce_max_pi64)(const sg_pi64 a) {
+    return sg_max_scalar_(vgetq_lane_s64(a, 0), vgetq_lane_s64(a, 1));
+}
+#define sg_reduce_max_ps vmaxvq_f32
+#define sg_reduce_max_pd vmaxvq_f64
+#define sg_reduce_max_s32x2 vmaxv_s32
+#define sg_reduce_max_f32x2 vmaxv_f32
+#endif
 
-template <typename From, typename To>
-inline To sg_vectorcall(sg_convert_floor)(const From x) = delete;
+#if defined SIMD_GRANODI_FORCE_GENERIC || defined SIMD_GRANODI_SSE2
+#define sg_reduce_add_s32x2 sg_reduce_add_generic_s32x2
+#define sg_reduce_add_f32x2 sg_reduce_add_generic_f32x2
+#define sg_reduce_min_s32x2 sg_reduce_min_generic_s32x2
+#define sg_reduce_min_f32x2 sg_reduce_min_generic_f32x2
+#define sg_reduce_max_s32x2 sg_reduce_max_generic_s32x2
+#define sg_reduce_max_f32x2 sg_reduce_max_generic_f32x2
+#endif
 
-template <typename From, typename To>
-inline To sg_vectorcall(sg_bitcast)(const From x) = delete;
+//
+//
+//
+//
+//
+//
+//
+// Prefix sum section
+// Inclusive prefix sum (scan): element i of the result is the sum of elements
+// 0 to i. Floating point sums may be added in a different order on each
+// platform
 
-class Compare_pi32 {
-    sg_cmp_pi32 data_;
-public:
-    Compare_pi32() : data_{sg_setzero_cmp_pi32()} {}
-    Compare_pi32(const bool b) : data_{sg_set1cmp_pi32(b)} {}
-    Compare_pi32(const bool b3, const bool b2, const bool b1,
-        const bool b0)
-        : data_{sg_setcmp_pi32(b3, b2, b1, b0)} {}
-    Compare_pi32(const sg_cmp_pi32 cmp) : data_{cmp} {}
-    #ifndef SIMD_GRANODI_FORCE_GENERIC
-    Compare_pi32(const sg_generic_cmp4 cmp)
-        : data_{sg_from_generic_cmp_pi32(cmp)} {}
-    #endif
+static inline sg_generic_pi32 sg_vectorcall(sg_prefix_sum_generic_pi32)(
+    sg_generic_pi32 a)
+{
+    a.i1 = sg_add_wrap_s32x1_(a.i1, a.i0);
+    a.i2 = sg_add_wrap_s32x1_(a.i2, a.i1);
+    a.i3 = sg_add_wrap_s32x1_(a.i3, a.i2);
+    return a;
+}
+static inline sg_generic_pi64 sg_vectorcall(sg_prefix_sum_generic_pi64)(
+    sg_generic_pi64 a)
+{
+    a.l1 = sg_add_wrap_s64x1_(a.l1, a.l0);
+    return a;
+}
+static inline sg_generic_ps sg_vectorcall(sg_prefix_sum_generic_ps)(
+    sg_generic_ps a)
+{
+    a.f1 += a.f0; a.f2 += a.f1; a.f3 += a.f2;
+    return a;
+}
+static inline sg_generic_pd sg_vectorcall(sg_prefix_sum_generic_pd)(
+    sg_generic_pd a)
+{
+    a.d1 += a.d0;
+    return a;
+}
+static inline sg_generic_s32x2 sg_vectorcall(sg_prefix_sum_generic_s32x2)(
+    sg_generic_s32x2 a)
+{
+    a.i1 = sg_add_wrap_s32x1_(a.i1, a.i0);
+    return a;
+}
+static inline sg_generic_f32x2 sg_vectorcall(sg_prefix_sum_generic_f32x2)(
+    sg_generic_f32x2 a)
+{
+    a.f1 += a.f0;
+    return a;
+}
 
-    sg_cmp_pi32 sg_vectorcall(data)() const { return data_; }
+#ifdef SIMD_GRANODI_FORCE_GENERIC
+#define sg_prefix_sum_pi32 sg_prefix_sum_generic_pi32
+#define sg_prefix_sum_pi64 sg_prefix_sum_generic_pi64
+#define sg_prefix_sum_ps sg_prefix_sum_generic_ps
+#define sg_prefix_sum_pd sg_prefix_sum_generic_pd
 
-    Compare_pi32 sg_vectorcall(operator&&)(const Compare_pi32 rhs) const {
-        return sg_and_cmp_pi32(data_, rhs.data());
-    }
+#elif defined SIMD_GRANODI_SSE2
+// Adds the vector shifted up by one element, then by two elements
+static inline __m128i sg_vectorcall(sg_prefix_sum_pi32)(__m128i a) {
+    a = _mm_add_epi32(a, _mm_slli_si128(a, 4));
+    return _mm_add_epi32(a, _mm_slli_si128(a, 8));
+}
+static inline __m128i sg_vectorcall(sg_prefix_sum_pi64)(const __m128i a) {
+    return _mm_add_epi64(a, _mm_slli_si128(a, 8));
+}
+static inline __m128 sg_vectorcall(sg_prefix_sum_ps)(__m128 a) {
+    a = _mm_add_ps(a, _mm_castsi128_ps(_mm_slli_si128(
+        _mm_castps_si128(a), 4)));
+    return _mm_add_ps(a, _mm_castsi128_ps(_mm_slli_si128(
+        _mm_castps_si128(a), 8)));
+}
+static inline __m128d sg_vectorcall(sg_prefix_sum_pd)(const __m128d a) {
+    return _mm_add_pd(a, _mm_castsi128_pd(
+        _mm_slli_si128(_mm_castpd_si128(a), 8)));
+}
 
-    Compare_pi32 sg_vectorcall(operator||)(const Compare_pi32 rhs) const {
-        return sg_or_cmp_pi32(data_, rhs.data());
-    }
+#elif defined SIMD_GRANODI_NEON
+static inline sg_pi32 sg_vectorcall(sg_prefix_sum_pi32)(sg_pi32 a) {
+    a = vaddq_s32(a, vextq_s32(vdupq_n_s32(0), a, 3));
+    return vaddq_s32(a, vextq_s32(vdupq_n_s32(0), a, 2));
+}
+static inline sg_pi64 sg_vectorcall(sg_prefix_sum_pi64)(const sg_pi64 a) {
+    return vaddq_s64(a, vextq_s64(vdupq_n_s64(0), a, 1));
+}
+static inline sg_ps sg_vectorcall(sg_prefix_sum_ps)(sg_ps a) {
+    a = vaddq_f32(a, vextq_f32(vdupq_n_f32(0.0f), a, 3));
+    return vaddq_f32(a, vextq_f32(vdupq_n_f32(0.0f), a, 2));
+}
+static inline sg_pd sg_vectorcall(sg_prefix_sum_pd)(const sg_pd a) {
+    return vaddq_f64(a, vextq_f64(vdupq_n_f64(0.0), a, 1));
+}
+static inline sg_s32x2 sg_vectorcall(sg_prefix_sum_s32x2)(const sg_s32x2 a) {
+    return vadd_s32(a, vext_s32(vdup_n_s32(0), a, 1));
+}
+static inline sg_f32x2 sg_vectorcall(sg_prefix_sum_f32x2)(const sg_f32x2 a) {
+    return vadd_f32(a, vext_f32(vdup_n_f32(0.0f), a, 1));
+}
+#endif
 
-    Compare_pi32 sg_vectorcall(operator!)() const {
-        return sg_not_cmp_pi32(data_);
-    }
+#if defined SIMD_GRANODI_FORCE_GENERIC || defined SIMD_GRANODI_SSE2
+#define sg_prefix_sum_s32x2 sg_prefix_sum_generic_s32x2
+#define sg_prefix_sum_f32x2 sg_prefix_sum_generic_f32x2
+#endif
 
-    bool sg_vectorcall(debug_valid_eq)(const bool b3, const bool b2,
-        const bool b1, const bool b0) const
-    {
-        return sg_debug_cmp_valid_eq_pi32(data_, b3, b2, b1, b0);
-    }
-    bool sg_vectorcall(debug_valid_eq)(const bool b) const {
-        return debug_valid_eq(b, b, b, b);
-    }
+//
+//
+//
+//
+//
+//
+//
+// Mask and compress section
+// sg_movemask_cmp_* gives one bit per element of a comparison, with element 0
+// in bit 0.
+// sg_compress_* moves the elements where the comparison is true to the lowest
+// elements, keeping their order, and sets the remaining elements to zero.
+// With sg_movemask_cmp_*, this can be used to pack selected elements into an
+// array (left-packing)
 
-    template <typename To>
-    To sg_vectorcall(to)() const { return sg_convert<Compare_pi32, To>(*this); }
+static inline int32_t sg_vectorcall(sg_movemask_generic_cmp4)(
+    const sg_generic_cmp4 a)
+{
+    return (a.b0 ? 1 : 0) | (a.b1 ? 2 : 0) | (a.b2 ? 4 : 0) | (a.b3 ? 8 : 0);
+}
+static inline int32_t sg_vectorcall(sg_movemask_generic_cmp2)(
+    const sg_generic_cmp2 a)
+{
+    return (a.b0 ? 1 : 0) | (a.b1 ? 2 : 0);
+}
 
-    template <typename From>
-    static Compare_pi32 sg_vectorcall(from)(const From x) {
-        return sg_convert<From, Compare_pi32>(x);
+static inline sg_generic_pi32 sg_vectorcall(sg_compress_generic_pi32)(
+    const sg_generic_pi32 a, const sg_generic_cmp4 cmp)
+{
+    int32_t result[4] = { 0, 0, 0, 0 }, n = 0;
+    if (cmp.b0) result[n++] = a.i0;
+    if (cmp.b1) result[n++] = a.i1;
+    if (cmp.b2) result[n++] = a.i2;
+    if (cmp.b3) result[n++] = a.i3;
+    return sg_set_generic_pi32(result[3], result[2], result[1], result[0]);
+}
+static inline sg_generic_ps sg_vectorcall(sg_compress_generic_ps)(
+    const sg_generic_ps a, const sg_generic_cmp4 cmp)
+{
+    float result[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    int32_t n = 0;
+    if (cmp.b0) result[n++] = a.f0;
+    if (cmp.b1) result[n++] = a.f1;
+    if (cmp.b2) result[n++] = a.f2;
+    if (cmp.b3) result[n++] = a.f3;
+    return sg_set_generic_ps(result[3], result[2], result[1], result[0]);
+}
+
+#ifdef SIMD_GRANODI_FORCE_GENERIC
+#define sg_movemask_cmp_pi32 sg_movemask_generic_cmp4
+#define sg_movemask_cmp_pi64 sg_movemask_generic_cmp2
+#define sg_movemask_cmp_ps sg_movemask_generic_cmp4
+#define sg_movemask_cmp_pd sg_movemask_generic_cmp2
+#define sg_compress_pi32 sg_compress_generic_pi32
+#define sg_compress_ps sg_compress_generic_ps
+
+#elif defined SIMD_GRANODI_SSE2
+#define sg_movemask_cmp_pi32(a) _mm_movemask_ps(_mm_castsi128_ps(a))
+#define sg_movemask_cmp_pi64(a) _mm_movemask_pd(_mm_castsi128_pd(a))
+#define sg_movemask_cmp_ps _mm_movemask_ps
+#define sg_movemask_cmp_pd _mm_movemask_pd
+// One shuffle for each of the 16 masks, then zero the unused elements
+static inline sg_pi32 sg_vectorcall(sg_compress_pi32)(const sg_pi32 a,
+    const sg_cmp_pi32 cmp)
+{
+    switch (sg_movemask_cmp_pi32(cmp)) {
+case 0: return _mm_setzero_si128();
+case 1: return _mm_and_si128(_mm_shuffle_epi32(a, 0),
+        _mm_set_epi32(0, 0, 0, -1));
+case 2: return _mm_and_si128(_mm_shuffle_epi32(a, 1),
+        _mm_set_epi32(0, 0, 0, -1));
+case 3: return _mm_and_si128(_mm_shuffle_epi32(a, 4),
+        _mm_set_epi32(0, 0, -1, -1));
+case 4: return _mm_and_si128(_mm_shuffle_epi32(a, 2),
+        _mm_set_epi32(0, 0, 0, -1));
+case 5: return _mm_and_si128(_mm_shuffle_epi32(a, 8),
+        _mm_set_epi32(0, 0, -1, -1));
+case 6: return _mm_and_si128(_mm_shuffle_epi32(a, 9),
+        _mm_set_epi32(0, 0, -1, -1));
+case 7: return _mm_and_si128(_mm_shuffle_epi32(a, 36),
+        _mm_set_epi32(0, -1, -1, -1));
+case 8: return _mm_and_si128(_mm_shuffle_epi32(a, 3),
+        _mm_set_epi32(0, 0, 0, -1));
+case 9: return _mm_and_si128(_mm_shuffle_epi32(a, 12),
+        _mm_set_epi32(0, 0, -1, -1));
+case 10: return _mm_and_si128(_mm_shuffle_epi32(a, 13),
+        _mm_set_epi32(0, 0, -1, -1));
+case 11: return _mm_and_si128(_mm_shuffle_epi32(a, 52),
+        _mm_set_epi32(0, -1, -1, -1));
+case 12: return _mm_and_si128(_mm_shuffle_epi32(a, 14),
+        _mm_set_epi32(0, 0, -1, -1));
+case 13: return _mm_and_si128(_mm_shuffle_epi32(a, 56),
+        _mm_set_epi32(0, -1, -1, -1));
+case 14: return _mm_and_si128(_mm_shuffle_epi32(a, 57),
+        _mm_set_epi32(0, -1, -1, -1));
+case 15: return a;
+default: return a;
+    }
+}
+static inline sg_ps sg_vectorcall(sg_compress_ps)(const sg_ps a,
+    const sg_cmp_ps cmp)
+{
+    switch (sg_movemask_cmp_ps(cmp)) {
+case 0: return _mm_setzero_ps();
+case 1: return _mm_and_ps(_mm_shuffle_ps(a, a, 0),
+        _mm_castsi128_ps(_mm_set_epi32(0, 0, 0, -1)));
+case 2: return _mm_and_ps(_mm_shuffle_ps(a, a, 1),
+        _mm_castsi128_ps(_mm_set_epi32(0, 0, 0, -1)));
+case 3: return _mm_and_ps(_mm_shuffle_ps(a, a, 4),
+        _mm_castsi128_ps(_mm_set_epi32(0, 0, -1, -1)));
+case 4: return _mm_and_ps(_mm_shuffle_ps(a, a, 2),
+        _mm_castsi128_ps(_mm_set_epi32(0, 0, 0, -1)));
+case 5: return _mm_and_ps(_mm_shuffle_ps(a, a, 8),
+        _mm_castsi128_ps(_mm_set_epi32(0, 0, -1, -1)));
+case 6: return _mm_and_ps(_mm_shuffle_ps(a, a, 9),
+        _mm_castsi128_ps(_mm_set_epi32(0, 0, -1, -1)));
+case 7: return _mm_and_ps(_mm_shuffle_ps(a, a, 36),
+        _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1)));
+case 8: return _mm_and_ps(_mm_shuffle_ps(a, a, 3),
+        _mm_castsi128_ps(_mm_set_epi32(0, 0, 0, -1)));
+case 9: return _mm_and_ps(_mm_shuffle_ps(a, a, 12),
+        _mm_castsi128_ps(_mm_set_epi32(0, 0, -1, -1)));
+case 10: return _mm_and_ps(_mm_shuffle_ps(a, a, 13),
+        _mm_castsi128_ps(_mm_set_epi32(0, 0, -1, -1)));
+case 11: return _mm_and_ps(_mm_shuffle_ps(a, a, 52),
+        _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1)));
+case 12: return _mm_and_ps(_mm_shuffle_ps(a, a, 14),
+        _mm_castsi128_ps(_mm_set_epi32(0, 0, -1, -1)));
+case 13: return _mm_and_ps(_mm_shuffle_ps(a, a, 56),
+        _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1)));
+case 14: return _mm_and_ps(_mm_shuffle_ps(a, a, 57),
+        _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1)));
+case 15: return a;
+default: return a;
     }
+}
 
-    inline Vec_pi32 sg_vectorcall(choose_else_zero)(const Vec_pi32 if_true)
-        const;
-    inline Vec_pi32 sg_vectorcall(choose)(const Vec_pi32 if_true,
-        const Vec_pi32 if_false) const;
+#elif defined SIMD_GRANODI_NEON
+static inline int32_t sg_vectorcall(sg_movemask_cmp_pi32)(
+    const sg_cmp_pi32 a)
+{
+    const uint32_t bits[4] = { 1, 2, 4, 8 };
+    return (int32_t) vaddvq_u32(vandq_u32(a, vld1q_u32(bits)));
+}
+static inline int32_t sg_vectorcall(sg_movemask_cmp_pi64)(
+    const sg_cmp_pi64 a)
+{
+    const uint64_t bits[2] = { 1, 2 };
+    return (int32_t) vaddvq_u64(vandq_u64(a, vld1q_u64(bits)));
+}
+#define sg_movemask_cmp_ps sg_movemask_cmp_pi32
+#define sg_movemask_cmp_pd sg_movemask_cmp_pi64
+// Byte indices for vqtbl1q_u8() for each of the 16 masks. Out of range
+// indices give zero
+static const uint8_t sg_neon_compress_table_[16][16] = {
+    { 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255 },
+    { 0, 1, 2, 3, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255 },
+    { 4, 5, 6, 7, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255 },
+    { 0, 1, 2, 3, 4, 5, 6, 7, 255, 255, 255, 255, 255, 255, 255, 255 },
+    { 8, 9, 10, 11, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255 },
+    { 0, 1, 2, 3, 8, 9, 10, 11, 255, 255, 255, 255, 255, 255, 255, 255 },
+    { 4, 5, 6, 7, 8, 9, 10, 11, 255, 255, 255, 255, 255, 255, 255, 255 },
+    { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 255, 255, 255, 255 },
+    { 12, 13, 14, 15, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255 },
+    { 0, 1, 2, 3, 12, 13, 14, 15, 255, 255, 255, 255, 255, 255, 255, 255 },
+    { 4, 5, 6, 7, 12, 13, 14, 15, 255, 255, 255, 255, 255, 255, 255, 255 },
+    { 0, 1, 2, 3, 4, 5, 6, 7, 12, 13, 14, 15, 255, 255, 255, 255 },
+    { 8, 9, 10, 11, 12, 13, 14, 15, 255, 255, 255, 255, 255, 255, 255, 255 },
+    { 0, 1, 2, 3, 8, 9, 10, 11, 12, 13, 14, 15, 255, 255, 255, 255 },
+    { 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 255, 255, 255, 255 },
+    { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 }
 };
-
-inline Compare_pi32 sg_vectorcall(operator==)(const Compare_pi32 lhs,
-    const Compare_pi32 rhs)
+static inline sg_pi32 sg_vectorcall(sg_compress_pi32)(const sg_pi32 a,
+    const sg_cmp_pi32 cmp)
 {
-    return sg_cmpeq_cmp_pi32(lhs.data(), rhs.data());
+    return vreinterpretq_s32_u8(vqtbl1q_u8(vreinterpretq_u8_s32(a),
+        vld1q_u8(sg_neon_compress_table_[sg_movemask_cmp_pi32(cmp)])));
 }
-inline Compare_pi32 sg_vectorcall(operator!=)(const Compare_pi32 lhs,
-    const Compare_pi32 rhs)
+static inline sg_ps sg_vectorcall(sg_compress_ps)(const sg_ps a,
+    const sg_cmp_ps cmp)
 {
-    return sg_cmpneq_cmp_pi32(lhs.data(), rhs.data());
+    return vreinterpretq_f32_u8(vqtbl1q_u8(vreinterpretq_u8_f32(a),
+        vld1q_u8(sg_neon_compress_table_[sg_movemask_cmp_ps(cmp)])));
 }
+#endif
 
-typedef Compare_pi32 Compare_s32x4;
+#if defined SIMD_GRANODI_FORCE_GENERIC || defined SIMD_GRANODI_SSE2
+#define sg_movemask_cmp_s32x2 sg_movemask_generic_cmp2
+#define sg_movemask_cmp_f32x2 sg_movemask_generic_cmp2
+#elif defined SIMD_GRANODI_NEON
+static inline int32_t sg_vectorcall(sg_movemask_cmp_s32x2)(
+    const sg_cmp_s32x2 a)
+{
+    const uint32_t bits[2] = { 1, 2 };
+    return (int32_t) vaddv_u32(vand_u32(a, vld1_u32(bits)));
+}
+#define sg_movemask_cmp_f32x2 sg_movemask_cmp_s32x2
+#endif
+
+//
+//
+//
+//
+//
+//
+//
+// Transpose section
+// Transposes a 4x4 (or 2x2) matrix held as one vector per row, in place:
+// element j of row i is swapped with element i of row j
+
+static inline void sg_transpose4_generic_pi32(sg_generic_pi32 *const r0,
+    sg_generic_pi32 *const r1, sg_generic_pi32 *const r2,
+    sg_generic_pi32 *const r3)
+{
+    const sg_generic_pi32 a = *r0, b = *r1, c = *r2, d = *r3;
+    *r0 = sg_set_generic_pi32(d.i0, c.i0, b.i0, a.i0);
+    *r1 = sg_set_generic_pi32(d.i1, c.i1, b.i1, a.i1);
+    *r2 = sg_set_generic_pi32(d.i2, c.i2, b.i2, a.i2);
+    *r3 = sg_set_generic_pi32(d.i3, c.i3, b.i3, a.i3);
+}
+static inline void sg_transpose4_generic_ps(sg_generic_ps *const r0,
+    sg_generic_ps *const r1, sg_generic_ps *const r2,
+    sg_generic_ps *const r3)
+{
+    const sg_generic_ps a = *r0, b = *r1, c = *r2, d = *r3;
+    *r0 = sg_set_generic_ps(d.f0, c.f0, b.f0, a.f0);
+    *r1 = sg_set_generic_ps(d.f1, c.f1, b.f1, a.f1);
+    *r2 = sg_set_generic_ps(d.f2, c.f2, b.f2, a.f2);
+    *r3 = sg_set_generic_ps(d.f3, c.f3, b.f3, a.f3);
+}
+static inline void sg_transpose2_generic_pi64(sg_generic_pi64 *const r0,
+    sg_generic_pi64 *const r1)
+{
+    const int64_t t = r0->l1;
+    r0->l1 = r1->l0; r1->l0 = t;
+}
+static inline void sg_transpose2_generic_pd(sg_generic_pd *const r0,
+    sg_generic_pd *const r1)
+{
+    const double t = r0->d1;
+    r0->d1 = r1->d0; r1->d0 = t;
+}
+
+#ifdef SIMD_GRANODI_FORCE_GENERIC
+#define sg_transpose4_pi32 sg_transpose4_generic_pi32
+#define sg_transpose4_ps sg_transpose4_generic_ps
+#define sg_transpose2_pi64 sg_transpose2_generic_pi64
+#define sg_transpose2_pd sg_transpose2_generic_pd
+
+#elif defined SIMD_GRANODI_SSE2
+static inline void sg_transpose4_ps(sg_ps *const r0, sg_ps *const r1,
+    sg_ps *const r2, sg_ps *const r3)
+{
+    _MM_TRANSPOSE4_PS(*r0, *r1, *r2, *r3);
+}
+static inline void sg_transpose4_pi32(sg_pi32 *const r0, sg_pi32 *const r1,
+    sg_pi32 *const r2, sg_pi32 *const r3)
+{
+    const __m128i t0 = _mm_unpacklo_epi32(*r0, *r1),
+        t1 = _mm_unpacklo_epi32(*r2, *r3),
+        t2 = _mm_unpackhi_epi32(*r0, *r1),
+        t3 = _mm_unpackhi_epi32(*r2, *r3);
+    *r0 = _mm_unpacklo_epi64(t0, t1);
+    *r1 = _mm_unpackhi_epi64(t0, t1);
+    *r2 = _mm_unpacklo_epi64(t2, t3);
+    *r3 = _mm_unpackhi_epi64(t2, t3);
+}
+static inline void sg_transpose2_pi64(sg_pi64 *const r0, sg_pi64 *const r1) {
+    const __m128i t = _mm_unpacklo_epi64(*r0, *r1);
+    *r1 = _mm_unpackhi_epi64(*r0, *r1);
+    *r0 = t;
+}
+static inline void sg_transpose2_pd(sg_pd *const r0, sg_pd *const r1) {
+    const __m128d t = _mm_unpacklo_pd(*r0, *r1);
+    *r1 = _mm_unpackhi_pd(*r0, *r1);
+    *r0 = t;
+}
+
+#elif defined SIMD_GRANODI_NEON
+static inline void sg_transpose4_ps(sg_ps *const r0, sg_ps *const r1,
+    sg_ps *const r2, sg_ps *const r3)
+{
+    const float32x4x2_t t01 = vtrnq_f32(*r0, *r1), t23 = vtrnq_f32(*r2, *r3);
+    *r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+    *r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+    *r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+    *r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+static inline void sg_transpose4_pi32(sg_pi32 *const r0, sg_pi32 *const r1,
+    sg_pi32 *const r2, sg_pi32 *const r3)
+{
+    const int32x4x2_t t01 = vtrnq_s32(*r0, *r1), t23 = vtrnq_s32(*r2, *r3);
+    *r0 = vcombine_s32(vget_low_s32(t01.val[0]), vget_low_s32(t23.val[0]));
+    *r1 = vcombine_s32(vget_low_s32(t01.val[1]), vget_low_s32(t23.val[1]));
+    *r2 = vcombine_s32(vget_high_s32(t01.val[0]), vget_high_s32(t23.val[0]));
+    *r3 = vcombine_s32(vget_high_s32(t01.val[1]), vget_high_s32(t23.val[1]));
+}
+static inline void sg_transpose2_pi64(sg_pi64 *const r0, sg_pi64 *const r1) {
+    const int64x2_t t = vzip1q_s64(*r0, *r1);
+    *r1 = vzip2q_s64(*r0, *r1);
+    *r0 = t;
+}
+static inline void sg_transpose2_pd(sg_pd *const r0, sg_pd *const r1) {
+    const float64x2_t t = vzip1q_f64(*r0, *r1);
+    *r1 = vzip2q_f64(*r0, *r1);
+    *r0 = t;
+}
+#endif
+
+//
+//
+//
+//
+//
+//
+//
+// Saturating arithmetic section
+// Signed integer add and subtract that clamp to the range of the element type
+// instead of wrapping, and saturating narrowing conversions
+
+static inline int32_t sg_vectorcall(sg_adds_s32x1)(const int32_t a,
+    const int32_t b)
+{
+    const int64_t result = (int64_t) a + (int64_t) b;
+    return result > INT32_MAX ? INT32_MAX :
+        result < INT32_MIN ? INT32_MIN : (int32_t) result;
+}
+static inline int32_t sg_vectorcall(sg_subs_s32x1)(const int32_t a,
+    const int32_t b)
+{
+    const int64_t result = (int64_t) a - (int64_t) b;
+    return result > INT32_MAX ? INT32_MAX :
+        result < INT32_MIN ? INT32_MIN : (int32_t) result;
+}
+// Wraps using unsigned arithmetic, then overflow happened if the sign of the
+// result is wrong
+static inline int64_t sg_vectorcall(sg_adds_s64x1)(const int64_t a,
+    const int64_t b)
+{
+    const int64_t result = sg_bitcast_u64x1_s64x1(
+        sg_bitcast_s64x1_u64x1(a) + sg_bitcast_s64x1_u64x1(b));
+    return ((a ^ result) & (b ^ result)) < 0 ?
+        (a < 0 ? INT64_MIN : INT64_MAX) : result;
+}
+static inline int64_t sg_vectorcall(sg_subs_s64x1)(const int64_t a,
+    const int64_t b)
+{
+    const int64_t result = sg_bitcast_u64x1_s64x1(
+        sg_bitcast_s64x1_u64x1(a) - sg_bitcast_s64x1_u64x1(b));
+    return ((a ^ b) & (a ^ result)) < 0 ?
+        (a < 0 ? INT64_MIN : INT64_MAX) : result;
+}
+static inline int32_t sg_vectorcall(sg_cvtsat_s64x1_s32x1)(const int64_t a) {
+    return a > INT32_MAX ? INT32_MAX : a < INT32_MIN ? INT32_MIN : (int32_t) a;
+}
+static inline int16_t sg_vectorcall(sg_cvtsat_s32x1_s16x1)(const int32_t a) {
+    return a > INT16_MAX ? INT16_MAX : a < INT16_MIN ? INT16_MIN : (int16_t) a;
+}
+
+static inline sg_generic_pi32 sg_vectorcall(sg_adds_generic_pi32)(
+    const sg_generic_pi32 a, const sg_generic_pi32 b)
+{
+    return sg_set_generic_pi32(sg_adds_s32x1(a.i3, b.i3),
+        sg_adds_s32x1(a.i2, b.i2), sg_adds_s32x1(a.i1, b.i1),
+        sg_adds_s32x1(a.i0, b.i0));
+}
+static inline sg_generic_pi32 sg_vectorcall(sg_subs_generic_pi32)(
+    const sg_generic_pi32 a, const sg_generic_pi32 b)
+{
+    return sg_set_generic_pi32(sg_subs_s32x1(a.i3, b.i3),
+        sg_subs_s32x1(a.i2, b.i2), sg_subs_s32x1(a.i1, b.i1),
+        sg_subs_s32x1(a.i0, b.i0));
+}
+static inline sg_generic_pi64 sg_vectorcall(sg_adds_generic_pi64)(
+    const sg_generic_pi64 a, const sg_generic_pi64 b)
+{
+    return sg_set_generic_pi64(sg_adds_s64x1(a.l1, b.l1),
+        sg_adds_s64x1(a.l0, b.l0));
+}
+static inline sg_generic_pi64 sg_vectorcall(sg_subs_generic_pi64)(
+    const sg_generic_pi64 a, const sg_generic_pi64 b)
+{
+    return sg_set_generic_pi64(sg_subs_s64x1(a.l1, b.l1),
+        sg_subs_s64x1(a.l0, b.l0));
+}
+static inline sg_generic_s32x2 sg_vectorcall(sg_adds_generic_s32x2)(
+    const sg_generic_s32x2 a, const sg_generic_s32x2 b)
+{
+    return sg_set_generic_s32x2(sg_adds_s32x1(a.i1, b.i1),
+        sg_adds_s32x1(a.i0, b.i0));
+}
+static inline sg_generic_s32x2 sg_vectorcall(sg_subs_generic_s32x2)(
+    const sg_generic_s32x2 a, const sg_generic_s32x2 b)
+{
+    return sg_set_generic_s32x2(sg_subs_s32x1(a.i1, b.i1),
+        sg_subs_s32x1(a.i0, b.i0));
+}
+
+// pi64 to pi32 sets the upper two elements to zero, as with sg_cvt_pi64_pi32
+static inline sg_generic_pi32 sg_vectorcall(sg_cvtsat_generic_pi64_pi32)(
+    const sg_generic_pi64 a)
+{
+    return sg_set_generic_pi32(0, 0, sg_cvtsat_s64x1_s32x1(a.l1),
+        sg_cvtsat_s64x1_s32x1(a.l0));
+}
+static inline sg_generic_s32x2 sg_vectorcall(sg_cvtsat_generic_pi64_s32x2)(
+    const sg_generic_pi64 a)
+{
+    return sg_set_generic_s32x2(sg_cvtsat_s64x1_s32x1(a.l1),
+        sg_cvtsat_s64x1_s32x1(a.l0));
+}
+
+// Stores the elements of lo then hi as 8 x int16_t, saturated
+static inline void sg_vectorcall(sg_storeu_sat16_generic_pi32)(
+    int16_t *const s, const sg_generic_pi32 lo, const sg_generic_pi32 hi)
+{
+    s[0] = sg_cvtsat_s32x1_s16x1(lo.i0); s[1] = sg_cvtsat_s32x1_s16x1(lo.i1);
+    s[2] = sg_cvtsat_s32x1_s16x1(lo.i2); s[3] = sg_cvtsat_s32x1_s16x1(lo.i3);
+    s[4] = sg_cvtsat_s32x1_s16x1(hi.i0); s[5] = sg_cvtsat_s32x1_s16x1(hi.i1);
+    s[6] = sg_cvtsat_s32x1_s16x1(hi.i2); s[7] = sg_cvtsat_s32x1_s16x1(hi.i3);
+}
+
+#ifdef SIMD_GRANODI_FORCE_GENERIC
+#define sg_adds_pi32 sg_adds_generic_pi32
+#define sg_subs_pi32 sg_subs_generic_pi32
+#define sg_adds_pi64 sg_adds_generic_pi64
+#define sg_subs_pi64 sg_subs_generic_pi64
+#define sg_cvtsat_pi64_pi32 sg_cvtsat_generic_pi64_pi32
+#define sg_storeu_sat16_pi32 sg_storeu_sat16_generic_pi32
+
+#elif defined SIMD_GRANODI_SSE2
+// Overflow happened where the sign bit of the mask is set. The saturated
+// value is INT_MAX or INT_MIN, depending on the sign of a
+static inline __m128i sg_vectorcall(sg_sse2_saturate_pi32_)(const __m128i a,
+    const __m128i result, const __m128i overflow_sign)
+{
+    const __m128i overflow = _mm_srai_epi32(overflow_sign, 31),
+        saturated = _mm_xor_si128(_mm_srai_epi32(a, 31),
+            _mm_set1_epi32(INT32_MAX));
+    return _mm_or_si128(_mm_and_si128(overflow, saturated),
+        _mm_andnot_si128(overflow, result));
+}
+static inline __m128i sg_vectorcall(sg_adds_pi32)(const __m128i a,
+    const __m128i b)
+{
+    const __m128i result = _mm_add_epi32(a, b);
+    return sg_sse2_saturate_pi32_(a, result, _mm_and_si128(
+        _mm_xor_si128(a, result), _mm_xor_si128(b, result)));
+}
+static inline __m128i sg_vectorcall(sg_subs_pi32)(const __m128i a,
+    const __m128i b)
+{
+    const __m128i result = _mm_sub_epi32(a, b);
+    return sg_sse2_saturate_pi32_(a, result, _mm_and_si128(
+        _mm_xor_si128(a, b), _mm_xor_si128(a, result)));
+}
+// As above, with the sign of each 64-bit element copied from the upper half
+static inline __m128i sg_vectorcall(sg_sse2_saturate_pi64_)(const __m128i a,
+    const __m128i result, const __m128i overflow_sign)
+{
+    const __m128i overflow = _mm_shuffle_epi32(_mm_srai_epi32(
+        overflow_sign, 31), sg_sse2_shuffle32_imm(3, 3, 1, 1)),
+        saturated = _mm_xor_si128(_mm_shuffle_epi32(_mm_srai_epi32(a, 31),
+            sg_sse2_shuffle32_imm(3, 3, 1, 1)),
+            _mm_set1_epi64x(INT64_MAX));
+    return _mm_or_si128(_mm_and_si128(overflow, saturated),
+        _mm_andnot_si128(overflow, result));
+}
+static inline __m128i sg_vectorcall(sg_adds_pi64)(const __m128i a,
+    const __m128i b)
+{
+    const __m128i result = _mm_add_epi64(a, b);
+    return sg_sse2_saturate_pi64_(a, result, _mm_and_si128(
+        _mm_xor_si128(a, result), _mm_xor_si128(b, result)));
+}
+static inline __m128i sg_vectorcall(sg_subs_pi64)(const __m128i a,
+    const __m128i b)
+{
+    const __m128i result = _mm_sub_epi64(a, b);
+    return sg_sse2_saturate_pi64_(a, result, _mm_and_si128(
+        _mm_xor_si128(a, b), _mm_xor_si128(a, result)));
+}
+// A 64-bit element is in range if its upper half is the sign extension of
+// its lower half. Otherwise the lower half is replaced by INT32_MAX or
+// INT32_MIN, depending on the sign
+static inline __m128i sg_vectorcall(sg_cvtsat_pi64_pi32)(const __m128i a) {
+    const __m128i sign = _mm_srai_epi32(a, 31),
+        in_range = _mm_shuffle_epi32(_mm_cmpeq_epi32(a, _mm_shuffle_epi32(
+            sign, sg_sse2_shuffle32_imm(2, 2, 0, 0))),
+            sg_sse2_shuffle32_imm(3, 3, 1, 1)),
+        saturated = _mm_xor_si128(_mm_shuffle_epi32(sign,
+            sg_sse2_shuffle32_imm(3, 3, 1, 1)), _mm_set1_epi32(INT32_MAX));
+    return sg_cvt_pi64_pi32(_mm_or_si128(_mm_and_si128(in_range, a),
+        _mm_andnot_si128(in_range, saturated)));
+}
+#define sg_storeu_sat16_pi32(s, lo, hi) _mm_storeu_si128((__m128i *) (s), \
+    _mm_packs_epi32((lo), (hi)))
+
+#elif defined SIMD_GRANODI_NEON
+#define sg_adds_pi32 vqaddq_s32
+#define sg_subs_pi32 vqsubq_s32
+#define sg_adds_pi64 vqaddq_s64
+#define sg_subs_pi64 vqsubq_s64
+#define sg_adds_s32x2 vqadd_s32
+#define sg_subs_s32x2 vqsub_s32
+#define sg_cvtsat_pi64_pi32(a) vcombine_s32(vqmovn_s64(a), vdup_n_s32(0))
+#define sg_cvtsat_pi64_s32x2 vqmovn_s64
+#define sg_storeu_sat16_pi32(s, lo, hi) vst1q_s16((s), \
+    vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)))
+#endif
+
+#if defined SIMD_GRANODI_FORCE_GENERIC || defined SIMD_GRANODI_SSE2
+#define sg_adds_s32x2 sg_adds_generic_s32x2
+#define sg_subs_s32x2 sg_subs_generic_s32x2
+#define sg_cvtsat_pi64_s32x2(a) \
+    sg_cvtsat_generic_pi64_s32x2(sg_to_generic_pi64(a))
+#endif
+
+//
+//
+//
+//
+//
+//
+//
+// Multiply high and widening multiply section
+// mulhi gives the high half of the full product of each element, and
+// mulhi_pu32 treats the elements as unsigned. mul_wide_even_pi32 gives the
+// full 64-bit products of elements 0 and 2
+
+static inline int32_t sg_vectorcall(sg_mulhi_s32x1)(const int32_t a,
+    const int32_t b)
+{
+    return (int32_t) (((int64_t) a * (int64_t) b) >> 32);
+}
+static inline int32_t sg_vectorcall(sg_mulhi_u32x1)(const int32_t a,
+    const int32_t b)
+{
+    return sg_bitcast_u32x1_s32x1((uint32_t) (((uint64_t)
+        sg_bitcast_s32x1_u32x1(a) * sg_bitcast_s32x1_u32x1(b)) >> 32));
+}
+// The unsigned high half from 32-bit halves, then corrected for the signs
+static inline int64_t sg_vectorcall(sg_mulhi_s64x1)(const int64_t a,
+    const int64_t b)
+{
+    const uint64_t ua = sg_bitcast_s64x1_u64x1(a),
+        ub = sg_bitcast_s64x1_u64x1(b);
+    const uint64_t a_lo = ua & 0xffffffff, a_hi = ua >> 32,
+        b_lo = ub & 0xffffffff, b_hi = ub >> 32;
+    const uint64_t t = a_lo * b_lo, u = a_hi * b_lo + (t >> 32),
+        w = a_lo * b_hi + (u & 0xffffffff);
+    uint64_t hi = a_hi * b_hi + (u >> 32) + (w >> 32);
+    if (a < 0) hi -= ub;
+    if (b < 0) hi -= ua;
+    return sg_bitcast_u64x1_s64x1(hi);
+}
+
+static inline sg_generic_pi32 sg_vectorcall(sg_mulhi_generic_pi32)(
+    const sg_generic_pi32 a, const sg_generic_pi32 b)
+{
+    return sg_set_generic_pi32(sg_mulhi_s32x1(a.i3, b.i3),
+        sg_mulhi_s32x1(a.i2, b.i2), sg_mulhi_s32x1(a.i1, b.i1),
+        sg_mulhi_s32x1(a.i0, b.i0));
+}
+static inline sg_generic_pi32 sg_vectorcall(sg_mulhi_generic_pu32)(
+    const sg_generic_pi32 a, const sg_generic_pi32 b)
+{
+    return sg_set_generic_pi32(sg_mulhi_u32x1(a.i3, b.i3),
+        sg_mulhi_u32x1(a.i2, b.i2), sg_mulhi_u32x1(a.i1, b.i1),
+        sg_mulhi_u32x1(a.i0, b.i0));
+}
+static inline sg_generic_pi64 sg_vectorcall(sg_mulhi_generic_pi64)(
+    const sg_generic_pi64 a, const sg_generic_pi64 b)
+{
+    return sg_set_generic_pi64(sg_mulhi_s64x1(a.l1, b.l1),
+        sg_mulhi_s64x1(a.l0, b.l0));
+}
+static inline sg_generic_pi64 sg_vectorcall(sg_mul_wide_even_generic_pi32)(
+    const sg_generic_pi32 a, const sg_generic_pi32 b)
+{
+    return sg_set_generic_pi64((int64_t) a.i2 * (int64_t) b.i2,
+        (int64_t) a.i0 * (int64_t) b.i0);
+}
+static inline sg_generic_s32x2 sg_vectorcall(sg_mulhi_generic_s32x2)(
+    const sg_generic_s32x2 a, const sg_generic_s32x2 b)
+{
+    return sg_set_generic_s32x2(sg_mulhi_s32x1(a.i1, b.i1),
+        sg_mulhi_s32x1(a.i0, b.i0));
+}
+static inline sg_generic_pi64 sg_vectorcall(sg_mul_wide_generic_s32x2)(
+    const sg_generic_s32x2 a, const sg_generic_s32x2 b)
+{
+    return sg_set_generic_pi64((int64_t) a.i1 * (int64_t) b.i1,
+        (int64_t) a.i0 * (int64_t) b.i0);
+}
+
+#ifdef SIMD_GRANODI_FORCE_GENERIC
+#define sg_mulhi_pi32 sg_mulhi_generic_pi32
+#define sg_mulhi_pu32 sg_mulhi_generic_pu32
+#define sg_mulhi_pi64 sg_mulhi_generic_pi64
+#define sg_mul_wide_even_pi32 sg_mul_wide_even_generic_pi32
+
+#elif defined SIMD_GRANODI_SSE2
+// _mm_mul_epu32 multiplies the even elements. The odd elements are shifted
+// down to be multiplied, and the high halves of both are merged
+static inline __m128i sg_vectorcall(sg_mulhi_pu32)(const __m128i a,
+    const __m128i b)
+{
+    const __m128i even = _mm_mul_epu32(a, b),
+        odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_or_si128(_mm_srli_epi64(even, 32),
+        _mm_andnot_si128(_mm_set_epi32(0, -1, 0, -1), odd));
+}
+// The signed high half is the unsigned high half, minus b where a is
+// negative, and minus a where b is negative
+#define sg_sse2_mul_sign_correction_(a, b) _mm_add_epi32( \
+    _mm_and_si128(_mm_srai_epi32((a), 31), (b)), \
+    _mm_and_si128(_mm_srai_epi32((b), 31), (a)))
+static inline __m128i sg_vectorcall(sg_mulhi_pi32)(const __m128i a,
+    const __m128i b)
+{
+    return _mm_sub_epi32(sg_mulhi_pu32(a, b),
+        sg_sse2_mul_sign_correction_(a, b));
+}
+// SSE2 has no _mm_mul_epi32, so the same correction is applied to the upper
+// half of the unsigned products
+static inline __m128i sg_vectorcall(sg_mul_wide_even_pi32)(const __m128i a,
+    const __m128i b)
+{
+    return _mm_sub_epi64(_mm_mul_epu32(a, b),
+        _mm_slli_epi64(sg_sse2_mul_sign_correction_(a, b), 32));
+}
+#define sg_mulhi_pi64(a, b) sg_from_generic_pi64(sg_mulhi_generic_pi64( \
+    sg_to_generic_pi64(a), sg_to_generic_pi64(b)))
+
+#elif defined SIMD_GRANODI_NEON
+static inline sg_pi32 sg_vectorcall(sg_mulhi_pi32)(const sg_pi32 a,
+    const sg_pi32 b)
+{
+    return vuzp2q_s32(
+        vreinterpretq_s32_s64(vmull_s32(vget_low_s32(a), vget_low_s32(b))),
+        vreinterpretq_s32_s64(vmull_high_s32(a, b)));
+}
+static inline sg_pi32 sg_vectorcall(sg_mulhi_pu32)(const sg_pi32 a,
+    const sg_pi32 b)
+{
+    const uint32x4_t ua = vreinterpretq_u32_s32(a),
+        ub = vreinterpretq_u32_s32(b);
+    return vreinterpretq_s32_u32(vuzp2q_u32(
+        vreinterpretq_u32_u64(vmull_u32(vget_low_u32(ua), vget_low_u32(ub))),
+        vreinterpretq_u32_u64(vmull_high_u32(ua, ub))));
+}
+#define sg_mulhi_pi64(a, b) sg_from_generic_pi64(sg_mulhi_generic_pi64( \
+    sg_to_generic_pi64(a), sg_to_generic_pi64(b)))
+// vmovn_s64 takes the low (even) 32-bit half of each 64-bit element
+#define sg_mul_wide_even_pi32(a, b) vmull_s32( \
+    vmovn_s64(vreinterpretq_s64_s32(a)), vmovn_s64(vreinterpretq_s64_s32(b)))
+#define sg_mulhi_s32x2(a, b) vshrn_n_s64(vmull_s32((a), (b)), 32)
+#define sg_mul_wide_s32x2 vmull_s32
+#endif
+
+#if defined SIMD_GRANODI_FORCE_GENERIC || defined SIMD_GRANODI_SSE2
+#define sg_mulhi_s32x2 sg_mulhi_generic_s32x2
+#define sg_mul_wide_s32x2(a, b) sg_from_generic_pi64( \
+    sg_mul_wide_generic_s32x2(sg_to_generic_s32x2(a), sg_to_generic_s32x2(b)))
+#endif
+
+//
+//
+//
+//
+//
+//
+//
+// Fixed point multiply section
+// Saturating rounding doubling multiply high, for Q31 fixed point: the high
+// 32 bits of 2*a*b, rounded to nearest with ties upwards. The only input that
+// overflows is INT32_MIN * INT32_MIN, which saturates to INT32_MAX
+
+static inline int32_t sg_vectorcall(sg_qrdmulh_s32x1)(const int32_t a,
+    const int32_t b)
+{
+    // Shifting the product right by 31 rather than shifting 2*a*b right by
+    // 32 avoids overflowing int64_t
+    return a == INT32_MIN && b == INT32_MIN ? INT32_MAX :
+        (int32_t) (((int64_t) a * (int64_t) b + ((int64_t) 1 << 30)) >> 31);
+}
+
+static inline sg_generic_pi32 sg_vectorcall(sg_qrdmulh_generic_pi32)(
+    const sg_generic_pi32 a, const sg_generic_pi32 b)
+{
+    return sg_set_generic_pi32(sg_qrdmulh_s32x1(a.i3, b.i3),
+        sg_qrdmulh_s32x1(a.i2, b.i2), sg_qrdmulh_s32x1(a.i1, b.i1),
+        sg_qrdmulh_s32x1(a.i0, b.i0));
+}
+static inline sg_generic_s32x2 sg_vectorcall(sg_qrdmulh_generic_s32x2)(
+    const sg_generic_s32x2 a, const sg_generic_s32x2 b)
+{
+    return sg_set_generic_s32x2(sg_qrdmulh_s32x1(a.i1, b.i1),
+        sg_qrdmulh_s32x1(a.i0, b.i0));
+}
+
+#ifdef SIMD_GRANODI_FORCE_GENERIC
+#define sg_qrdmulh_pi32 sg_qrdmulh_generic_pi32
+
+#elif defined SIMD_GRANODI_SSE2
+// _mm_mul_epu32 gives the unsigned 64-bit products of the even elements (and,
+// after shifting, the odd elements). The rounding constant is added to the
+// full product, then the signed product is formed by subtracting b from the
+// upper half where a is negative, and a where b is negative. The result is
+// bits 31 to 62 of the rounded product
+static inline __m128i sg_vectorcall(sg_qrdmulh_pi32)(const __m128i a,
+    const __m128i b)
+{
+    const __m128i round = _mm_set1_epi64x((int64_t) 1 << 30),
+        lo_mask = _mm_set_epi32(0, -1, 0, -1);
+    const __m128i even = _mm_add_epi64(_mm_mul_epu32(a, b), round),
+        odd = _mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(a, 32),
+            _mm_srli_epi64(b, 32)), round);
+    const __m128i hi = _mm_or_si128(_mm_srli_epi64(even, 32),
+        _mm_andnot_si128(lo_mask, odd)),
+        lo = _mm_or_si128(_mm_and_si128(lo_mask, even),
+            _mm_slli_epi64(odd, 32)),
+        correction = _mm_add_epi32(
+            _mm_and_si128(_mm_srai_epi32(a, 31), b),
+            _mm_and_si128(_mm_srai_epi32(b, 31), a));
+    const __m128i min = _mm_set1_epi32(INT32_MIN),
+        overflow = _mm_and_si128(_mm_cmpeq_epi32(a, min),
+            _mm_cmpeq_epi32(b, min));
+    return _mm_xor_si128(overflow, _mm_or_si128(
+        _mm_slli_epi32(_mm_sub_epi32(hi, correction), 1),
+        _mm_srli_epi32(lo, 31)));
+}
+
+#elif defined SIMD_GRANODI_NEON
+#define sg_qrdmulh_pi32 vqrdmulhq_s32
+#define sg_qrdmulh_s32x2 vqrdmulh_s32
+#endif
+
+#if defined SIMD_GRANODI_FORCE_GENERIC || defined SIMD_GRANODI_SSE2
+#define sg_qrdmulh_s32x2 sg_qrdmulh_generic_s32x2
+#endif
+
+//
+//
+//
+//
+//
+//
+//
+// Bit manipulation section
+// Per element population count, count leading zeros, count trailing zeros
+// (which give the element width for zero) and bit reversal
+
+static inline int32_t sg_vectorcall(sg_popcnt_s32x1)(const int32_t a) {
+    uint32_t u = sg_bitcast_s32x1_u32x1(a);
+    u = u - ((u >> 1) & 0x55555555);
+    u = (u & 0x33333333) + ((u >> 2) & 0x33333333);
+    u = (u + (u >> 4)) & 0x0f0f0f0f;
+    return (int32_t) ((u * 0x01010101) >> 24);
+}
+static inline int64_t sg_vectorcall(sg_popcnt_s64x1)(const int64_t a) {
+    uint64_t u = sg_bitcast_s64x1_u64x1(a);
+    u = u - ((u >> 1) & 0x5555555555555555);
+    u = (u & 0x3333333333333333) + ((u >> 2) & 0x3333333333333333);
+    u = (u + (u >> 4)) & 0x0f0f0f0f0f0f0f0f;
+    return (int64_t) ((u * 0x0101010101010101) >> 56);
+}
+// Every bit below the highest set bit is set, then the zeros are counted
+static inline int32_t sg_vectorcall(sg_clz_s32x1)(const int32_t a) {
+    uint32_t u = sg_bitcast_s32x1_u32x1(a);
+    u |= u >> 1; u |= u >> 2; u |= u >> 4; u |= u >> 8; u |= u >> 16;
+    return sg_popcnt_s32x1(sg_bitcast_u32x1_s32x1(~u));
+}
+static inline int64_t sg_vectorcall(sg_clz_s64x1)(const int64_t a) {
+    uint64_t u = sg_bitcast_s64x1_u64x1(a);
+    u |= u >> 1; u |= u >> 2; u |= u >> 4; u |= u >> 8; u |= u >> 16;
+    u |= u >> 32;
+    return sg_popcnt_s64x1(sg_bitcast_u64x1_s64x1(~u));
+}
+// The trailing zeros become ones, and everything else zero
+static inline int32_t sg_vectorcall(sg_ctz_s32x1)(const int32_t a) {
+    const uint32_t u = sg_bitcast_s32x1_u32x1(a);
+    return sg_popcnt_s32x1(sg_bitcast_u32x1_s32x1(~u & (u - 1)));
+}
+static inline int64_t sg_vectorcall(sg_ctz_s64x1)(const int64_t a) {
+    const uint64_t u = sg_bitcast_s64x1_u64x1(a);
+    return sg_popcnt_s64x1(sg_bitcast_u64x1_s64x1(~u & (u - 1)));
+}
+static inline int32_t sg_vectorcall(sg_rbit_s32x1)(const int32_t a) {
+    uint32_t u = sg_bitcast_s32x1_u32x1(a);
+    u = ((u >> 1) & 0x55555555) | ((u & 0x55555555) << 1);
+    u = ((u >> 2) & 0x33333333) | ((u & 0x33333333) << 2);
+    u = ((u >> 4) & 0x0f0f0f0f) | ((u & 0x0f0f0f0f) << 4);
+    u = ((u >> 8) & 0x00ff00ff) | ((u & 0x00ff00ff) << 8);
+    return sg_bitcast_u32x1_s32x1((u >> 16) | (u << 16));
+}
+static inline int64_t sg_vectorcall(sg_rbit_s64x1)(const int64_t a) {
+    const uint64_t u = sg_bitcast_s64x1_u64x1(a);
+    const uint64_t lo = sg_bitcast_s32x1_u32x1(sg_rbit_s32x1(
+        sg_bitcast_u32x1_s32x1((uint32_t) u))),
+        hi = sg_bitcast_s32x1_u32x1(sg_rbit_s32x1(
+        sg_bitcast_u32x1_s32x1((uint32_t) (u >> 32))));
+    return sg_bitcast_u64x1_s64x1((lo << 32) | hi);
+}
+
+#define sg_bitop_generic_pi32_(op, a) sg_set_generic_pi32(op((a).i3), \
+    op((a).i2), op((a).i1), op((a).i0))
+#define sg_bitop_generic_pi64_(op, a) sg_set_generic_pi64(op((a).l1), \
+    op((a).l0))
+#define sg_bitop_generic_s32x2_(op, a) sg_set_generic_s32x2(op((a).i1), \
+    op((a).i0))
+
+#define sg_popcnt_generic_pi32(a) sg_bitop_generic_pi32_(sg_popcnt_s32x1, a)
+#define sg_popcnt_generic_pi64(a) sg_bitop_generic_pi64_(sg_popcnt_s64x1, a)
+#define sg_popcnt_generic_s32x2(a) \
+    sg_bitop_generic_s32x2_(sg_popcnt_s32x1, a)
+#define sg_clz_generic_pi32(a) sg_bitop_generic_pi32_(sg_clz_s32x1, a)
+#define sg_clz_generic_pi64(a) sg_bitop_generic_pi64_(sg_clz_s64x1, a)
+#define sg_clz_generic_s32x2(a) sg_bitop_generic_s32x2_(sg_clz_s32x1, a)
+#define sg_ctz_generic_pi32(a) sg_bitop_generic_pi32_(sg_ctz_s32x1, a)
+#define sg_ctz_generic_pi64(a) sg_bitop_generic_pi64_(sg_ctz_s64x1, a)
+#define sg_ctz_generic_s32x2(a) sg_bitop_generic_s32x2_(sg_ctz_s32x1, a)
+#define sg_rbit_generic_pi32(a) sg_bitop_generic_pi32_(sg_rbit_s32x1, a)
+#define sg_rbit_generic_pi64(a) sg_bitop_generic_pi64_(sg_rbit_s64x1, a)
+#define sg_rbit_generic_s32x2(a) sg_bitop_generic_s32x2_(sg_rbit_s32x1, a)
+
+#ifdef SIMD_GRANODI_FORCE_GENERIC
+#define sg_popcnt_pi32 sg_popcnt_generic_pi32
+#define sg_popcnt_pi64 sg_popcnt_generic_pi64
+#define sg_clz_pi32 sg_clz_generic_pi32
+#define sg_clz_pi64 sg_clz_generic_pi64
+#define sg_ctz_pi32 sg_ctz_generic_pi32
+#define sg_ctz_pi64 sg_ctz_generic_pi64
+#define sg_rbit_pi32 sg_rbit_generic_pi32
+#define sg_rbit_pi64 sg_rbit_generic_pi64
+
+#elif defined SIMD_GRANODI_SSE2
+// SSE2 has no popcnt or byte shuffle (for a nibble lookup table), so the bits
+// are summed in parallel within each byte. _mm_sad_epu8 then sums the 8 bytes
+// of each 64-bit element
+static inline __m128i sg_vectorcall(sg_sse2_popcnt_bytes_)(__m128i a) {
+    const __m128i m1 = _mm_set1_epi8(0x55), m2 = _mm_set1_epi8(0x33),
+        m4 = _mm_set1_epi8(0x0f);
+    a = _mm_sub_epi8(a, _mm_and_si128(_mm_srli_epi64(a, 1), m1));
+    a = _mm_add_epi8(_mm_and_si128(a, m2),
+        _mm_and_si128(_mm_srli_epi64(a, 2), m2));
+    return _mm_and_si128(_mm_add_epi8(a, _mm_srli_epi64(a, 4)), m4);
+}
+static inline __m128i sg_vectorcall(sg_popcnt_pi32)(const __m128i a) {
+    __m128i bytes = sg_sse2_popcnt_bytes_(a);
+    bytes = _mm_add_epi32(bytes, _mm_srli_epi32(bytes, 8));
+    bytes = _mm_add_epi32(bytes, _mm_srli_epi32(bytes, 16));
+    return _mm_and_si128(bytes, _mm_set1_epi32(0x3f));
+}
+#define sg_popcnt_pi64(a) _mm_sad_epu8(sg_sse2_popcnt_bytes_(a), \
+    _mm_setzero_si128())
+static inline __m128i sg_vectorcall(sg_clz_pi32)(__m128i a) {
+    a = _mm_or_si128(a, _mm_srli_epi32(a, 1));
+    a = _mm_or_si128(a, _mm_srli_epi32(a, 2));
+    a = _mm_or_si128(a, _mm_srli_epi32(a, 4));
+    a = _mm_or_si128(a, _mm_srli_epi32(a, 8));
+    a = _mm_or_si128(a, _mm_srli_epi32(a, 16));
+    return sg_popcnt_pi32(_mm_xor_si128(a, _mm_set1_epi32(-1)));
+}
+static inline __m128i sg_vectorcall(sg_clz_pi64)(__m128i a) {
+    a = _mm_or_si128(a, _mm_srli_epi64(a, 1));
+    a = _mm_or_si128(a, _mm_srli_epi64(a, 2));
+    a = _mm_or_si128(a, _mm_srli_epi64(a, 4));
+    a = _mm_or_si128(a, _mm_srli_epi64(a, 8));
+    a = _mm_or_si128(a, _mm_srli_epi64(a, 16));
+    a = _mm_or_si128(a, _mm_srli_epi64(a, 32));
+    return sg_popcnt_pi64(_mm_xor_si128(a, _mm_set1_epi32(-1)));
+}
+static inline __m128i sg_vectorcall(sg_ctz_pi32)(const __m128i a) {
+    return sg_popcnt_pi32(_mm_andnot_si128(a,
+        _mm_sub_epi32(a, _mm_set1_epi32(1))));
+}
+static inline __m128i sg_vectorcall(sg_ctz_pi64)(const __m128i a) {
+    return sg_popcnt_pi64(_mm_andnot_si128(a,
+        _mm_sub_epi64(a, _mm_set1_epi64x(1))));
+}
+// Reverses the bits within each byte, then the bytes within each 16-bit
+// element, then the 16-bit elements
+static inline __m128i sg_vectorcall(sg_sse2_rbit_pi16_)(__m128i a) {
+    const __m128i m1 = _mm_set1_epi8(0x55), m2 = _mm_set1_epi8(0x33),
+        m4 = _mm_set1_epi8(0x0f);
+    a = _mm_or_si128(_mm_and_si128(_mm_srli_epi64(a, 1), m1),
+        _mm_slli_epi64(_mm_and_si128(a, m1), 1));
+    a = _mm_or_si128(_mm_and_si128(_mm_srli_epi64(a, 2), m2),
+        _mm_slli_epi64(_mm_and_si128(a, m2), 2));
+    a = _mm_or_si128(_mm_and_si128(_mm_srli_epi64(a, 4), m4),
+        _mm_slli_epi64(_mm_and_si128(a, m4), 4));
+    return _mm_or_si128(_mm_srli_epi16(a, 8), _mm_slli_epi16(a, 8));
+}
+#define sg_rbit_pi32(a) _mm_shufflehi_epi16(_mm_shufflelo_epi16( \
+    sg_sse2_rbit_pi16_(a), sg_sse2_shuffle32_imm(2, 3, 0, 1)), \
+    sg_sse2_shuffle32_imm(2, 3, 0, 1))
+#define sg_rbit_pi64(a) _mm_shufflehi_epi16(_mm_shufflelo_epi16( \
+    sg_sse2_rbit_pi16_(a), sg_sse2_shuffle32_imm(0, 1, 2, 3)), \
+    sg_sse2_shuffle32_imm(0, 1, 2, 3))
+
+#elif defined SIMD_GRANODI_NEON
+#define sg_popcnt_pi32(a) vreinterpretq_s32_u32(vpaddlq_u16(vpaddlq_u8( \
+    vcntq_u8(vreinterpretq_u8_s32(a)))))
+#define sg_popcnt_pi64(a) vreinterpretq_s64_u64(vpaddlq_u32(vpaddlq_u16( \
+    vpaddlq_u8(vcntq_u8(vreinterpretq_u8_s64(a))))))
+#define sg_popcnt_s32x2(a) vreinterpret_s32_u32(vpaddl_u16(vpaddl_u8( \
+    vcnt_u8(vreinterpret_u8_s32(a)))))
+#define sg_clz_pi32 vclzq_s32
+#define sg_clz_s32x2 vclz_s32
+// The count for the upper half, plus the count for the lower half if the
+// upper half is zero
+static inline sg_pi64 sg_vectorcall(sg_clz_pi64)(const sg_pi64 a) {
+    const uint64x2_t halves = vreinterpretq_u64_u32(
+        vclzq_u32(vreinterpretq_u32_s64(a)));
+    const uint64x2_t hi = vshrq_n_u64(halves, 32),
+        lo = vandq_u64(halves, vdupq_n_u64(0xffffffff));
+    return vreinterpretq_s64_u64(vbslq_u64(vceqq_u64(hi, vdupq_n_u64(32)),
+        vaddq_u64(hi, lo), hi));
+}
+#define sg_rbit_pi32(a) vreinterpretq_s32_u8(vrbitq_u8(vrev32q_u8( \
+    vreinterpretq_u8_s32(a))))
+#define sg_rbit_pi64(a) vreinterpretq_s64_u8(vrbitq_u8(vrev64q_u8( \
+    vreinterpretq_u8_s64(a))))
+#define sg_rbit_s32x2(a) vreinterpret_s32_u8(vrbit_u8(vrev32_u8( \
+    vreinterpret_u8_s32(a))))
+#define sg_ctz_pi32(a) vclzq_s32(sg_rbit_pi32(a))
+#define sg_ctz_pi64(a) sg_clz_pi64(sg_rbit_pi64(a))
+#define sg_ctz_s32x2(a) vclz_s32(sg_rbit_s32x2(a))
+#endif
+
+#if defined SIMD_GRANODI_FORCE_GENERIC || defined SIMD_GRANODI_SSE2
+#define sg_popcnt_s32x2 sg_popcnt_generic_s32x2
+#define sg_clz_s32x2 sg_clz_generic_s32x2
+#define sg_ctz_s32x2 sg_ctz_generic_s32x2
+#define sg_rbit_s32x2 sg_rbit_generic_s32x2
+#endif
+
+//
+//
+//
+//
+//
+//
+//
+// Float classification section
+// Scalar versions, used by the generic implementation
+
+static inline float sg_vectorcall(sg_copysign_f32x1)(const float a,
+    const float b)
+{
+    return copysignf(a, b);
+}
+static inline double sg_vectorcall(sg_copysign_f64x1)(const double a,
+    const double b)
+{
+    return copysign(a, b);
+}
+#define sg_signbit_f32x1(a) (sg_bitcast_f32x1_s32x1(a) < 0)
+#define sg_signbit_f64x1(a) (sg_bitcast_f64x1_s64x1(a) < 0)
+static inline bool sg_vectorcall(sg_isnan_f32x1)(const float a) {
+    return a != a;
+}
+static inline bool sg_vectorcall(sg_isnan_f64x1)(const double a) {
+    return a != a;
+}
+#define sg_isinf_f32x1(a) (fabsf(a) == sg_infinity_f32x1)
+#define sg_isinf_f64x1(a) (fabs(a) == sg_infinity_f64x1)
+#define sg_isfinite_f32x1(a) (fabsf(a) < sg_infinity_f32x1)
+#define sg_isfinite_f64x1(a) (fabs(a) < sg_infinity_f64x1)
+// Denormals are tested for using the bits: float comparisons treat them as
+// zero when the CPU is set to do so (see sg_disable_denormals())
+static inline bool sg_vectorcall(sg_isdenormal_f32x1)(const float a) {
+    const uint32_t bits = sg_bitcast_f32x1_u32x1(a);
+    return (bits & 0x7f800000) == 0 && (bits & 0x7fffffff) != 0;
+}
+static inline bool sg_vectorcall(sg_isdenormal_f64x1)(const double a) {
+    const uint64_t bits = sg_bitcast_f64x1_u64x1(a);
+    return (bits & 0x7ff0000000000000) == 0 &&
+        (bits & 0x7fffffffffffffff) != 0;
+}
+
+//
+//
+//
+//
+//
+//
+//
+// Copy sign section
+// sg_copysign_(a, b) gives the magnitude of a with the sign of b
+
+static inline sg_generic_ps sg_vectorcall(sg_copysign_generic_ps)(
+    const sg_generic_ps a, const sg_generic_ps b)
+{
+    sg_generic_ps result;
+    result.f0 = sg_copysign_f32x1(a.f0, b.f0);
+    result.f1 = sg_copysign_f32x1(a.f1, b.f1);
+    result.f2 = sg_copysign_f32x1(a.f2, b.f2);
+    result.f3 = sg_copysign_f32x1(a.f3, b.f3);
+    return result;
+}
+static inline sg_generic_pd sg_vectorcall(sg_copysign_generic_pd)(
+    const sg_generic_pd a, const sg_generic_pd b)
+{
+    sg_generic_pd result;
+    result.d0 = sg_copysign_f64x1(a.d0, b.d0);
+    result.d1 = sg_copysign_f64x1(a.d1, b.d1);
+    return result;
+}
+static inline sg_generic_f32x2 sg_vectorcall(sg_copysign_generic_f32x2)(
+    const sg_generic_f32x2 a, const sg_generic_f32x2 b)
+{
+    sg_generic_f32x2 result;
+    result.f0 = sg_copysign_f32x1(a.f0, b.f0);
+    result.f1 = sg_copysign_f32x1(a.f1, b.f1);
+    return result;
+}
+
+#ifdef SIMD_GRANODI_FORCE_GENERIC
+#define sg_copysign_ps sg_copysign_generic_ps
+#define sg_copysign_pd sg_copysign_generic_pd
+
+#elif defined SIMD_GRANODI_SSE2
+#define sg_copysign_ps(a, b) _mm_or_ps(sg_abs_ps(a), _mm_and_ps(b, \
+    _mm_castsi128_ps(sg_sse2_signbit_ps)))
+#define sg_copysign_pd(a, b) _mm_or_pd(sg_abs_pd(a), _mm_and_pd(b, \
+    _mm_castsi128_pd(sg_sse2_signbit_pd)))
+
+#elif defined SIMD_GRANODI_NEON
+#define sg_copysign_ps(a, b) vbslq_f32(vdupq_n_u32(sg_fp_signmask_s32), a, b)
+#define sg_copysign_pd(a, b) vbslq_f64(vdupq_n_u64(sg_fp_signmask_s64), a, b)
+#define sg_copysign_f32x2(a, b) vbsl_f32(vdup_n_u32(sg_fp_signmask_s32), a, b)
+#endif
+
+#if defined SIMD_GRANODI_FORCE_GENERIC || defined SIMD_GRANODI_SSE2
+#define sg_copysign_f32x2 sg_copysign_generic_f32x2
+#endif
+
+//
+//
+//
+//
+//
+//
+//
+// Classify section
+// Each returns a comparison type. Denormal means subnormal and not zero
+
+static inline sg_generic_cmp4 sg_vectorcall(sg_signbit_generic_ps)(
+    const sg_generic_ps a)
+{
+    sg_generic_cmp4 result;
+    result.b0 = sg_signbit_f32x1(a.f0); result.b1 = sg_signbit_f32x1(a.f1);
+    result.b2 = sg_signbit_f32x1(a.f2); result.b3 = sg_signbit_f32x1(a.f3);
+    return result;
+}
+static inline sg_generic_cmp2 sg_vectorcall(sg_signbit_generic_pd)(
+    const sg_generic_pd a)
+{
+    sg_generic_cmp2 result;
+    result.b0 = sg_signbit_f64x1(a.d0); result.b1 = sg_signbit_f64x1(a.d1);
+    return result;
+}
+static inline sg_generic_cmp2 sg_vectorcall(sg_signbit_generic_f32x2)(
+    const sg_generic_f32x2 a)
+{
+    sg_generic_cmp2 result;
+    result.b0 = sg_signbit_f32x1(a.f0); result.b1 = sg_signbit_f32x1(a.f1);
+    return result;
+}
+static inline sg_generic_cmp4 sg_vectorcall(sg_isnan_generic_ps)(
+    const sg_generic_ps a)
+{
+    sg_generic_cmp4 result;
+    result.b0 = sg_isnan_f32x1(a.f0); result.b1 = sg_isnan_f32x1(a.f1);
+    result.b2 = sg_isnan_f32x1(a.f2); result.b3 = sg_isnan_f32x1(a.f3);
+    return result;
+}
+static inline sg_generic_cmp2 sg_vectorcall(sg_isnan_generic_pd)(
+    const sg_generic_pd a)
+{
+    sg_generic_cmp2 result;
+    result.b0 = sg_isnan_f64x1(a.d0); result.b1 = sg_isnan_f64x1(a.d1);
+    return result;
+}
+static inline sg_generic_cmp2 sg_vectorcall(sg_isnan_generic_f32x2)(
+    const sg_generic_f32x2 a)
+{
+    sg_generic_cmp2 result;
+    result.b0 = sg_isnan_f32x1(a.f0); result.b1 = sg_isnan_f32x1(a.f1);
+    return result;
+}
+static inline sg_generic_cmp4 sg_vectorcall(sg_isinf_generic_ps)(
+    const sg_generic_ps a)
+{
+    sg_generic_cmp4 result;
+    result.b0 = sg_isinf_f32x1(a.f0); result.b1 = sg_isinf_f32x1(a.f1);
+    result.b2 = sg_isinf_f32x1(a.f2); result.b3 = sg_isinf_f32x1(a.f3);
+    return result;
+}
+static inline sg_generic_cmp2 sg_vectorcall(sg_isinf_generic_pd)(
+    const sg_generic_pd a)
+{
+    sg_generic_cmp2 result;
+    result.b0 = sg_isinf_f64x1(a.d0); result.b1 = sg_isinf_f64x1(a.d1);
+    return result;
+}
+static inline sg_generic_cmp2 sg_vectorcall(sg_isinf_generic_f32x2)(
+    const sg_generic_f32x2 a)
+{
+    sg_generic_cmp2 result;
+    result.b0 = sg_isinf_f32x1(a.f0); result.b1 = sg_isinf_f32x1(a.f1);
+    return result;
+}
+static inline sg_generic_cmp4 sg_vectorcall(sg_isfinite_generic_ps)(
+    const sg_generic_ps a)
+{
+    sg_generic_cmp4 result;
+    result.b0 = sg_isfinite_f32x1(a.f0); result.b1 = sg_isfinite_f32x1(a.f1);
+    result.b2 = sg_isfinite_f32x1(a.f2); result.b3 = sg_isfinite_f32x1(a.f3);
+    return result;
+}
+static inline sg_generic_cmp2 sg_vectorcall(sg_isfinite_generic_pd)(
+    const sg_generic_pd a)
+{
+    sg_generic_cmp2 result;
+    result.b0 = sg_isfinite_f64x1(a.d0); result.b1 = sg_isfinite_f64x1(a.d1);
+    return result;
+}
+static inline sg_generic_cmp2 sg_vectorcall(sg_isfinite_generic_f32x2)(
+    const sg_generic_f32x2 a)
+{
+    sg_generic_cmp2 result;
+    result.b0 = sg_isfinite_f32x1(a.f0); result.b1 = sg_isfinite_f32x1(a.f1);
+    return result;
+}
+static inline sg_generic_cmp4 sg_vectorcall(sg_isdenormal_generic_ps)(
+    const sg_generic_ps a)
+{
+    sg_generic_cmp4 result;
+    result.b0 = sg_isdenormal_f32x1(a.f0);
+    result.b1 = sg_isdenormal_f32x1(a.f1);
+    result.b2 = sg_isdenormal_f32x1(a.f2);
+    result.b3 = sg_isdenormal_f32x1(a.f3);
+    return result;
+}
+static inline sg_generic_cmp2 sg_vectorcall(sg_isdenormal_generic_pd)(
+    const sg_generic_pd a)
+{
+    sg_generic_cmp2 result;
+    result.b0 = sg_isdenormal_f64x1(a.d0);
+    result.b1 = sg_isdenormal_f64x1(a.d1);
+    return result;
+}
+static inline sg_generic_cmp2 sg_vectorcall(sg_isdenormal_generic_f32x2)(
+    const sg_generic_f32x2 a)
+{
+    sg_generic_cmp2 result;
+    result.b0 = sg_isdenormal_f32x1(a.f0);
+    result.b1 = sg_isdenormal_f32x1(a.f1);
+    return result;
+}
+
+#ifdef SIMD_GRANODI_FORCE_GENERIC
+#define sg_signbit_ps sg_signbit_generic_ps
+#define sg_signbit_pd sg_signbit_generic_pd
+#define sg_isnan_ps sg_isnan_generic_ps
+#define sg_isnan_pd sg_isnan_generic_pd
+#define sg_isinf_ps sg_isinf_generic_ps
+#define sg_isinf_pd sg_isinf_generic_pd
+#define sg_isfinite_ps sg_isfinite_generic_ps
+#define sg_isfinite_pd sg_isfinite_generic_pd
+#define sg_isdenormal_ps sg_isdenormal_generic_ps
+#define sg_isdenormal_pd sg_isdenormal_generic_pd
+
+#else
+#ifdef SIMD_GRANODI_SSE2
+#define sg_signbit_ps(a) _mm_castsi128_ps(_mm_srai_epi32( \
+    _mm_castps_si128(a), 31))
+#define sg_signbit_pd(a) _mm_castsi128_pd(_mm_srai_epi32(_mm_shuffle_epi32( \
+    _mm_castpd_si128(a), _MM_SHUFFLE(3, 3, 1, 1)), 31))
+
+#elif defined SIMD_GRANODI_NEON
+#define sg_signbit_ps(a) vcltzq_s32(vreinterpretq_s32_f32(a))
+#define sg_signbit_pd(a) vcltzq_s64(vreinterpretq_s64_f64(a))
+#define sg_signbit_f32x2(a) vcltz_s32(vreinterpret_s32_f32(a))
+static inline sg_cmp_f32x2 sg_vectorcall(sg_isnan_f32x2)(const sg_f32x2 a) {
+    return sg_cmpneq_f32x2(a, a);
+}
+#define sg_isinf_f32x2(a) sg_cmpeq_f32x2(sg_abs_f32x2(a), \
+    sg_infinity_f32x2)
+#define sg_isfinite_f32x2(a) sg_cmplt_f32x2(sg_abs_f32x2(a), \
+    sg_infinity_f32x2)
+static inline sg_cmp_f32x2 sg_vectorcall(sg_isdenormal_f32x2)(
+    const sg_f32x2 a)
+{
+    const sg_s32x2 bits = sg_bitcast_f32x2_s32x2(a);
+    return sg_cvtcmp_s32x2_f32x2(sg_and_cmp_s32x2(sg_cmpeq_s32x2(
+            sg_and_s32x2(bits, sg_set1_s32x2(0x7f800000)),
+            sg_setzero_s32x2()),
+        sg_cmpneq_s32x2(sg_and_s32x2(bits, sg_set1_s32x2(0x7fffffff)),
+            sg_setzero_s32x2())));
+}
+#endif
+
+static inline sg_cmp_ps sg_vectorcall(sg_isnan_ps)(const sg_ps a) {
+    return sg_cmpneq_ps(a, a);
+}
+static inline sg_cmp_pd sg_vectorcall(sg_isnan_pd)(const sg_pd a) {
+    return sg_cmpneq_pd(a, a);
+}
+#define sg_isinf_ps(a) sg_cmpeq_ps(sg_abs_ps(a), sg_infinity_ps)
+#define sg_isinf_pd(a) sg_cmpeq_pd(sg_abs_pd(a), sg_infinity_pd)
+#define sg_isfinite_ps(a) sg_cmplt_ps(sg_abs_ps(a), sg_infinity_ps)
+#define sg_isfinite_pd(a) sg_cmplt_pd(sg_abs_pd(a), sg_infinity_pd)
+// Exponent field of zero, and not zero (tested on the bits, as float
+// comparisons treat denormals as zero when denormals are disabled)
+static inline sg_cmp_ps sg_vectorcall(sg_isdenormal_ps)(const sg_ps a) {
+    const sg_pi32 bits = sg_bitcast_ps_pi32(a);
+    return sg_cvtcmp_pi32_ps(sg_and_cmp_pi32(sg_cmpeq_pi32(
+            sg_and_pi32(bits, sg_set1_pi32(0x7f800000)), sg_setzero_pi32()),
+        sg_cmpneq_pi32(sg_and_pi32(bits, sg_set1_pi32(0x7fffffff)),
+            sg_setzero_pi32())));
+}
+static inline sg_cmp_pd sg_vectorcall(sg_isdenormal_pd)(const sg_pd a) {
+    const sg_pi64 bits = sg_bitcast_pd_pi64(a);
+    return sg_cvtcmp_pi64_pd(sg_and_cmp_pi64(sg_cmpeq_pi64(
+            sg_and_pi64(bits, sg_set1_pi64(0x7ff0000000000000)),
+            sg_setzero_pi64()),
+        sg_cmpneq_pi64(sg_and_pi64(bits, sg_set1_pi64(0x7fffffffffffffff)),
+            sg_setzero_pi64())));
+}
+#endif
+
+#if defined SIMD_GRANODI_FORCE_GENERIC || defined SIMD_GRANODI_SSE2
+#define sg_signbit_f32x2 sg_signbit_generic_f32x2
+#define sg_isnan_f32x2 sg_isnan_generic_f32x2
+#define sg_isinf_f32x2 sg_isinf_generic_f32x2
+#define sg_isfinite_f32x2 sg_isfinite_generic_f32x2
+#define sg_isdenormal_f32x2 sg_isdenormal_generic_f32x2
+#endif
+
+//
+//
+//
+//
+//
+//
+//
+// Exponent section
+// sg_frexp_mant_() and sg_frexp_exp_() split a into mant * 2^exp, with |mant|
+// in [0.5, 1), as with frexp(). For zero, infinity and NaN, mant is a, and exp
+// is 0.
+// sg_ldexp_() gives a * 2^n, as with ldexp().
+// sg_ilogb_() gives the unbiased exponent, as with ilogb(), including
+// FP_ILOGB0 for zero, INT32_MAX for infinity and FP_ILOGBNAN for NaN.
+// The exponent type is the integer type with the same element size
+
+static inline float sg_vectorcall(sg_frexp_mant_f32x1)(const float a) {
+    int exp = 0;
+    return frexpf(a, &exp);
+}
+static inline double sg_vectorcall(sg_frexp_mant_f64x1)(const double a) {
+    int exp = 0;
+    return frexp(a, &exp);
+}
+static inline int32_t sg_vectorcall(sg_frexp_exp_f32x1)(const float a) {
+    int exp = 0;
+    frexpf(a, &exp);
+    return sg_isfinite_f32x1(a) ? exp : 0;
+}
+static inline int64_t sg_vectorcall(sg_frexp_exp_f64x1)(const double a) {
+    int exp = 0;
+    frexp(a, &exp);
+    return sg_isfinite_f64x1(a) ? exp : 0;
+}
+static inline float sg_vectorcall(sg_ldexp_f32x1)(const float a,
+    const int32_t n)
+{
+    return ldexpf(a, n);
+}
+static inline double sg_vectorcall(sg_ldexp_f64x1)(const double a,
+    const int64_t n)
+{
+    // Any n outside this range gives 0 or infinity
+    return ldexp(a, (int) (n < -4096 ? -4096 : (n > 4096 ? 4096 : n)));
+}
+static inline int32_t sg_vectorcall(sg_ilogb_f32x1)(const float a) {
+    return ilogbf(a);
+}
+static inline int64_t sg_vectorcall(sg_ilogb_f64x1)(const double a) {
+    return ilogb(a);
+}
+
+static inline sg_generic_ps sg_vectorcall(sg_frexp_mant_generic_ps)(
+    const sg_generic_ps a)
+{
+    sg_generic_ps result;
+    result.f0 = sg_frexp_mant_f32x1(a.f0);
+    result.f1 = sg_frexp_mant_f32x1(a.f1);
+    result.f2 = sg_frexp_mant_f32x1(a.f2);
+    result.f3 = sg_frexp_mant_f32x1(a.f3);
+    return result;
+}
+static inline sg_generic_pd sg_vectorcall(sg_frexp_mant_generic_pd)(
+    const sg_generic_pd a)
+{
+    sg_generic_pd result;
+    result.d0 = sg_frexp_mant_f64x1(a.d0);
+    result.d1 = sg_frexp_mant_f64x1(a.d1);
+    return result;
+}
+static inline sg_generic_f32x2 sg_vectorcall(sg_frexp_mant_generic_f32x2)(
+    const sg_generic_f32x2 a)
+{
+    sg_generic_f32x2 result;
+    result.f0 = sg_frexp_mant_f32x1(a.f0);
+    result.f1 = sg_frexp_mant_f32x1(a.f1);
+    return result;
+}
+static inline sg_generic_pi32 sg_vectorcall(sg_frexp_exp_generic_ps)(
+    const sg_generic_ps a)
+{
+    sg_generic_pi32 result;
+    result.i0 = sg_frexp_exp_f32x1(a.f0);
+    result.i1 = sg_frexp_exp_f32x1(a.f1);
+    result.i2 = sg_frexp_exp_f32x1(a.f2);
+    result.i3 = sg_frexp_exp_f32x1(a.f3);
+    return result;
+}
+static inline sg_generic_pi64 sg_vectorcall(sg_frexp_exp_generic_pd)(
+    const sg_generic_pd a)
+{
+    sg_generic_pi64 result;
+    result.l0 = sg_frexp_exp_f64x1(a.d0);
+    result.l1 = sg_frexp_exp_f64x1(a.d1);
+    return result;
+}
+static inline sg_generic_s32x2 sg_vectorcall(sg_frexp_exp_generic_f32x2)(
+    const sg_generic_f32x2 a)
+{
+    sg_generic_s32x2 result;
+    result.i0 = sg_frexp_exp_f32x1(a.f0);
+    result.i1 = sg_frexp_exp_f32x1(a.f1);
+    return result;
+}
+static inline sg_generic_ps sg_vectorcall(sg_ldexp_generic_ps)(
+    const sg_generic_ps a, const sg_generic_pi32 n)
+{
+    sg_generic_ps result;
+    result.f0 = sg_ldexp_f32x1(a.f0, n.i0);
+    result.f1 = sg_ldexp_f32x1(a.f1, n.i1);
+    result.f2 = sg_ldexp_f32x1(a.f2, n.i2);
+    result.f3 = sg_ldexp_f32x1(a.f3, n.i3);
+    return result;
+}
+static inline sg_generic_pd sg_vectorcall(sg_ldexp_generic_pd)(
+    const sg_generic_pd a, const sg_generic_pi64 n)
+{
+    sg_generic_pd result;
+    result.d0 = sg_ldexp_f64x1(a.d0, n.l0);
+    result.d1 = sg_ldexp_f64x1(a.d1, n.l1);
+    return result;
+}
+static inline sg_generic_f32x2 sg_vectorcall(sg_ldexp_generic_f32x2)(
+    const sg_generic_f32x2 a, const sg_generic_s32x2 n)
+{
+    sg_generic_f32x2 result;
+    result.f0 = sg_ldexp_f32x1(a.f0, n.i0);
+    result.f1 = sg_ldexp_f32x1(a.f1, n.i1);
+    return result;
+}
+static inline sg_generic_pi32 sg_vectorcall(sg_ilogb_generic_ps)(
+    const sg_generic_ps a)
+{
+    sg_generic_pi32 result;
+    result.i0 = sg_ilogb_f32x1(a.f0); result.i1 = sg_ilogb_f32x1(a.f1);
+    result.i2 = sg_ilogb_f32x1(a.f2); result.i3 = sg_ilogb_f32x1(a.f3);
+    return result;
+}
+static inline sg_generic_pi64 sg_vectorcall(sg_ilogb_generic_pd)(
+    const sg_generic_pd a)
+{
+    sg_generic_pi64 result;
+    result.l0 = sg_ilogb_f64x1(a.d0); result.l1 = sg_ilogb_f64x1(a.d1);
+    return result;
+}
+static inline sg_generic_s32x2 sg_vectorcall(sg_ilogb_generic_f32x2)(
+    const sg_generic_f32x2 a)
+{
+    sg_generic_s32x2 result;
+    result.i0 = sg_ilogb_f32x1(a.f0); result.i1 = sg_ilogb_f32x1(a.f1);
+    return result;
+}
+
+#ifdef SIMD_GRANODI_FORCE_GENERIC
+#define sg_frexp_mant_ps sg_frexp_mant_generic_ps
+#define sg_frexp_mant_pd sg_frexp_mant_generic_pd
+#define sg_frexp_exp_ps sg_frexp_exp_generic_ps
+#define sg_frexp_exp_pd sg_frexp_exp_generic_pd
+#define sg_ldexp_ps sg_ldexp_generic_ps
+#define sg_ldexp_pd sg_ldexp_generic_pd
+#define sg_ilogb_ps sg_ilogb_generic_ps
+#define sg_ilogb_pd sg_ilogb_generic_pd
+
+#else
+// SSE2 and NEON, in terms of the functions above. Denormals are scaled up to
+// normal values first (by 2^25 or 2^54), and the scale subtracted from the
+// exponent
+
+// Where a is finite and not zero
+static inline sg_cmp_ps sg_vectorcall(sg_isfinite_nonzero_ps_)(
+    const sg_ps a)
+{
+    return sg_and_cmp_ps(sg_isfinite_ps(a), sg_cmpneq_ps(a, sg_setzero_ps()));
+}
+static inline sg_cmp_pd sg_vectorcall(sg_isfinite_nonzero_pd_)(
+    const sg_pd a)
+{
+    return sg_and_cmp_pd(sg_isfinite_pd(a), sg_cmpneq_pd(a, sg_setzero_pd()));
+}
+static inline sg_ps sg_vectorcall(sg_normalize_ps_)(const sg_ps a) {
+    return sg_choose_ps(sg_isdenormal_ps(a),
+        sg_mul_ps(a, sg_set1_ps(33554432.0f)), a);
+}
+static inline sg_pd sg_vectorcall(sg_normalize_pd_)(const sg_pd a) {
+    return sg_choose_pd(sg_isdenormal_pd(a),
+        sg_mul_pd(a, sg_set1_pd(18014398509481984.0)), a);
+}
+
+static inline sg_ps sg_vectorcall(sg_frexp_mant_ps)(const sg_ps a) {
+    // Replace the exponent bits with those of 0.5
+    const sg_ps mant = sg_or_ps(sg_and_ps(sg_normalize_ps_(a),
+        sg_bitcast_pi32_ps(sg_set1_pi32(~0x7f800000))), sg_set1_ps(0.5f));
+    return sg_choose_ps(sg_isfinite_nonzero_ps_(a), mant, a);
+}
+static inline sg_pd sg_vectorcall(sg_frexp_mant_pd)(const sg_pd a) {
+    const sg_pd mant = sg_or_pd(sg_and_pd(sg_normalize_pd_(a),
+        sg_bitcast_pi64_pd(sg_set1_pi64(~0x7ff0000000000000))),
+        sg_set1_pd(0.5));
+    return sg_choose_pd(sg_isfinite_nonzero_pd_(a), mant, a);
+}
+static inline sg_pi32 sg_vectorcall(sg_frexp_exp_ps)(const sg_ps a) {
+    const sg_pi32 biased = sg_and_pi32(sg_srl_imm_pi32(
+        sg_bitcast_ps_pi32(sg_normalize_ps_(a)), 23), sg_set1_pi32(0xff));
+    const sg_pi32 exp = sg_sub_pi32(biased, sg_choose_pi32(
+        sg_cvtcmp_ps_pi32(sg_isdenormal_ps(a)), sg_set1_pi32(126 + 25),
+        sg_set1_pi32(126)));
+    return sg_choose_else_zero_pi32(sg_cvtcmp_ps_pi32(
+        sg_isfinite_nonzero_ps_(a)), exp);
+}
+static inline sg_pi64 sg_vectorcall(sg_frexp_exp_pd)(const sg_pd a) {
+    const sg_pi64 biased = sg_and_pi64(sg_srl_imm_pi64(
+        sg_bitcast_pd_pi64(sg_normalize_pd_(a)), 52), sg_set1_pi64(0x7ff));
+    const sg_pi64 exp = sg_sub_pi64(biased, sg_choose_pi64(
+        sg_cvtcmp_pd_pi64(sg_isdenormal_pd(a)), sg_set1_pi64(1022 + 54),
+        sg_set1_pi64(1022)));
+    return sg_choose_else_zero_pi64(sg_cvtcmp_pd_pi64(
+        sg_isfinite_nonzero_pd_(a)), exp);
+}
+
+// 2^n, for n in the range of normal exponents
+#define sg_pow2_ps_(n) sg_bitcast_pi32_ps(sg_sl_imm_pi32( \
+    sg_add_pi32(n, sg_set1_pi32(127)), 23))
+#define sg_pow2_pd_(n) sg_bitcast_pi64_pd(sg_sl_imm_pi64( \
+    sg_add_pi64(n, sg_set1_pi64(1023)), 52))
+
+// Multiplies by 2^n in up to 3 steps, so that each power of 2 is normal (as
+// with musl's scalbnf()). Where n is below the normal exponents, the first
+// step is by 2^-102, and the steps after it are by less than 2^-24, so that if
+// the first product is denormal the result correctly rounds to 0. Otherwise
+// only the last multiplication can round
+static inline sg_pi32 sg_vectorcall(sg_ldexp_step_pi32_)(const sg_pi32 n) {
+    return sg_choose_pi32(sg_cmplt_pi32(n, sg_set1_pi32(-126)),
+        sg_set1_pi32(-102),
+        sg_constrain_pi32(sg_set1_pi32(-126), sg_set1_pi32(127), n));
+}
+static inline sg_ps sg_vectorcall(sg_ldexp_ps)(const sg_ps a, const sg_pi32 n)
+{
+    const sg_pi32 n0 = sg_ldexp_step_pi32_(n), r0 = sg_sub_pi32(n, n0);
+    const sg_pi32 n1 = sg_ldexp_step_pi32_(r0);
+    const sg_pi32 n2 = sg_constrain_pi32(sg_set1_pi32(-126),
+        sg_set1_pi32(127), sg_sub_pi32(r0, n1));
+    return sg_mul_ps(sg_mul_ps(sg_mul_ps(a, sg_pow2_ps_(n0)),
+        sg_pow2_ps_(n1)), sg_pow2_ps_(n2));
+}
+#ifdef SIMD_GRANODI_SSE2
+// 64-bit min and max aren't vectorized on SSE2, so n is first saturated to
+// [-2100, 2100] (beyond which the result is 0 or inf anyway), and split using
+// 32-bit lanes. The low words of n are in lanes 0 and 1
+#define sg_pow2_pd_pi32_(n) _mm_castsi128_pd(_mm_slli_epi64( \
+    _mm_unpacklo_epi32(sg_add_pi32(n, sg_set1_pi32(1023)), \
+        _mm_setzero_si128()), 52))
+static inline sg_pi32 sg_vectorcall(sg_ldexp_step_pd_pi32_)(const sg_pi32 n) {
+    return sg_choose_pi32(sg_cmplt_pi32(n, sg_set1_pi32(-1022)),
+        sg_set1_pi32(-969),
+        sg_constrain_pi32(sg_set1_pi32(-1022), sg_set1_pi32(1023), n));
+}
+static inline sg_pd sg_vectorcall(sg_ldexp_pd)(const sg_pd a, const sg_pi64 n)
+{
+    const sg_pi32 lo = _mm_shuffle_epi32(n, _MM_SHUFFLE(3, 1, 2, 0)),
+        hi = _mm_shuffle_epi32(n, _MM_SHUFFLE(3, 1, 3, 1));
+    // Where n doesn't fit in 32 bits, saturate according to its sign
+    const sg_pi32 n32 = sg_choose_pi32(
+        sg_cmpeq_pi32(hi, sg_sra_imm_pi32(lo, 31)),
+        sg_constrain_pi32(sg_set1_pi32(-2100), sg_set1_pi32(2100), lo),
+        sg_choose_pi32(sg_cmplt_pi32(hi, sg_setzero_pi32()),
+            sg_set1_pi32(-2100), sg_set1_pi32(2100)));
+    const sg_pi32 n0 = sg_ldexp_step_pd_pi32_(n32),
+        r0 = sg_sub_pi32(n32, n0);
+    const sg_pi32 n1 = sg_ldexp_step_pd_pi32_(r0);
+    const sg_pi32 n2 = sg_constrain_pi32(sg_set1_pi32(-1022),
+        sg_set1_pi32(1023), sg_sub_pi32(r0, n1));
+    return sg_mul_pd(sg_mul_pd(sg_mul_pd(a, sg_pow2_pd_pi32_(n0)),
+        sg_pow2_pd_pi32_(n1)), sg_pow2_pd_pi32_(n2));
+}
+#else
+static inline sg_pi64 sg_vectorcall(sg_ldexp_step_pi64_)(const sg_pi64 n) {
+    return sg_choose_pi64(sg_cmplt_pi64(n, sg_set1_pi64(-1022)),
+        sg_set1_pi64(-969),
+        sg_constrain_pi64(sg_set1_pi64(-1022), sg_set1_pi64(1023), n));
+}
+static inline sg_pd sg_vectorcall(sg_ldexp_pd)(const sg_pd a, const sg_pi64 n)
+{
+    const sg_pi64 n0 = sg_ldexp_step_pi64_(n), r0 = sg_sub_pi64(n, n0);
+    const sg_pi64 n1 = sg_ldexp_step_pi64_(r0);
+    const sg_pi64 n2 = sg_constrain_pi64(sg_set1_pi64(-1022),
+        sg_set1_pi64(1023), sg_sub_pi64(r0, n1));
+    return sg_mul_pd(sg_mul_pd(sg_mul_pd(a, sg_pow2_pd_(n0)),
+        sg_pow2_pd_(n1)), sg_pow2_pd_(n2));
+}
+#endif
+
+static inline sg_pi32 sg_vectorcall(sg_ilogb_ps)(const sg_ps a) {
+    return sg_choose_pi32(sg_cvtcmp_ps_pi32(sg_isfinite_nonzero_ps_(a)),
+        sg_sub_pi32(sg_frexp_exp_ps(a), sg_set1_pi32(1)),
+        sg_choose_pi32(sg_cvtcmp_ps_pi32(sg_isinf_ps(a)),
+            sg_set1_pi32(INT32_MAX), sg_choose_pi32(sg_cvtcmp_ps_pi32(
+                sg_isnan_ps(a)), sg_set1_pi32(FP_ILOGBNAN),
+                sg_set1_pi32(FP_ILOGB0))));
+}
+static inline sg_pi64 sg_vectorcall(sg_ilogb_pd)(const sg_pd a) {
+    return sg_choose_pi64(sg_cvtcmp_pd_pi64(sg_isfinite_nonzero_pd_(a)),
+        sg_sub_pi64(sg_frexp_exp_pd(a), sg_set1_pi64(1)),
+        sg_choose_pi64(sg_cvtcmp_pd_pi64(sg_isinf_pd(a)),
+            sg_set1_pi64(INT32_MAX), sg_choose_pi64(sg_cvtcmp_pd_pi64(
+                sg_isnan_pd(a)), sg_set1_pi64(FP_ILOGBNAN),
+                sg_set1_pi64(FP_ILOGB0))));
+}
+#endif
+
+#ifdef SIMD_GRANODI_NEON
+static inline sg_cmp_f32x2 sg_vectorcall(sg_isfinite_nonzero_f32x2_)(
+    const sg_f32x2 a)
+{
+    return sg_and_cmp_f32x2(sg_isfinite_f32x2(a),
+        sg_cmpneq_f32x2(a, sg_setzero_f32x2()));
+}
+static inline sg_f32x2 sg_vectorcall(sg_normalize_f32x2_)(const sg_f32x2 a) {
+    return sg_choose_f32x2(sg_isdenormal_f32x2(a),
+        sg_mul_f32x2(a, sg_set1_f32x2(33554432.0f)), a);
+}
+#define sg_pow2_f32x2_(n) sg_bitcast_s32x2_f32x2(sg_sl_imm_s32x2( \
+    sg_add_s32x2(n, sg_set1_s32x2(127)), 23))
+
+static inline sg_f32x2 sg_vectorcall(sg_frexp_mant_f32x2)(const sg_f32x2 a) {
+    const sg_f32x2 mant = sg_or_f32x2(sg_and_f32x2(sg_normalize_f32x2_(a),
+        sg_bitcast_s32x2_f32x2(sg_set1_s32x2(~0x7f800000))),
+        sg_set1_f32x2(0.5f));
+    return sg_choose_f32x2(sg_isfinite_nonzero_f32x2_(a), mant, a);
+}
+static inline sg_s32x2 sg_vectorcall(sg_frexp_exp_f32x2)(const sg_f32x2 a) {
+    const sg_s32x2 biased = sg_and_s32x2(sg_srl_imm_s32x2(
+        sg_bitcast_f32x2_s32x2(sg_normalize_f32x2_(a)), 23),
+        sg_set1_s32x2(0xff));
+    const sg_s32x2 exp = sg_sub_s32x2(biased, sg_choose_s32x2(
+        sg_cvtcmp_f32x2_s32x2(sg_isdenormal_f32x2(a)),
+        sg_set1_s32x2(126 + 25), sg_set1_s32x2(126)));
+    return sg_choose_else_zero_s32x2(sg_cvtcmp_f32x2_s32x2(
+        sg_isfinite_nonzero_f32x2_(a)), exp);
+}
+static inline sg_f32x2 sg_vectorcall(sg_ldexp_f32x2)(const sg_f32x2 a,
+    const sg_s32x2 n)
+{
+    // As with sg_ldexp_ps()
+    const sg_s32x2 n0 = sg_choose_s32x2(sg_cmplt_s32x2(n, sg_set1_s32x2(-126)),
+        sg_set1_s32x2(-102),
+        sg_constrain_s32x2(sg_set1_s32x2(-126), sg_set1_s32x2(127), n));
+    const sg_s32x2 r0 = sg_sub_s32x2(n, n0);
+    const sg_s32x2 n1 = sg_choose_s32x2(
+        sg_cmplt_s32x2(r0, sg_set1_s32x2(-126)), sg_set1_s32x2(-102),
+        sg_constrain_s32x2(sg_set1_s32x2(-126), sg_set1_s32x2(127), r0));
+    const sg_s32x2 n2 = sg_constrain_s32x2(sg_set1_s32x2(-126),
+        sg_set1_s32x2(127), sg_sub_s32x2(r0, n1));
+    return sg_mul_f32x2(sg_mul_f32x2(sg_mul_f32x2(a, sg_pow2_f32x2_(n0)),
+        sg_pow2_f32x2_(n1)), sg_pow2_f32x2_(n2));
+}
+static inline sg_s32x2 sg_vectorcall(sg_ilogb_f32x2)(const sg_f32x2 a) {
+    return sg_choose_s32x2(sg_cvtcmp_f32x2_s32x2(
+            sg_isfinite_nonzero_f32x2_(a)),
+        sg_sub_s32x2(sg_frexp_exp_f32x2(a), sg_set1_s32x2(1)),
+        sg_choose_s32x2(sg_cvtcmp_f32x2_s32x2(sg_isinf_f32x2(a)),
+            sg_set1_s32x2(INT32_MAX), sg_choose_s32x2(sg_cvtcmp_f32x2_s32x2(
+                sg_isnan_f32x2(a)), sg_set1_s32x2(FP_ILOGBNAN),
+                sg_set1_s32x2(FP_ILOGB0))));
+}
+
+#else
+#define sg_frexp_mant_f32x2 sg_frexp_mant_generic_f32x2
+#define sg_frexp_exp_f32x2 sg_frexp_exp_generic_f32x2
+#define sg_ldexp_f32x2 sg_ldexp_generic_f32x2
+#define sg_ilogb_f32x2 sg_ilogb_generic_f32x2
+#endif
+
+//
+//
+//
+//
+//
+//
+//
+// Denormal section
+// sg_flush_denormals_() replaces denormal elements with zero (of the same
+// sign), without changing the floating point mode of the CPU. Elements with an
+// exponent field of zero keep only their sign bit
+
+static inline sg_ps sg_vectorcall(sg_flush_denormals_ps)(const sg_ps a) {
+    return sg_choose_ps(sg_cvtcmp_pi32_ps(sg_cmpeq_pi32(sg_and_pi32(
+            sg_bitcast_ps_pi32(a), sg_set1_pi32(0x7f800000)),
+            sg_setzero_pi32())),
+        sg_and_ps(a, sg_set1_ps(-0.0f)), a);
+}
+static inline sg_pd sg_vectorcall(sg_flush_denormals_pd)(const sg_pd a) {
+    return sg_choose_pd(sg_cvtcmp_pi64_pd(sg_cmpeq_pi64(sg_and_pi64(
+            sg_bitcast_pd_pi64(a), sg_set1_pi64(0x7ff0000000000000)),
+            sg_setzero_pi64())),
+        sg_and_pd(a, sg_set1_pd(-0.0)), a);
+}
+static inline sg_f32x2 sg_vectorcall(sg_flush_denormals_f32x2)(
+    const sg_f32x2 a)
+{
+    return sg_choose_f32x2(sg_cvtcmp_s32x2_f32x2(sg_cmpeq_s32x2(sg_and_s32x2(
+            sg_bitcast_f32x2_s32x2(a), sg_set1_s32x2(0x7f800000)),
+            sg_setzero_s32x2())),
+        sg_and_f32x2(a, sg_set1_f32x2(-0.0f)), a);
+}
+static inline float sg_vectorcall(sg_flush_denormals_f32x1)(const float a) {
+    return sg_isdenormal_f32x1(a) ? sg_copysign_f32x1(0.0f, a) : a;
+}
+static inline double sg_vectorcall(sg_flush_denormals_f64x1)(const double a)
+{
+    return sg_isdenormal_f64x1(a) ? sg_copysign_f64x1(0.0, a) : a;
+}
+
+// Floating point mode of the current thread: MXCSR on SSE, FPCR on ARM64 and
+// FPSCR on ARM32. Elsewhere this is always 0, and setting it does nothing.
+// sg_disable_denormals() flushes denormal results (and, on SSE, inputs) to
+// zero, and returns the previous mode, to be restored with sg_set_fp_mode().
+// This is selected by architecture, not implementation, so it also affects
+// SIMD_GRANODI_FORCE_GENERIC builds
+typedef uint64_t sg_fp_mode;
+
+#ifdef SIMD_GRANODI_ARCH_SSE
+// Flush to zero (FTZ) and denormals are zero (DAZ)
+#define sg_fp_mode_flush_denormals_bits_ 0x8040
+
+static inline sg_fp_mode sg_get_fp_mode(void) {
+    return (sg_fp_mode) _mm_getcsr();
+}
+static inline void sg_set_fp_mode(const sg_fp_mode mode) {
+    _mm_setcsr((unsigned int) mode);
+}
+
+#elif (defined SIMD_GRANODI_ARCH_ARM64 || defined SIMD_GRANODI_ARCH_ARM32) \
+    && (defined __GNUC__ || defined __clang__)
+// Flush to zero (FZ)
+#define sg_fp_mode_flush_denormals_bits_ (1 << 24)
+
+#ifdef SIMD_GRANODI_ARCH_ARM64
+static inline sg_fp_mode sg_get_fp_mode(void) {
+    uint64_t mode;
+    __asm__ __volatile__ ("mrs %0, fpcr" : "=r" (mode));
+    return mode;
+}
+static inline void sg_set_fp_mode(const sg_fp_mode mode) {
+    __asm__ __volatile__ ("msr fpcr, %0" : : "r" (mode));
+}
+#else
+static inline sg_fp_mode sg_get_fp_mode(void) {
+    uint32_t mode;
+    __asm__ __volatile__ ("vmrs %0, fpscr" : "=r" (mode));
+    return mode;
+}
+static inline void sg_set_fp_mode(const sg_fp_mode mode) {
+    __asm__ __volatile__ ("vmsr fpscr, %0" : : "r" ((uint32_t) mode));
+}
+#endif
+
+#else
+#define sg_fp_mode_flush_denormals_bits_ 0
+
+static inline sg_fp_mode sg_get_fp_mode(void) { return 0; }
+static inline void sg_set_fp_mode(const sg_fp_mode mode) { (void) mode; }
+#endif
+
+static inline sg_fp_mode sg_disable_denormals(void) {
+    const sg_fp_mode prev = sg_get_fp_mode();
+    sg_set_fp_mode(prev | sg_fp_mode_flush_denormals_bits_);
+    return prev;
+}
+
+#ifdef __cplusplus
+
+namespace simd_granodi {
+
+// C++ classes for operator overloading:
+// - Have no setters, but can be changed via += etc (semi-immutable)
+// - Are default constructed to zero
+// - All type casts or type conversions must be explicit
+// - Should never use any SSE2 or NEON types or intrinsics directly
+
+class Compare_pi32; class Compare_pi64; class Compare_ps; class Compare_pd;
+class Compare_s32x2; class Compare_f32x2;
+class Vec_pi32; class Vec_pi64; class Vec_ps; class Vec_pd;
+class Vec_s32x2; class Vec_f32x2;
+
+// Shim types - for using double / float etc in template code that expects
+// a vector type
+class Vec_s32x1; class Vec_s64x1; class Vec_f32x1; class Vec_f64x1;
+
+template <typename From, typename To>
+inline To sg_vectorcall(sg_convert)(const From x) = delete;
+
+template <typename From, typename To>
+inline To sg_vectorcall(sg_convert_nearest)(const From x) = delete;
+
+template <typename From, typename To>
+inline To sg_vectorcall(sg_convert_truncate)(const From x) = delete;
+
+template <typename From, typename To>
+inline To sg_vectorcall(sg_convert_floor)(const From x) = delete;
+
+template <typename From, typename To>
+inline To sg_vectorcall(sg_bitcast)(const From x) = delete;
+
+class Compare_pi32 {
+    sg_cmp_pi32 data_;
+public:
+    Compare_pi32() : data_{sg_setzero_cmp_pi32()} {}
+    Compare_pi32(const bool b) : data_{sg_set1cmp_pi32(b)} {}
+    Compare_pi32(const bool b3, const bool b2, const bool b1,
+        const bool b0)
+        : data_{sg_setcmp_pi32(b3, b2, b1, b0)} {}
+    Compare_pi32(const sg_cmp_pi32 cmp) : data_{cmp} {}
+    #ifndef SIMD_GRANODI_FORCE_GENERIC
+    Compare_pi32(const sg_generic_cmp4 cmp)
+        : data_{sg_from_generic_cmp_pi32(cmp)} {}
+    #endif
+
+    sg_cmp_pi32 sg_vectorcall(data)() const { return data_; }
+
+    Compare_pi32 sg_vectorcall(operator&&)(const Compare_pi32 rhs) const {
+        return sg_and_cmp_pi32(data_, rhs.data());
+    }
+
+    Compare_pi32 sg_vectorcall(operator||)(const Compare_pi32 rhs) const {
+        return sg_or_cmp_pi32(data_, rhs.data());
+    }
+
+    Compare_pi32 sg_vectorcall(operator!)() const {
+        return sg_not_cmp_pi32(data_);
+    }
+    int32_t sg_vectorcall(movemask)() const {
+        return sg_movemask_cmp_pi32(data_);
+    }
+
+    bool sg_vectorcall(debug_valid_eq)(const bool b3, const bool b2,
+        const bool b1, const bool b0) const
+    {
+        return sg_debug_cmp_valid_eq_pi32(data_, b3, b2, b1, b0);
+    }
+    bool sg_vectorcall(debug_valid_eq)(const bool b) const {
+        return debug_valid_eq(b, b, b, b);
+    }
+
+    template <typename To>
+    To sg_vectorcall(to)() const { return sg_convert<Compare_pi32, To>(*this); }
+
+    template <typename From>
+    static Compare_pi32 sg_vectorcall(from)(const From x) {
+        return sg_convert<From, Compare_pi32>(x);
+    }
+
+    inline Vec_pi32 sg_vectorcall(choose_else_zero)(const Vec_pi32 if_true)
+        const;
+    inline Vec_pi32 sg_vectorcall(choose)(const Vec_pi32 if_true,
+        const Vec_pi32 if_false) const;
+};
+
+inline Compare_pi32 sg_vectorcall(operator==)(const Compare_pi32 lhs,
+    const Compare_pi32 rhs)
+{
+    return sg_cmpeq_cmp_pi32(lhs.data(), rhs.data());
+}
+inline Compare_pi32 sg_vectorcall(operator!=)(const Compare_pi32 lhs,
+    const Compare_pi32 rhs)
+{
+    return sg_cmpneq_cmp_pi32(lhs.data(), rhs.data());
+}
+
+typedef Compare_pi32 Compare_s32x4;
 
 class Compare_pi64 {
     sg_cmp_pi64 data_;
@@ -7399,6 +9566,9 @@ public:
     Compare_pi64 sg_vectorcall(operator!)() const {
         return sg_not_cmp_pi64(data_);
     }
+    int32_t sg_vectorcall(movemask)() const {
+        return sg_movemask_cmp_pi64(data_);
+    }
 
     bool sg_vectorcall(debug_valid_eq)(const bool b1, const bool b0) const {
         return sg_debug_cmp_valid_eq_pi64(data_, b1, b0);
@@ -7460,6 +9630,9 @@ public:
     }
 
     Compare_ps sg_vectorcall(operator!)() const { return sg_not_cmp_ps(data_); }
+    int32_t sg_vectorcall(movemask)() const {
+        return sg_movemask_cmp_ps(data_);
+    }
 
     bool sg_vectorcall(debug_valid_eq)(const bool b3, const bool b2,
         const bool b1, const bool b0) const
@@ -7520,6 +9693,9 @@ public:
     }
 
     Compare_pd sg_vectorcall(operator!)() const { return sg_not_cmp_pd(data_); }
+    int32_t sg_vectorcall(movemask)() const {
+        return sg_movemask_cmp_pd(data_);
+    }
 
     bool sg_vectorcall(debug_valid_eq)(const bool b1, const bool b0) const {
         return sg_debug_cmp_valid_eq_pd(data_, b1, b0);
@@ -7580,6 +9756,9 @@ public:
     Compare_s32x2 sg_vectorcall(operator!)() const {
         return sg_not_cmp_s32x2(data_);
     }
+    int32_t sg_vectorcall(movemask)() const {
+        return sg_movemask_cmp_s32x2(data_);
+    }
 
     bool sg_vectorcall(debug_valid_eq)(const bool b1, const bool b0) const
     {
@@ -7640,6 +9819,9 @@ public:
     Compare_f32x2 sg_vectorcall(operator!)() const {
         return sg_not_cmp_f32x2(data_);
     }
+    int32_t sg_vectorcall(movemask)() const {
+        return sg_movemask_cmp_f32x2(data_);
+    }
 
     bool sg_vectorcall(debug_valid_eq)(const bool b1, const bool b0) const
     {
@@ -7729,10 +9911,10 @@ public:
     static constexpr std::size_t elem_size = sizeof(int32_t),
         elem_count = 4;
 
-    static Vec_pi32 sg_vectorcall(loadu)(int32_t *const i) {
+    static Vec_pi32 sg_vectorcall(loadu)(const int32_t *const i) {
         return sg_loadu_pi32(i);
     }
-    static Vec_pi32 sg_vectorcall(load)(int32_t *const i) {
+    static Vec_pi32 sg_vectorcall(load)(const int32_t *const i) {
         return sg_load_pi32(i);
     }
     void sg_vectorcall(storeu)(int32_t *const i) const {
@@ -7939,6 +10121,60 @@ public:
     static Vec_pi32 sg_vectorcall(max)(const Vec_pi32 a, const Vec_pi32 b) {
         return sg_max_pi32(a.data(), b.data());
     }
+    int32_t sg_vectorcall(reduce_add)() const {
+        return sg_reduce_add_pi32(data_);
+    }
+    int32_t sg_vectorcall(reduce_min)() const {
+        return sg_reduce_min_pi32(data_);
+    }
+    int32_t sg_vectorcall(reduce_max)() const {
+        return sg_reduce_max_pi32(data_);
+    }
+    // Element i is the sum of elements 0 to i
+    Vec_pi32 sg_vectorcall(prefix_sum)() const {
+        return sg_prefix_sum_pi32(data_);
+    }
+    Vec_pi32 sg_vectorcall(adds)(const Vec_pi32 rhs) const {
+        return sg_adds_pi32(data_, rhs.data());
+    }
+    Vec_pi32 sg_vectorcall(subs)(const Vec_pi32 rhs) const {
+        return sg_subs_pi32(data_, rhs.data());
+    }
+    // Q31 fixed point multiply: the high 32 bits of 2*this*rhs, rounded and
+    // saturated
+    Vec_pi32 sg_vectorcall(qrdmulh)(const Vec_pi32 rhs) const {
+        return sg_qrdmulh_pi32(data_, rhs.data());
+    }
+    // High 32 bits of the 64-bit product, signed or unsigned
+    Vec_pi32 sg_vectorcall(mulhi)(const Vec_pi32 rhs) const {
+        return sg_mulhi_pi32(data_, rhs.data());
+    }
+    Vec_pi32 sg_vectorcall(mulhi_unsigned)(const Vec_pi32 rhs) const {
+        return sg_mulhi_pu32(data_, rhs.data());
+    }
+    // Full 64-bit products of elements 0 and 2
+    Vec_pi64 sg_vectorcall(mul_wide_even)(const Vec_pi32 rhs) const;
+    // Stores the elements of this then hi as 8 x int16_t, saturated
+    void sg_vectorcall(storeu_sat16)(int16_t *const s, const Vec_pi32 hi) const
+    {
+        sg_storeu_sat16_pi32(s, data_, hi.data());
+    }
+    // Bit counts are in each element, and clz() and ctz() give the element
+    // width for zero
+    Vec_pi32 sg_vectorcall(popcount)() const { return sg_popcnt_pi32(data_); }
+    Vec_pi32 sg_vectorcall(clz)() const { return sg_clz_pi32(data_); }
+    Vec_pi32 sg_vectorcall(ctz)() const { return sg_ctz_pi32(data_); }
+    Vec_pi32 sg_vectorcall(reverse_bits)() const { return sg_rbit_pi32(data_); }
+    static void sg_vectorcall(transpose)(Vec_pi32& r0, Vec_pi32& r1,
+        Vec_pi32& r2, Vec_pi32& r3)
+    {
+        sg_pi32 a0 = r0.data(), a1 = r1.data(), a2 = r2.data(), a3 = r3.data();
+        sg_transpose4_pi32(&a0, &a1, &a2, &a3);
+        r0 = a0; r1 = a1; r2 = a2; r3 = a3;
+    }
+    Vec_pi32 sg_vectorcall(compress)(const Compare_pi32 keep) const {
+        return sg_compress_pi32(data_, keep.data());
+    }
 
     bool sg_vectorcall(debug_eq)(const int32_t i3, const int32_t i2,
         const int32_t i1, const int32_t i0) const
@@ -8021,10 +10257,10 @@ public:
     static constexpr std::size_t elem_size = sizeof(int64_t),
         elem_count = 2;
 
-    static Vec_pi64 sg_vectorcall(loadu)(int64_t *const l) {
+    static Vec_pi64 sg_vectorcall(loadu)(const int64_t *const l) {
         return sg_loadu_pi64(l);
     }
-    static Vec_pi64 sg_vectorcall(load)(int64_t *const l) {
+    static Vec_pi64 sg_vectorcall(load)(const int64_t *const l) {
         return sg_load_pi64(l);
     }
     void sg_vectorcall(storeu)(int64_t *const l) const {
@@ -8221,6 +10457,43 @@ public:
     static Vec_pi64 sg_vectorcall(max)(const Vec_pi64 a, const Vec_pi64 b) {
         return sg_max_pi64(a.data(), b.data());
     }
+    int64_t sg_vectorcall(reduce_add)() const {
+        return sg_reduce_add_pi64(data_);
+    }
+    int64_t sg_vectorcall(reduce_min)() const {
+        return sg_reduce_min_pi64(data_);
+    }
+    int64_t sg_vectorcall(reduce_max)() const {
+        return sg_reduce_max_pi64(data_);
+    }
+    // Element i is the sum of elements 0 to i
+    Vec_pi64 sg_vectorcall(prefix_sum)() const {
+        return sg_prefix_sum_pi64(data_);
+    }
+    Vec_pi64 sg_vectorcall(adds)(const Vec_pi64 rhs) const {
+        return sg_adds_pi64(data_, rhs.data());
+    }
+    Vec_pi64 sg_vectorcall(subs)(const Vec_pi64 rhs) const {
+        return sg_subs_pi64(data_, rhs.data());
+    }
+    // As to<Vec_pi32>(), but clamping each element to the int32_t range
+    Vec_pi32 sg_vectorcall(narrow_sat)() const {
+        return sg_cvtsat_pi64_pi32(data_);
+    }
+    Vec_pi64 sg_vectorcall(mulhi)(const Vec_pi64 rhs) const {
+        return sg_mulhi_pi64(data_, rhs.data());
+    }
+    // Bit counts are in each element, and clz() and ctz() give the element
+    // width for zero
+    Vec_pi64 sg_vectorcall(popcount)() const { return sg_popcnt_pi64(data_); }
+    Vec_pi64 sg_vectorcall(clz)() const { return sg_clz_pi64(data_); }
+    Vec_pi64 sg_vectorcall(ctz)() const { return sg_ctz_pi64(data_); }
+    Vec_pi64 sg_vectorcall(reverse_bits)() const { return sg_rbit_pi64(data_); }
+    static void sg_vectorcall(transpose)(Vec_pi64& r0, Vec_pi64& r1) {
+        sg_pi64 a0 = r0.data(), a1 = r1.data();
+        sg_transpose2_pi64(&a0, &a1);
+        r0 = a0; r1 = a1;
+    }
 
     bool sg_vectorcall(debug_eq)(const int64_t l1, const int64_t l0) const {
         return sg_debug_eq_pi64(data_, l1, l0);
@@ -8253,6 +10526,13 @@ public:
 
 typedef Vec_pi64 Vec_s64x2;
 
+// Defined here, as it needs the complete Vec_pi64
+inline Vec_pi64 sg_vectorcall(Vec_pi32::mul_wide_even)(const Vec_pi32 rhs)
+    const
+{
+    return sg_mul_wide_even_pi32(data_, rhs.data());
+}
+
 template <> inline int64_t sg_vectorcall(Vec_pi64::get<0>)() const {
     return sg_get0_pi64(data_);
 }
@@ -8299,10 +10579,10 @@ public:
     static constexpr std::size_t elem_size = sizeof(float),
         elem_count = 4;
 
-    static Vec_ps sg_vectorcall(loadu)(float *const f) {
+    static Vec_ps sg_vectorcall(loadu)(const float *const f) {
         return sg_loadu_ps(f);
     }
-    static Vec_ps sg_vectorcall(load)(float *const f) {
+    static Vec_ps sg_vectorcall(load)(const float *const f) {
         return sg_load_ps(f);
     }
     void sg_vectorcall(storeu)(float *const f) const {
@@ -8453,6 +10733,30 @@ public:
         return sg_safediv_ps(data_, rhs.data());
     }
     Vec_ps sg_vectorcall(abs)() const { return sg_abs_ps(data_); }
+    Vec_ps sg_vectorcall(sqrt)() const { return sg_sqrt_ps(data_); }
+    Vec_ps sg_vectorcall(copysign)(const Vec_ps sign) const {
+        return sg_copysign_ps(data_, sign.data());
+    }
+    Compare_ps sg_vectorcall(signbit)() const { return sg_signbit_ps(data_); }
+    Compare_ps sg_vectorcall(is_nan)() const { return sg_isnan_ps(data_); }
+    Compare_ps sg_vectorcall(is_inf)() const { return sg_isinf_ps(data_); }
+    Compare_ps sg_vectorcall(is_finite)() const {
+        return sg_isfinite_ps(data_);
+    }
+    Compare_ps sg_vectorcall(is_denormal)() const {
+        return sg_isdenormal_ps(data_);
+    }
+    Vec_ps sg_vectorcall(flush_denormals)() const {
+        return sg_flush_denormals_ps(data_);
+    }
+    Vec_ps sg_vectorcall(frexp)(Vec_pi32& exp) const {
+        exp = sg_frexp_exp_ps(data_);
+        return sg_frexp_mant_ps(data_);
+    }
+    Vec_ps sg_vectorcall(ldexp)(const Vec_pi32 n) const {
+        return sg_ldexp_ps(data_, n.data());
+    }
+    Vec_pi32 sg_vectorcall(ilogb)() const { return sg_ilogb_ps(data_); }
     Vec_ps sg_vectorcall(remove_signed_zero)() const {
         return sg_remove_signed_zero_ps(data_);
     }
@@ -8468,6 +10772,29 @@ public:
     static Vec_ps sg_vectorcall(max)(const Vec_ps a, const Vec_ps b) {
         return sg_max_ps(a.data(), b.data());
     }
+    float sg_vectorcall(reduce_add)() const {
+        return sg_reduce_add_ps(data_);
+    }
+    float sg_vectorcall(reduce_min)() const {
+        return sg_reduce_min_ps(data_);
+    }
+    float sg_vectorcall(reduce_max)() const {
+        return sg_reduce_max_ps(data_);
+    }
+    // Element i is the sum of elements 0 to i
+    Vec_ps sg_vectorcall(prefix_sum)() const {
+        return sg_prefix_sum_ps(data_);
+    }
+    static void sg_vectorcall(transpose)(Vec_ps& r0, Vec_ps& r1,
+        Vec_ps& r2, Vec_ps& r3)
+    {
+        sg_ps a0 = r0.data(), a1 = r1.data(), a2 = r2.data(), a3 = r3.data();
+        sg_transpose4_ps(&a0, &a1, &a2, &a3);
+        r0 = a0; r1 = a1; r2 = a2; r3 = a3;
+    }
+    Vec_ps sg_vectorcall(compress)(const Compare_ps keep) const {
+        return sg_compress_ps(data_, keep.data());
+    }
 
     bool sg_vectorcall(debug_eq)(const float f3, const float f2, const float f1,
         const float f0) const
@@ -8605,10 +10932,10 @@ public:
     static constexpr size_t elem_size = sizeof(double),
         elem_count = 2;
 
-    static Vec_pd sg_vectorcall(loadu)(double *const d) {
+    static Vec_pd sg_vectorcall(loadu)(const double *const d) {
         return sg_loadu_pd(d);
     }
-    static Vec_pd sg_vectorcall(load)(double *const d) {
+    static Vec_pd sg_vectorcall(load)(const double *const d) {
         return sg_load_pd(d);
     }
     void sg_vectorcall(storeu)(double *const d) const {
@@ -8749,6 +11076,30 @@ public:
         return sg_safediv_pd(data_, rhs.data());
     }
     Vec_pd sg_vectorcall(abs)() const { return sg_abs_pd(data_); }
+    Vec_pd sg_vectorcall(sqrt)() const { return sg_sqrt_pd(data_); }
+    Vec_pd sg_vectorcall(copysign)(const Vec_pd sign) const {
+        return sg_copysign_pd(data_, sign.data());
+    }
+    Compare_pd sg_vectorcall(signbit)() const { return sg_signbit_pd(data_); }
+    Compare_pd sg_vectorcall(is_nan)() const { return sg_isnan_pd(data_); }
+    Compare_pd sg_vectorcall(is_inf)() const { return sg_isinf_pd(data_); }
+    Compare_pd sg_vectorcall(is_finite)() const {
+        return sg_isfinite_pd(data_);
+    }
+    Compare_pd sg_vectorcall(is_denormal)() const {
+        return sg_isdenormal_pd(data_);
+    }
+    Vec_pd sg_vectorcall(flush_denormals)() const {
+        return sg_flush_denormals_pd(data_);
+    }
+    Vec_pd sg_vectorcall(frexp)(Vec_pi64& exp) const {
+        exp = sg_frexp_exp_pd(data_);
+        return sg_frexp_mant_pd(data_);
+    }
+    Vec_pd sg_vectorcall(ldexp)(const Vec_pi64 n) const {
+        return sg_ldexp_pd(data_, n.data());
+    }
+    Vec_pi64 sg_vectorcall(ilogb)() const { return sg_ilogb_pd(data_); }
     Vec_pd sg_vectorcall(remove_signed_zero)() const {
         return sg_remove_signed_zero_pd(data_);
     }
@@ -8764,6 +11115,24 @@ public:
     static Vec_pd sg_vectorcall(max)(const Vec_pd a, const Vec_pd b) {
         return sg_max_pd(a.data(), b.data());
     }
+    double sg_vectorcall(reduce_add)() const {
+        return sg_reduce_add_pd(data_);
+    }
+    double sg_vectorcall(reduce_min)() const {
+        return sg_reduce_min_pd(data_);
+    }
+    double sg_vectorcall(reduce_max)() const {
+        return sg_reduce_max_pd(data_);
+    }
+    // Element i is the sum of elements 0 to i
+    Vec_pd sg_vectorcall(prefix_sum)() const {
+        return sg_prefix_sum_pd(data_);
+    }
+    static void sg_vectorcall(transpose)(Vec_pd& r0, Vec_pd& r1) {
+        sg_pd a0 = r0.data(), a1 = r1.data();
+        sg_transpose2_pd(&a0, &a1);
+        r0 = a0; r1 = a1;
+    }
 
     bool sg_vectorcall(debug_eq)(const double d1, const double d0) const {
         return sg_debug_eq_pd(data_, d1, d0);
@@ -8876,10 +11245,10 @@ public:
     static constexpr std::size_t elem_size = sizeof(int32_t),
         elem_count = 2;
 
-    static Vec_s32x2 sg_vectorcall(loadu)(int32_t *const i) {
+    static Vec_s32x2 sg_vectorcall(loadu)(const int32_t *const i) {
         return sg_loadu_s32x2(i);
     }
-    static Vec_s32x2 sg_vectorcall(load)(int32_t *const i) {
+    static Vec_s32x2 sg_vectorcall(load)(const int32_t *const i) {
         return sg_load_s32x2(i);
     }
     void sg_vectorcall(storeu)(int32_t *const i) const {
@@ -9076,6 +11445,42 @@ public:
     static Vec_s32x2 sg_vectorcall(max)(const Vec_s32x2 a, const Vec_s32x2 b) {
         return sg_max_s32x2(a.data(), b.data());
     }
+    int32_t sg_vectorcall(reduce_add)() const {
+        return sg_reduce_add_s32x2(data_);
+    }
+    int32_t sg_vectorcall(reduce_min)() const {
+        return sg_reduce_min_s32x2(data_);
+    }
+    int32_t sg_vectorcall(reduce_max)() const {
+        return sg_reduce_max_s32x2(data_);
+    }
+    // Element i is the sum of elements 0 to i
+    Vec_s32x2 sg_vectorcall(prefix_sum)() const {
+        return sg_prefix_sum_s32x2(data_);
+    }
+    Vec_s32x2 sg_vectorcall(adds)(const Vec_s32x2 rhs) const {
+        return sg_adds_s32x2(data_, rhs.data());
+    }
+    Vec_s32x2 sg_vectorcall(subs)(const Vec_s32x2 rhs) const {
+        return sg_subs_s32x2(data_, rhs.data());
+    }
+    Vec_s32x2 sg_vectorcall(qrdmulh)(const Vec_s32x2 rhs) const {
+        return sg_qrdmulh_s32x2(data_, rhs.data());
+    }
+    Vec_s32x2 sg_vectorcall(mulhi)(const Vec_s32x2 rhs) const {
+        return sg_mulhi_s32x2(data_, rhs.data());
+    }
+    Vec_pi64 sg_vectorcall(mul_wide)(const Vec_s32x2 rhs) const {
+        return sg_mul_wide_s32x2(data_, rhs.data());
+    }
+    // Bit counts are in each element, and clz() and ctz() give the element
+    // width for zero
+    Vec_s32x2 sg_vectorcall(popcount)() const { return sg_popcnt_s32x2(data_); }
+    Vec_s32x2 sg_vectorcall(clz)() const { return sg_clz_s32x2(data_); }
+    Vec_s32x2 sg_vectorcall(ctz)() const { return sg_ctz_s32x2(data_); }
+    Vec_s32x2 sg_vectorcall(reverse_bits)() const {
+        return sg_rbit_s32x2(data_);
+    }
 
     bool sg_vectorcall(debug_eq)(const int32_t i1, const int32_t i0) const
     {
@@ -9152,10 +11557,10 @@ public:
     static constexpr std::size_t elem_size = sizeof(float),
         elem_count = 2;
 
-    static Vec_f32x2 sg_vectorcall(loadu)(float *const f) {
+    static Vec_f32x2 sg_vectorcall(loadu)(const float *const f) {
         return sg_loadu_f32x2(f);
     }
-    static Vec_f32x2 sg_vectorcall(load)(float *const f) {
+    static Vec_f32x2 sg_vectorcall(load)(const float *const f) {
         return sg_load_f32x2(f);
     }
     void sg_vectorcall(storeu)(float *const f) const {
@@ -9295,6 +11700,36 @@ public:
         return sg_safediv_f32x2(data_, rhs.data());
     }
     Vec_f32x2 sg_vectorcall(abs)() const { return sg_abs_f32x2(data_); }
+    Vec_f32x2 sg_vectorcall(sqrt)() const { return sg_sqrt_f32x2(data_); }
+    Vec_f32x2 sg_vectorcall(copysign)(const Vec_f32x2 sign) const {
+        return sg_copysign_f32x2(data_, sign.data());
+    }
+    Compare_f32x2 sg_vectorcall(signbit)() const {
+        return sg_signbit_f32x2(data_);
+    }
+    Compare_f32x2 sg_vectorcall(is_nan)() const {
+        return sg_isnan_f32x2(data_);
+    }
+    Compare_f32x2 sg_vectorcall(is_inf)() const {
+        return sg_isinf_f32x2(data_);
+    }
+    Compare_f32x2 sg_vectorcall(is_finite)() const {
+        return sg_isfinite_f32x2(data_);
+    }
+    Compare_f32x2 sg_vectorcall(is_denormal)() const {
+        return sg_isdenormal_f32x2(data_);
+    }
+    Vec_f32x2 sg_vectorcall(flush_denormals)() const {
+        return sg_flush_denormals_f32x2(data_);
+    }
+    Vec_f32x2 sg_vectorcall(frexp)(Vec_s32x2& exp) const {
+        exp = sg_frexp_exp_f32x2(data_);
+        return sg_frexp_mant_f32x2(data_);
+    }
+    Vec_f32x2 sg_vectorcall(ldexp)(const Vec_s32x2 n) const {
+        return sg_ldexp_f32x2(data_, n.data());
+    }
+    Vec_s32x2 sg_vectorcall(ilogb)() const { return sg_ilogb_f32x2(data_); }
     Vec_f32x2 sg_vectorcall(remove_signed_zero)() const {
         return sg_remove_signed_zero_f32x2(data_);
     }
@@ -9310,6 +11745,19 @@ public:
     static Vec_f32x2 sg_vectorcall(max)(const Vec_f32x2 a, const Vec_f32x2 b) {
         return sg_max_f32x2(a.data(), b.data());
     }
+    float sg_vectorcall(reduce_add)() const {
+        return sg_reduce_add_f32x2(data_);
+    }
+    float sg_vectorcall(reduce_min)() const {
+        return sg_reduce_min_f32x2(data_);
+    }
+    float sg_vectorcall(reduce_max)() const {
+        return sg_reduce_max_f32x2(data_);
+    }
+    // Element i is the sum of elements 0 to i
+    Vec_f32x2 sg_vectorcall(prefix_sum)() const {
+        return sg_prefix_sum_f32x2(data_);
+    }
 
     bool sg_vectorcall(debug_eq)(const float f1, const float f0) const
     {
@@ -9485,6 +11933,7 @@ public:
     Compare_scalar<ScalarType> sg_vectorcall(operator!)() const {
         return !data_;
     }
+    int32_t sg_vectorcall(movemask)() const { return data_ ? 1 : 0; }
 
     template <typename To>
     To sg_vectorcall(to)() const { return data_; }
@@ -9578,7 +12027,7 @@ public:
     }
 
     Vec_s32x1& sg_vectorcall(operator+=)(const Vec_s32x1 rhs) {
-        data_ += rhs.data();
+        data_ = sg_add_wrap_s32x1_(data_, rhs.data());
         return *this;
     }
     friend Vec_s32x1 sg_vectorcall(operator+)(Vec_s32x1 lhs,
@@ -9590,7 +12039,7 @@ public:
     Vec_s32x1 sg_vectorcall(operator+)() const { return *this; }
 
     Vec_s32x1& sg_vectorcall(operator-=)(const Vec_s32x1 rhs) {
-        data_ -= rhs.data();
+        data_ = sg_sub_wrap_s32x1_(data_, rhs.data());
         return *this;
     }
     friend Vec_s32x1 sg_vectorcall(operator-)(Vec_s32x1 lhs,
@@ -9599,10 +12048,12 @@ public:
         lhs -= rhs;
         return lhs;
     }
-    Vec_s32x1 sg_vectorcall(operator-)() const { return -data_; }
+    Vec_s32x1 sg_vectorcall(operator-)() const {
+        return sg_sub_wrap_s32x1_(0, data_);
+    }
 
     Vec_s32x1& sg_vectorcall(operator*=)(const Vec_s32x1 rhs) {
-        data_ *= rhs.data();
+        data_ = sg_mul_wrap_s32x1_(data_, rhs.data());
         return *this;
     }
     friend Vec_s32x1 sg_vectorcall(operator*)(Vec_s32x1 lhs,
@@ -9679,7 +12130,7 @@ public:
     template<int32_t shift>
     Vec_s32x1 sg_vectorcall(shift_l_imm)() const {
         sassert_shift_32(shift);
-        return data_ << shift;
+        return sg_sl_wrap_s32x1_(data_, shift);
     }
 
     template<int32_t shift>
@@ -9695,7 +12146,7 @@ public:
     }
 
     Vec_s32x1 sg_vectorcall(shift_l)(const Vec_s32x1 shift) const {
-        return data_ << shift.data();
+        return sg_sl_wrap_s32x1_(data_, shift.data());
     }
     Vec_s32x1 sg_vectorcall(shift_rl)(const Vec_s32x1 shift) const {
         return sg_srl_s32x1(data_, shift.data());
@@ -9714,6 +12165,28 @@ public:
     static Vec_s32x1 sg_vectorcall(max)(const Vec_s32x1 a, const Vec_s32x1 b) {
         return std::max(a.data(), b.data());
     }
+    int32_t sg_vectorcall(reduce_add)() const { return data_; }
+    int32_t sg_vectorcall(reduce_min)() const { return data_; }
+    int32_t sg_vectorcall(reduce_max)() const { return data_; }
+    Vec_s32x1 sg_vectorcall(prefix_sum)() const { return data_; }
+    Vec_s32x1 sg_vectorcall(adds)(const Vec_s32x1 rhs) const {
+        return sg_adds_s32x1(data_, rhs.data());
+    }
+    Vec_s32x1 sg_vectorcall(subs)(const Vec_s32x1 rhs) const {
+        return sg_subs_s32x1(data_, rhs.data());
+    }
+    Vec_s32x1 sg_vectorcall(qrdmulh)(const Vec_s32x1 rhs) const {
+        return sg_qrdmulh_s32x1(data_, rhs.data());
+    }
+    Vec_s32x1 sg_vectorcall(mulhi)(const Vec_s32x1 rhs) const {
+        return sg_mulhi_s32x1(data_, rhs.data());
+    }
+    Vec_s32x1 sg_vectorcall(popcount)() const { return sg_popcnt_s32x1(data_); }
+    Vec_s32x1 sg_vectorcall(clz)() const { return sg_clz_s32x1(data_); }
+    Vec_s32x1 sg_vectorcall(ctz)() const { return sg_ctz_s32x1(data_); }
+    Vec_s32x1 sg_vectorcall(reverse_bits)() const {
+        return sg_rbit_s32x1(data_);
+    }
     Vec_s32x1 sg_vectorcall(constrain)(const Vec_s32x1 lowerb,
         const Vec_s32x1 upperb) const
     {
@@ -9798,7 +12271,7 @@ public:
     }
 
     Vec_s64x1& sg_vectorcall(operator+=)(const Vec_s64x1 rhs) {
-        data_ += rhs.data();
+        data_ = sg_add_wrap_s64x1_(data_, rhs.data());
         return *this;
     }
     friend Vec_s64x1 sg_vectorcall(operator+)(Vec_s64x1 lhs,
@@ -9810,7 +12283,7 @@ public:
     Vec_s64x1 sg_vectorcall(operator+)() const { return *this; }
 
     Vec_s64x1& sg_vectorcall(operator-=)(const Vec_s64x1 rhs) {
-        data_ -= rhs.data();
+        data_ = sg_sub_wrap_s64x1_(data_, rhs.data());
         return *this;
     }
     friend Vec_s64x1 sg_vectorcall(operator-)(Vec_s64x1 lhs,
@@ -9819,10 +12292,12 @@ public:
         lhs -= rhs;
         return lhs;
     }
-    Vec_s64x1 sg_vectorcall(operator-)() const { return -data_; }
+    Vec_s64x1 sg_vectorcall(operator-)() const {
+        return sg_sub_wrap_s64x1_(0, data_);
+    }
 
     Vec_s64x1& sg_vectorcall(operator*=)(const Vec_s64x1 rhs) {
-        data_ *= rhs.data();
+        data_ = sg_mul_wrap_s64x1_(data_, rhs.data());
         return *this;
     }
     friend Vec_s64x1 sg_vectorcall(operator*)(Vec_s64x1 lhs,
@@ -9900,7 +12375,7 @@ public:
     template<int32_t shift>
     Vec_s64x1 sg_vectorcall(shift_l_imm)() const {
         sassert_shift_64(shift);
-        return data_ << shift;
+        return sg_sl_wrap_s64x1_(data_, shift);
     }
     template<int32_t shift>
     Vec_s64x1 sg_vectorcall(shift_rl_imm)() const {
@@ -9914,7 +12389,7 @@ public:
     }
 
     Vec_s64x1 sg_vectorcall(shift_l)(const Vec_s64x1 shift) const {
-        return data_ << shift.data();
+        return sg_sl_wrap_s64x1_(data_, shift.data());
     }
     Vec_s64x1 sg_vectorcall(shift_rl)(const Vec_s64x1 shift) const {
         return sg_srl_s64x1(data_, shift.data());
@@ -9933,6 +12408,28 @@ public:
     static Vec_s64x1 sg_vectorcall(max)(const Vec_s64x1 a, const Vec_s64x1 b) {
         return std::max(a.data(), b.data());
     }
+    int64_t sg_vectorcall(reduce_add)() const { return data_; }
+    int64_t sg_vectorcall(reduce_min)() const { return data_; }
+    int64_t sg_vectorcall(reduce_max)() const { return data_; }
+    Vec_s64x1 sg_vectorcall(prefix_sum)() const { return data_; }
+    Vec_s64x1 sg_vectorcall(adds)(const Vec_s64x1 rhs) const {
+        return sg_adds_s64x1(data_, rhs.data());
+    }
+    Vec_s64x1 sg_vectorcall(subs)(const Vec_s64x1 rhs) const {
+        return sg_subs_s64x1(data_, rhs.data());
+    }
+    Vec_s32x1 sg_vectorcall(narrow_sat)() const {
+        return sg_cvtsat_s64x1_s32x1(data_);
+    }
+    Vec_s64x1 sg_vectorcall(mulhi)(const Vec_s64x1 rhs) const {
+        return sg_mulhi_s64x1(data_, rhs.data());
+    }
+    Vec_s64x1 sg_vectorcall(popcount)() const { return sg_popcnt_s64x1(data_); }
+    Vec_s64x1 sg_vectorcall(clz)() const { return sg_clz_s64x1(data_); }
+    Vec_s64x1 sg_vectorcall(ctz)() const { return sg_ctz_s64x1(data_); }
+    Vec_s64x1 sg_vectorcall(reverse_bits)() const {
+        return sg_rbit_s64x1(data_);
+    }
     Vec_s64x1 sg_vectorcall(constrain)(const Vec_s64x1 lowerb,
         const Vec_s64x1 upperb) const
     {
@@ -10116,6 +12613,36 @@ public:
         return rhs.data() == 0.0f ? data_ : data_ / rhs.data();
     }
     Vec_f32x1 sg_vectorcall(abs)() const { return std::abs(data_); }
+    Vec_f32x1 sg_vectorcall(sqrt)() const { return std::sqrt(data_); }
+    Vec_f32x1 sg_vectorcall(copysign)(const Vec_f32x1 sign) const {
+        return sg_copysign_f32x1(data_, sign.data());
+    }
+    Compare_f32x1 sg_vectorcall(signbit)() const {
+        return sg_signbit_f32x1(data_);
+    }
+    Compare_f32x1 sg_vectorcall(is_nan)() const {
+        return sg_isnan_f32x1(data_);
+    }
+    Compare_f32x1 sg_vectorcall(is_inf)() const {
+        return sg_isinf_f32x1(data_);
+    }
+    Compare_f32x1 sg_vectorcall(is_finite)() const {
+        return sg_isfinite_f32x1(data_);
+    }
+    Compare_f32x1 sg_vectorcall(is_denormal)() const {
+        return sg_isdenormal_f32x1(data_);
+    }
+    Vec_f32x1 sg_vectorcall(flush_denormals)() const {
+        return sg_flush_denormals_f32x1(data_);
+    }
+    Vec_f32x1 sg_vectorcall(frexp)(Vec_s32x1& exp) const {
+        exp = sg_frexp_exp_f32x1(data_);
+        return sg_frexp_mant_f32x1(data_);
+    }
+    Vec_f32x1 sg_vectorcall(ldexp)(const Vec_s32x1 n) const {
+        return sg_ldexp_f32x1(data_, n.data());
+    }
+    Vec_s32x1 sg_vectorcall(ilogb)() const { return sg_ilogb_f32x1(data_); }
     Vec_f32x1 sg_vectorcall(remove_signed_zero)() const {
         return data_ == 0.0f ? 0.0f : data_;
     }
@@ -10125,6 +12652,10 @@ public:
     static Vec_f32x1 sg_vectorcall(max)(const Vec_f32x1 a, const Vec_f32x1 b) {
         return std::max(a.data(), b.data());
     }
+    float sg_vectorcall(reduce_add)() const { return data_; }
+    float sg_vectorcall(reduce_min)() const { return data_; }
+    float sg_vectorcall(reduce_max)() const { return data_; }
+    Vec_f32x1 sg_vectorcall(prefix_sum)() const { return data_; }
     Vec_f32x1 sg_vectorcall(constrain)(const Vec_f32x1 lowerb,
         const Vec_f32x1 upperb) const
     {
@@ -10333,6 +12864,36 @@ public:
         return rhs.data() == 0.0 ? data_ : data_ / rhs.data();
     }
     Vec_f64x1 sg_vectorcall(abs)() const { return std::abs(data_); }
+    Vec_f64x1 sg_vectorcall(sqrt)() const { return std::sqrt(data_); }
+    Vec_f64x1 sg_vectorcall(copysign)(const Vec_f64x1 sign) const {
+        return sg_copysign_f64x1(data_, sign.data());
+    }
+    Compare_f64x1 sg_vectorcall(signbit)() const {
+        return sg_signbit_f64x1(data_);
+    }
+    Compare_f64x1 sg_vectorcall(is_nan)() const {
+        return sg_isnan_f64x1(data_);
+    }
+    Compare_f64x1 sg_vectorcall(is_inf)() const {
+        return sg_isinf_f64x1(data_);
+    }
+    Compare_f64x1 sg_vectorcall(is_finite)() const {
+        return sg_isfinite_f64x1(data_);
+    }
+    Compare_f64x1 sg_vectorcall(is_denormal)() const {
+        return sg_isdenormal_f64x1(data_);
+    }
+    Vec_f64x1 sg_vectorcall(flush_denormals)() const {
+        return sg_flush_denormals_f64x1(data_);
+    }
+    Vec_f64x1 sg_vectorcall(frexp)(Vec_s64x1& exp) const {
+        exp = sg_frexp_exp_f64x1(data_);
+        return sg_frexp_mant_f64x1(data_);
+    }
+    Vec_f64x1 sg_vectorcall(ldexp)(const Vec_s64x1 n) const {
+        return sg_ldexp_f64x1(data_, n.data());
+    }
+    Vec_s64x1 sg_vectorcall(ilogb)() const { return sg_ilogb_f64x1(data_); }
     Vec_f64x1 sg_vectorcall(remove_signed_zero)() const {
         return data_ == 0.0 ? 0.0 : data_;
     }
@@ -10342,6 +12903,10 @@ public:
     static Vec_f64x1 sg_vectorcall(max)(const Vec_f64x1 a, const Vec_f64x1 b) {
         return std::max(a.data(), b.data());
     }
+    double sg_vectorcall(reduce_add)() const { return data_; }
+    double sg_vectorcall(reduce_min)() const { return data_; }
+    double sg_vectorcall(reduce_max)() const { return data_; }
+    Vec_f64x1 sg_vectorcall(prefix_sum)() const { return data_; }
     Vec_f64x1 sg_vectorcall(constrain)(const Vec_f64x1 lowerb,
         const Vec_f64x1 upperb) const
     {
@@ -11135,6 +13700,20 @@ struct SGEquivFloatType {
         value;
 };
 
+// Flushes denormals to zero for the lifetime of the object, in the current
+// thread only, by calling sg_disable_denormals(). The previous floating point
+// mode is restored by the destructor
+class SGDenormalGuard {
+    sg_fp_mode prev_;
+public:
+    SGDenormalGuard() : prev_{sg_disable_denormals()} {}
+    ~SGDenormalGuard() { sg_set_fp_mode(prev_); }
+    SGDenormalGuard(const SGDenormalGuard&) = delete;
+    SGDenormalGuard& operator=(const SGDenormalGuard&) = delete;
+
+    sg_fp_mode previous_mode() const { return prev_; }
+};
+
 /*#ifdef SIMD_GRANODI_FAST_DEBUG
 #ifdef _MSC_VER
 // Reset to default optimizations, whatever they are
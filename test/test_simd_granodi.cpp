@@ -1,3 +1,4 @@
+#include <float.h> // for FLT_MIN etc
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h> // for exit()
@@ -8,6 +9,14 @@
 
 #include "../simd_granodi.h"
 #ifdef __cplusplus
+#include "../sg_math.h"
+#include "../sg_dsp.h"
+#include "../sg_random.h"
+#include "../sg_memory.h"
+#include "../sg_fixed.h"
+#include "../sg_array.h"
+#include <algorithm>
+#include <thread>
 using namespace simd_granodi;
 #endif
 
@@ -41,10 +50,23 @@ static void test_cmp();
 static void test_abs_neg();
 static void test_min_max();
 static void test_constrain();
+static void test_reduce();
+static void test_compress_transpose();
+static void test_saturate();
+static void test_qrdmulh();
+static void test_mulhi();
+static void test_bitops();
+static void test_classify();
 
 #ifdef __cplusplus
 static void test_opover();
 static void test_opover_cmp();
+static void test_math();
+static void test_dsp();
+static void test_random();
+static void test_memory();
+static void test_fixed();
+static void test_array();
 #endif
 
 int main() {
@@ -67,10 +89,23 @@ int main() {
     test_abs_neg();
     test_min_max();
     test_constrain();
+    test_reduce();
+    test_compress_transpose();
+    test_saturate();
+    test_qrdmulh();
+    test_mulhi();
+    test_bitops();
+    test_classify();
 
     #ifdef __cplusplus
     test_opover();
     test_opover_cmp();
+    test_math();
+    test_dsp();
+    test_random();
+    test_memory();
+    test_fixed();
+    test_array();
     #endif
 
     printf("\n");
@@ -1496,6 +1531,497 @@ void test_constrain() {
     //printf("Constrain test succeeded\n");
 }
 
+void test_reduce() {
+    sg_pi32 pi32 = sg_set_pi32(-7, 3, 11, -2);
+    sg_assert(sg_reduce_add_pi32(pi32) == 5);
+    sg_assert(sg_reduce_min_pi32(pi32) == -7);
+    sg_assert(sg_reduce_max_pi32(pi32) == 11);
+    pi32 = sg_set_pi32(4, -9, 2, 8);
+    sg_assert(sg_reduce_add_pi32(pi32) == 5);
+    sg_assert(sg_reduce_min_pi32(pi32) == -9);
+    sg_assert(sg_reduce_max_pi32(pi32) == 8);
+    // Integer sums wrap on overflow
+    sg_assert(sg_reduce_add_pi32(sg_set_pi32(1, 0, 0, INT32_MAX)) == INT32_MIN);
+
+    const sg_pi64 pi64 = sg_set_pi64(-5000000000, 3);
+    sg_assert(sg_reduce_add_pi64(pi64) == -4999999997);
+    sg_assert(sg_reduce_min_pi64(pi64) == -5000000000);
+    sg_assert(sg_reduce_max_pi64(pi64) == 3);
+    sg_assert(sg_reduce_add_pi64(sg_set_pi64(1, INT64_MAX)) == INT64_MIN);
+
+    sg_ps ps = sg_set_ps(0.5f, -4.0f, 2.0f, 1.0f);
+    sg_assert(sg_reduce_add_ps(ps) == -0.5f);
+    sg_assert(sg_reduce_min_ps(ps) == -4.0f);
+    sg_assert(sg_reduce_max_ps(ps) == 2.0f);
+    ps = sg_set_ps(-1.0f, 3.0f, -6.0f, 7.0f);
+    sg_assert(sg_reduce_add_ps(ps) == 3.0f);
+    sg_assert(sg_reduce_min_ps(ps) == -6.0f);
+    sg_assert(sg_reduce_max_ps(ps) == 7.0f);
+
+    const sg_pd pd = sg_set_pd(-2.5, 4.0);
+    sg_assert(sg_reduce_add_pd(pd) == 1.5);
+    sg_assert(sg_reduce_min_pd(pd) == -2.5);
+    sg_assert(sg_reduce_max_pd(pd) == 4.0);
+
+    const sg_s32x2 s32x2 = sg_set_s32x2(6, -3);
+    sg_assert(sg_reduce_add_s32x2(s32x2) == 3);
+    sg_assert(sg_reduce_min_s32x2(s32x2) == -3);
+    sg_assert(sg_reduce_max_s32x2(s32x2) == 6);
+    sg_assert(sg_reduce_add_s32x2(sg_set_s32x2(1, INT32_MAX)) == INT32_MIN);
+
+    const sg_f32x2 f32x2 = sg_set_f32x2(-1.5f, 0.25f);
+    sg_assert(sg_reduce_add_f32x2(f32x2) == -1.25f);
+    sg_assert(sg_reduce_min_f32x2(f32x2) == -1.5f);
+    sg_assert(sg_reduce_max_f32x2(f32x2) == 0.25f);
+
+    // Prefix sum
+    assert_eq_pi32(sg_prefix_sum_pi32(sg_set_pi32(8, -4, 2, 1)), 7, -1, 3, 1);
+    assert_eq_pi32(sg_prefix_sum_pi32(sg_set_pi32(1, 0, 0, INT32_MAX)),
+        INT32_MIN, INT32_MAX, INT32_MAX, INT32_MAX);
+    assert_eq_pi64(sg_prefix_sum_pi64(sg_set_pi64(-5000000000, 3)),
+        -4999999997, 3);
+    assert_eq_ps(sg_prefix_sum_ps(sg_set_ps(8.0f, -4.0f, 2.0f, 1.0f)),
+        7.0f, -1.0f, 3.0f, 1.0f);
+    assert_eq_pd(sg_prefix_sum_pd(sg_set_pd(-2.5, 4.0)), 1.5, 4.0);
+    assert_eq_s32x2(sg_prefix_sum_s32x2(sg_set_s32x2(6, -3)), 3, -3);
+    assert_eq_f32x2(sg_prefix_sum_f32x2(sg_set_f32x2(-1.5f, 0.25f)),
+        -1.25f, 0.25f);
+}
+
+void test_compress_transpose() {
+    int32_t mask;
+    for (mask = 0; mask < 16; ++mask) {
+        const bool b0 = (mask & 1) != 0, b1 = (mask & 2) != 0,
+            b2 = (mask & 4) != 0, b3 = (mask & 8) != 0;
+        const sg_cmp_pi32 cmp_pi32 = sg_setcmp_pi32(b3, b2, b1, b0);
+        const sg_cmp_ps cmp_ps = sg_setcmp_ps(b3, b2, b1, b0);
+        int32_t expected_i[4] = { 0, 0, 0, 0 }, n = 0;
+        float expected_f[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        int32_t lane;
+        for (lane = 0; lane < 4; ++lane) {
+            if (mask & (1 << lane)) {
+                expected_i[n] = 10 + lane;
+                expected_f[n] = -1.5f - (float) lane;
+                ++n;
+            }
+        }
+        sg_assert(sg_movemask_cmp_pi32(cmp_pi32) == mask);
+        sg_assert(sg_movemask_cmp_ps(cmp_ps) == mask);
+        assert_eq_pi32(sg_compress_pi32(sg_set_pi32(13, 12, 11, 10), cmp_pi32),
+            expected_i[3], expected_i[2], expected_i[1], expected_i[0]);
+        assert_eq_ps(sg_compress_ps(sg_set_ps(-4.5f, -3.5f, -2.5f, -1.5f),
+            cmp_ps), expected_f[3], expected_f[2], expected_f[1],
+            expected_f[0]);
+    }
+    for (mask = 0; mask < 4; ++mask) {
+        const bool b0 = (mask & 1) != 0, b1 = (mask & 2) != 0;
+        sg_assert(sg_movemask_cmp_pi64(sg_setcmp_pi64(b1, b0)) == mask);
+        sg_assert(sg_movemask_cmp_pd(sg_setcmp_pd(b1, b0)) == mask);
+        sg_assert(sg_movemask_cmp_s32x2(sg_setcmp_s32x2(b1, b0)) == mask);
+        sg_assert(sg_movemask_cmp_f32x2(sg_setcmp_f32x2(b1, b0)) == mask);
+    }
+
+    {
+        sg_pi32 r0 = sg_set_pi32(3, 2, 1, 0), r1 = sg_set_pi32(7, 6, 5, 4),
+            r2 = sg_set_pi32(11, 10, 9, 8), r3 = sg_set_pi32(15, 14, 13, 12);
+        sg_transpose4_pi32(&r0, &r1, &r2, &r3);
+        assert_eq_pi32(r0, 12, 8, 4, 0);
+        assert_eq_pi32(r1, 13, 9, 5, 1);
+        assert_eq_pi32(r2, 14, 10, 6, 2);
+        assert_eq_pi32(r3, 15, 11, 7, 3);
+    }
+    {
+        sg_ps r0 = sg_set_ps(3.0f, 2.0f, 1.0f, 0.0f),
+            r1 = sg_set_ps(7.0f, 6.0f, 5.0f, 4.0f),
+            r2 = sg_set_ps(11.0f, 10.0f, 9.0f, 8.0f),
+            r3 = sg_set_ps(15.0f, 14.0f, 13.0f, 12.0f);
+        sg_transpose4_ps(&r0, &r1, &r2, &r3);
+        assert_eq_ps(r0, 12.0f, 8.0f, 4.0f, 0.0f);
+        assert_eq_ps(r1, 13.0f, 9.0f, 5.0f, 1.0f);
+        assert_eq_ps(r2, 14.0f, 10.0f, 6.0f, 2.0f);
+        assert_eq_ps(r3, 15.0f, 11.0f, 7.0f, 3.0f);
+    }
+    {
+        sg_pi64 r0 = sg_set_pi64(1, 0), r1 = sg_set_pi64(3, 2);
+        sg_pd d0 = sg_set_pd(1.0, 0.0), d1 = sg_set_pd(3.0, 2.0);
+        sg_transpose2_pi64(&r0, &r1);
+        sg_transpose2_pd(&d0, &d1);
+        assert_eq_pi64(r0, 2, 0);
+        assert_eq_pi64(r1, 3, 1);
+        assert_eq_pd(d0, 2.0, 0.0);
+        assert_eq_pd(d1, 3.0, 1.0);
+    }
+}
+
+void test_saturate() {
+    int16_t s[8];
+
+    assert_eq_pi32(sg_adds_pi32(sg_set_pi32(INT32_MAX, INT32_MIN, 5, -5),
+        sg_set_pi32(1, -1, INT32_MAX - 5, INT32_MIN + 5)),
+        INT32_MAX, INT32_MIN, INT32_MAX, INT32_MIN + 0);
+    assert_eq_pi32(sg_adds_pi32(sg_set_pi32(INT32_MAX, INT32_MIN, 6, -6),
+        sg_set_pi32(-1, 1, INT32_MAX - 5, INT32_MIN + 5)),
+        INT32_MAX - 1, INT32_MIN + 1, INT32_MAX, INT32_MIN);
+    assert_eq_pi32(sg_subs_pi32(sg_set_pi32(INT32_MIN, INT32_MAX, -1, 0),
+        sg_set_pi32(1, -1, INT32_MAX, INT32_MIN)),
+        INT32_MIN, INT32_MAX, INT32_MIN, INT32_MAX);
+    assert_eq_pi32(sg_subs_pi32(sg_set_pi32(INT32_MIN, INT32_MAX, -2, 3),
+        sg_set_pi32(-1, 1, INT32_MAX, 4)),
+        INT32_MIN + 1, INT32_MAX - 1, INT32_MIN, -1);
+
+    assert_eq_pi64(sg_adds_pi64(sg_set_pi64(INT64_MAX, INT64_MIN),
+        sg_set_pi64(1, -1)), INT64_MAX, INT64_MIN);
+    assert_eq_pi64(sg_adds_pi64(sg_set_pi64(INT64_MAX, INT64_MIN),
+        sg_set_pi64(-1, 1)), INT64_MAX - 1, INT64_MIN + 1);
+    assert_eq_pi64(sg_subs_pi64(sg_set_pi64(INT64_MIN, -1),
+        sg_set_pi64(1, INT64_MAX)), INT64_MIN, INT64_MIN);
+    assert_eq_pi64(sg_subs_pi64(sg_set_pi64(0, 5),
+        sg_set_pi64(INT64_MIN, 7)), INT64_MAX, -2);
+
+    assert_eq_s32x2(sg_adds_s32x2(sg_set_s32x2(INT32_MAX, -3),
+        sg_set_s32x2(1, 2)), INT32_MAX, -1);
+    assert_eq_s32x2(sg_subs_s32x2(sg_set_s32x2(INT32_MIN, -3),
+        sg_set_s32x2(1, 2)), INT32_MIN, -5);
+
+    assert_eq_pi32(sg_cvtsat_pi64_pi32(sg_set_pi64(
+        (int64_t) INT32_MAX + 1, (int64_t) INT32_MIN - 1)),
+        0, 0, INT32_MAX, INT32_MIN);
+    assert_eq_pi32(sg_cvtsat_pi64_pi32(sg_set_pi64(INT64_MIN, INT64_MAX)),
+        0, 0, INT32_MIN, INT32_MAX);
+    assert_eq_pi32(sg_cvtsat_pi64_pi32(sg_set_pi64(INT32_MIN, INT32_MAX)),
+        0, 0, INT32_MIN, INT32_MAX);
+    assert_eq_pi32(sg_cvtsat_pi64_pi32(sg_set_pi64(-7, 0x100000000LL)),
+        0, 0, -7, INT32_MAX);
+    assert_eq_s32x2(sg_cvtsat_pi64_s32x2(sg_set_pi64(-0x100000000LL, 9)),
+        INT32_MIN, 9);
+
+    sg_storeu_sat16_pi32(s, sg_set_pi32(32768, -32769, 32767, -32768),
+        sg_set_pi32(INT32_MIN, INT32_MAX, -1, 1));
+    sg_assert(s[0] == -32768 && s[1] == 32767 && s[2] == -32768 &&
+        s[3] == 32767 && s[4] == 1 && s[5] == -1 && s[6] == 32767 &&
+        s[7] == -32768);
+}
+
+void test_qrdmulh() {
+    // Reference: (2*a*b + 2^31) >> 32, with the only overflow saturated
+    int32_t i, lane;
+    uint32_t state = 12345;
+    assert_eq_pi32(sg_qrdmulh_pi32(sg_set_pi32(INT32_MIN, INT32_MIN,
+        INT32_MAX, 1 << 30), sg_set_pi32(INT32_MIN, INT32_MAX, INT32_MAX,
+        1 << 30)), INT32_MAX, -INT32_MAX, INT32_MAX - 1, 1 << 29);
+    // Ties round upwards: 0.5 ulp rounds to 1, -0.5 ulp rounds to 0
+    assert_eq_pi32(sg_qrdmulh_pi32(sg_set_pi32(1, -1, 1 << 15, -(1 << 15)),
+        sg_set_pi32(1 << 30, 1 << 30, 1 << 15, 1 << 15)), 1, 0, 1, 0);
+    assert_eq_s32x2(sg_qrdmulh_s32x2(sg_set_s32x2(INT32_MIN, -3),
+        sg_set_s32x2(INT32_MIN, 1 << 30)), INT32_MAX, -1);
+    for (i = 0; i < 1000; ++i) {
+        int32_t a[4], b[4], expected[4];
+        for (lane = 0; lane < 4; ++lane) {
+            state = state*1664525u + 1013904223u;
+            a[lane] = sg_bitcast_u32x1_s32x1(state);
+            state = state*1664525u + 1013904223u;
+            b[lane] = sg_bitcast_u32x1_s32x1(state);
+            if (i % 7 == 0) b[lane] = lane & 1 ? INT32_MIN : INT32_MAX;
+            expected[lane] = a[lane] == INT32_MIN && b[lane] == INT32_MIN ?
+                INT32_MAX : (int32_t) ((2*(int64_t) a[lane]*b[lane] +
+                    ((int64_t) 1 << 31)) >> 32);
+        }
+        assert_eq_pi32(sg_qrdmulh_pi32(sg_loadu_pi32(a), sg_loadu_pi32(b)),
+            expected[3], expected[2], expected[1], expected[0]);
+    }
+}
+
+void test_mulhi() {
+    int32_t i, lane;
+    uint32_t state = 777;
+    assert_eq_pi32(sg_mulhi_pi32(sg_set_pi32(INT32_MIN, INT32_MIN, -1, 1 << 16),
+        sg_set_pi32(INT32_MIN, INT32_MAX, 1, 1 << 16)),
+        1 << 30, -(1 << 30), -1, 1);
+    assert_eq_pi32(sg_mulhi_pu32(sg_set_pi32(-1, -1, INT32_MIN, 1 << 16),
+        sg_set_pi32(-1, 2, 2, 1 << 16)), -2, 1, 1, 1);
+    assert_eq_pi64(sg_mul_wide_even_pi32(sg_set_pi32(99, INT32_MIN, 99, -3),
+        sg_set_pi32(99, INT32_MIN, 99, INT32_MAX)),
+        (int64_t) 1 << 62, -3 * (int64_t) INT32_MAX);
+    assert_eq_pi64(sg_mul_wide_s32x2(sg_set_s32x2(-1, INT32_MAX),
+        sg_set_s32x2(INT32_MIN, INT32_MAX)),
+        (int64_t) 1 << 31, (int64_t) INT32_MAX * INT32_MAX);
+    assert_eq_pi64(sg_mulhi_pi64(sg_set_pi64(INT64_MIN, -1),
+        sg_set_pi64(INT64_MIN, (int64_t) 1 << 40)),
+        (int64_t) 1 << 62, -1);
+    assert_eq_pi64(sg_mulhi_pi64(sg_set_pi64(INT64_MAX, (int64_t) 3 << 40),
+        sg_set_pi64(INT64_MAX, -((int64_t) 5 << 30))),
+        ((int64_t) 1 << 62) - 1, -((int64_t) 15 << 6));
+
+    for (i = 0; i < 1000; ++i) {
+        int32_t a[4], b[4], hi[4], hi_u[4];
+        int64_t wide[2];
+        for (lane = 0; lane < 4; ++lane) {
+            state = state*1664525u + 1013904223u;
+            a[lane] = sg_bitcast_u32x1_s32x1(state);
+            state = state*1664525u + 1013904223u;
+            b[lane] = sg_bitcast_u32x1_s32x1(state);
+            hi[lane] = (int32_t) (((int64_t) a[lane]*b[lane]) >> 32);
+            hi_u[lane] = sg_bitcast_u32x1_s32x1((uint32_t) (((uint64_t)
+                sg_bitcast_s32x1_u32x1(a[lane]) *
+                sg_bitcast_s32x1_u32x1(b[lane])) >> 32));
+        }
+        wide[0] = (int64_t) a[0]*b[0]; wide[1] = (int64_t) a[2]*b[2];
+        assert_eq_pi32(sg_mulhi_pi32(sg_loadu_pi32(a), sg_loadu_pi32(b)),
+            hi[3], hi[2], hi[1], hi[0]);
+        assert_eq_pi32(sg_mulhi_pu32(sg_loadu_pi32(a), sg_loadu_pi32(b)),
+            hi_u[3], hi_u[2], hi_u[1], hi_u[0]);
+        assert_eq_pi64(sg_mul_wide_even_pi32(sg_loadu_pi32(a),
+            sg_loadu_pi32(b)), wide[1], wide[0]);
+        // The high half of a 64-bit product of 32-bit values is the sign
+        // extension of the 32-bit product
+        assert_eq_pi64(sg_mulhi_pi64(sg_set_pi64(a[2], a[0]),
+            sg_set_pi64(b[2], b[0])), wide[1] < 0 ? -1 : 0,
+            wide[0] < 0 ? -1 : 0);
+        assert_eq_pi64(sg_mulhi_pi64(sg_set_pi64(wide[1], wide[0]),
+            sg_set_pi64((int64_t) 1 << 32, (int64_t) 1 << 32)),
+            wide[1] >> 32, wide[0] >> 32);
+    }
+}
+
+void test_bitops() {
+    int32_t i, lane;
+    uint32_t state = 4242;
+    assert_eq_pi32(sg_popcnt_pi32(sg_set_pi32(-1, 0, INT32_MIN, 0x0f0f0f01)),
+        32, 0, 1, 13);
+    assert_eq_pi64(sg_popcnt_pi64(sg_set_pi64(-1, INT64_MIN + 3)), 64, 3);
+    assert_eq_s32x2(sg_popcnt_s32x2(sg_set_s32x2(7, -2)), 3, 31);
+    assert_eq_pi32(sg_clz_pi32(sg_set_pi32(0, -1, 1, 0x00ffffff)),
+        32, 0, 31, 8);
+    assert_eq_pi64(sg_clz_pi64(sg_set_pi64(0, 0x100000000LL)), 64, 31);
+    assert_eq_pi64(sg_clz_pi64(sg_set_pi64(1, -1)), 63, 0);
+    assert_eq_s32x2(sg_clz_s32x2(sg_set_s32x2(0x01ffffff, 0)), 7, 32);
+    assert_eq_pi32(sg_ctz_pi32(sg_set_pi32(0, -1, INT32_MIN, 24)),
+        32, 0, 31, 3);
+    assert_eq_pi64(sg_ctz_pi64(sg_set_pi64(0, INT64_MIN)), 64, 63);
+    assert_eq_pi64(sg_ctz_pi64(sg_set_pi64(0x100000000LL, 6)), 32, 1);
+    assert_eq_s32x2(sg_ctz_s32x2(sg_set_s32x2(0, 1 << 20)), 32, 20);
+    assert_eq_pi32(sg_rbit_pi32(sg_set_pi32(1, INT32_MIN, 0x0000ff01, 0)),
+        INT32_MIN, 1, sg_bitcast_u32x1_s32x1(0x80ff0000u), 0);
+    assert_eq_pi64(sg_rbit_pi64(sg_set_pi64(1, 0x12)), INT64_MIN,
+        0x4800000000000000LL);
+    assert_eq_s32x2(sg_rbit_s32x2(sg_set_s32x2(6, -1)), 0x60000000, -1);
+
+    // Against the scalar versions, which are checked against simple loops
+    for (i = 0; i < 200; ++i) {
+        int32_t a[4];
+        int64_t l[2];
+        for (lane = 0; lane < 4; ++lane) {
+            state = state*1664525u + 1013904223u;
+            // Vary the number of leading and trailing zeros
+            a[lane] = sg_bitcast_u32x1_s32x1((state >> (i % 32)) <<
+                (lane*(i % 7)));
+        }
+        l[0] = sg_bitcast_u64x1_s64x1(((uint64_t) (int64_t) a[0] << (i % 32))
+            ^ (uint64_t) (int64_t) a[1]);
+        l[1] = (int64_t) (((uint64_t) sg_bitcast_s32x1_u32x1(a[2]) << 32) >>
+            (i % 40));
+        for (lane = 0; lane < 4; ++lane) {
+            const uint32_t u = sg_bitcast_s32x1_u32x1(a[lane]);
+            int32_t bit, pop = 0, clz = 32, ctz = 32;
+            uint32_t rev = 0;
+            for (bit = 0; bit < 32; ++bit) {
+                if (u & ((uint32_t) 1 << bit)) {
+                    ++pop;
+                    clz = 31 - bit;
+                    if (ctz == 32) ctz = bit;
+                    rev |= (uint32_t) 1 << (31 - bit);
+                }
+            }
+            sg_assert(sg_popcnt_s32x1(a[lane]) == pop);
+            sg_assert(sg_clz_s32x1(a[lane]) == clz);
+            sg_assert(sg_ctz_s32x1(a[lane]) == ctz);
+            sg_assert(sg_rbit_s32x1(a[lane]) == sg_bitcast_u32x1_s32x1(rev));
+        }
+        for (lane = 0; lane < 2; ++lane) {
+            const uint64_t u = sg_bitcast_s64x1_u64x1(l[lane]);
+            int64_t bit, pop = 0, clz = 64, ctz = 64;
+            uint64_t rev = 0;
+            for (bit = 0; bit < 64; ++bit) {
+                if (u & ((uint64_t) 1 << bit)) {
+                    ++pop;
+                    clz = 63 - bit;
+                    if (ctz == 64) ctz = bit;
+                    rev |= (uint64_t) 1 << (63 - bit);
+                }
+            }
+            sg_assert(sg_popcnt_s64x1(l[lane]) == pop);
+            sg_assert(sg_clz_s64x1(l[lane]) == clz);
+            sg_assert(sg_ctz_s64x1(l[lane]) == ctz);
+            sg_assert(sg_rbit_s64x1(l[lane]) == sg_bitcast_u64x1_s64x1(rev));
+        }
+        {
+            const sg_pi32 v = sg_loadu_pi32(a);
+            const sg_pi64 v64 = sg_set_pi64(l[1], l[0]);
+            assert_eq_pi32(sg_popcnt_pi32(v), sg_popcnt_s32x1(a[3]),
+                sg_popcnt_s32x1(a[2]), sg_popcnt_s32x1(a[1]),
+                sg_popcnt_s32x1(a[0]));
+            assert_eq_pi32(sg_clz_pi32(v), sg_clz_s32x1(a[3]),
+                sg_clz_s32x1(a[2]), sg_clz_s32x1(a[1]), sg_clz_s32x1(a[0]));
+            assert_eq_pi32(sg_ctz_pi32(v), sg_ctz_s32x1(a[3]),
+                sg_ctz_s32x1(a[2]), sg_ctz_s32x1(a[1]), sg_ctz_s32x1(a[0]));
+            assert_eq_pi32(sg_rbit_pi32(v), sg_rbit_s32x1(a[3]),
+                sg_rbit_s32x1(a[2]), sg_rbit_s32x1(a[1]),
+                sg_rbit_s32x1(a[0]));
+            assert_eq_pi64(sg_popcnt_pi64(v64), sg_popcnt_s64x1(l[1]),
+                sg_popcnt_s64x1(l[0]));
+            assert_eq_pi64(sg_clz_pi64(v64), sg_clz_s64x1(l[1]),
+                sg_clz_s64x1(l[0]));
+            assert_eq_pi64(sg_ctz_pi64(v64), sg_ctz_s64x1(l[1]),
+                sg_ctz_s64x1(l[0]));
+            assert_eq_pi64(sg_rbit_pi64(v64), sg_rbit_s64x1(l[1]),
+                sg_rbit_s64x1(l[0]));
+        }
+    }
+}
+
+void test_classify() {
+    const float fs[] = { 0.0f, -0.0f, 1.0f, -1.0f, 0.75f, -3.0f, 1.0e30f,
+        -2.5e-30f, FLT_MIN, -FLT_MIN, FLT_MAX, 1.0e-40f, -1.0e-45f,
+        sg_infinity_f32x1, -sg_infinity_f32x1, NAN,
+        // 2.625 * 2^-47 and 1.375 * 2^-47, which ldexp() with n of -103 or
+        // -110 makes denormal, rounding only once. The doubles below are
+        // these times 2^-58, for n of -970 or -980
+        1.865174681370263e-14f, -1.865174681370263e-14f,
+        9.769962616701378e-15f };
+    const double ds[] = { 0.0, -0.0, 1.0, -1.0, 0.75, -3.0, 1.0e300,
+        -2.5e-300, DBL_MIN, -DBL_MIN, DBL_MAX, 1.0e-310, -4.9e-324,
+        sg_infinity_f64x1, -sg_infinity_f64x1, NAN,
+        6.471124613141112e-32, -6.471124613141112e-32,
+        3.389636702121535e-32 };
+    const int32_t ns[] = { 0, 1, -1, 10, -10, 127, -126, -149, -150, 128,
+        277, -277, 1023, -1074, 2098, -2098, -103, -110, -970, -980,
+        INT32_MAX, INT32_MIN };
+    size_t i, j;
+
+    for (i = 0; i < sizeof(fs) / sizeof(fs[0]); ++i) {
+        const float f = fs[i];
+        const sg_ps a = sg_set1_ps(f);
+        const sg_f32x2 b = sg_set1_f32x2(f);
+        const bool sb = signbit(f) != 0, nan = isnan(f) != 0,
+            inf = isinf(f) != 0, fin = isfinite(f) != 0,
+            den = fpclassify(f) == FP_SUBNORMAL;
+        int exp = 0;
+        const float mant = frexpf(f, &exp);
+        if (!fin) exp = 0;
+
+        assert_eq_ps(sg_copysign_ps(sg_set1_ps(2.0f), a),
+            copysignf(2.0f, f), copysignf(2.0f, f), copysignf(2.0f, f),
+            copysignf(2.0f, f));
+        assert_eq_f32x2(sg_copysign_f32x2(sg_set1_f32x2(2.0f), b),
+            copysignf(2.0f, f), copysignf(2.0f, f));
+        assert_eq_cmp_ps(sg_signbit_ps(a), sb, sb, sb, sb);
+        assert_eq_cmp_f32x2(sg_signbit_f32x2(b), sb, sb);
+        assert_eq_cmp_ps(sg_isnan_ps(a), nan, nan, nan, nan);
+        assert_eq_cmp_f32x2(sg_isnan_f32x2(b), nan, nan);
+        assert_eq_cmp_ps(sg_isinf_ps(a), inf, inf, inf, inf);
+        assert_eq_cmp_f32x2(sg_isinf_f32x2(b), inf, inf);
+        assert_eq_cmp_ps(sg_isfinite_ps(a), fin, fin, fin, fin);
+        assert_eq_cmp_f32x2(sg_isfinite_f32x2(b), fin, fin);
+        assert_eq_cmp_ps(sg_isdenormal_ps(a), den, den, den, den);
+        assert_eq_cmp_f32x2(sg_isdenormal_f32x2(b), den, den);
+
+        assert_eq_ps(sg_frexp_mant_ps(a), mant, mant, mant, mant);
+        assert_eq_f32x2(sg_frexp_mant_f32x2(b), mant, mant);
+        assert_eq_pi32(sg_frexp_exp_ps(a), exp, exp, exp, exp);
+        assert_eq_s32x2(sg_frexp_exp_f32x2(b), exp, exp);
+        assert_eq_pi32(sg_ilogb_ps(a), ilogbf(f), ilogbf(f), ilogbf(f),
+            ilogbf(f));
+        assert_eq_s32x2(sg_ilogb_f32x2(b), ilogbf(f), ilogbf(f));
+
+        for (j = 0; j < sizeof(ns) / sizeof(ns[0]); ++j) {
+            const float r = ldexpf(f, ns[j]);
+            assert_eq_ps(sg_ldexp_ps(a, sg_set1_pi32(ns[j])), r, r, r, r);
+            assert_eq_f32x2(sg_ldexp_f32x2(b, sg_set1_s32x2(ns[j])), r, r);
+        }
+    }
+
+    for (i = 0; i < sizeof(ds) / sizeof(ds[0]); ++i) {
+        const double d = ds[i];
+        const sg_pd a = sg_set1_pd(d);
+        const bool sb = signbit(d) != 0, nan = isnan(d) != 0,
+            inf = isinf(d) != 0, fin = isfinite(d) != 0,
+            den = fpclassify(d) == FP_SUBNORMAL;
+        int exp = 0;
+        const double mant = frexp(d, &exp);
+        if (!fin) exp = 0;
+
+        assert_eq_pd(sg_copysign_pd(sg_set1_pd(2.0), a), copysign(2.0, d),
+            copysign(2.0, d));
+        assert_eq_cmp_pd(sg_signbit_pd(a), sb, sb);
+        assert_eq_cmp_pd(sg_isnan_pd(a), nan, nan);
+        assert_eq_cmp_pd(sg_isinf_pd(a), inf, inf);
+        assert_eq_cmp_pd(sg_isfinite_pd(a), fin, fin);
+        assert_eq_cmp_pd(sg_isdenormal_pd(a), den, den);
+
+        assert_eq_pd(sg_frexp_mant_pd(a), mant, mant);
+        assert_eq_pi64(sg_frexp_exp_pd(a), exp, exp);
+        assert_eq_pi64(sg_ilogb_pd(a), ilogb(d), ilogb(d));
+
+        for (j = 0; j < sizeof(ns) / sizeof(ns[0]); ++j) {
+            const double r = ldexp(d, ns[j]);
+            assert_eq_pd(sg_ldexp_pd(a, sg_set1_pi64(ns[j])), r, r);
+        }
+    }
+
+    // Lanes are independent
+    assert_eq_ps(sg_copysign_ps(sg_set_ps(1.0f, 2.0f, 3.0f, 4.0f),
+        sg_set_ps(-0.0f, 0.0f, -5.0f, 5.0f)), -1.0f, 2.0f, -3.0f, 4.0f);
+    assert_eq_cmp_ps(sg_signbit_ps(sg_set_ps(-0.0f, 0.0f, -5.0f, 5.0f)),
+        true, false, true, false);
+    assert_eq_cmp_pd(sg_signbit_pd(sg_set_pd(-0.0, 5.0)), true, false);
+    assert_eq_pi32(sg_frexp_exp_ps(sg_set_ps(8.0f, 0.5f, -3.0f, 1.0e-40f)),
+        4, 0, 2, -132);
+    assert_eq_pi32(sg_ilogb_ps(sg_set_ps(8.0f, 0.5f, -3.0f, 1.0e-40f)),
+        3, -1, 1, -133);
+    assert_eq_pd(sg_ldexp_pd(sg_set_pd(1.0, 3.0), sg_set_pi64(-1, 2)),
+        0.5, 12.0);
+    // Exponents beyond 32 bits saturate, rather than using the low bits
+    assert_eq_pd(sg_ldexp_pd(sg_set1_pd(1.0),
+        sg_set_pi64(INT64_C(0x100000005), -INT64_C(0x100000000))),
+        sg_infinity_f64x1, 0.0);
+    assert_eq_pd(sg_ldexp_pd(sg_set_pd(DBL_MAX, 4.9406564584124654e-324),
+        sg_set_pi64(-2097, 2097)), ldexp(DBL_MAX, -2097), ldexp(1.0, 1023));
+
+    // Denormal flushing
+    assert_eq_ps(sg_flush_denormals_ps(sg_set_ps(1.0e-40f, -1.0e-45f, FLT_MIN,
+        -sg_infinity_f32x1)), 0.0f, -0.0f, FLT_MIN, -sg_infinity_f32x1);
+    assert_eq_pd(sg_flush_denormals_pd(sg_set_pd(-1.0e-310, -DBL_MIN)),
+        -0.0, -DBL_MIN);
+    assert_eq_f32x2(sg_flush_denormals_f32x2(sg_set_f32x2(1.0e-40f, 1.0f)),
+        0.0f, 1.0f);
+    sg_assert(sg_isnan_f32x1(sg_get0_ps(sg_flush_denormals_ps(
+        sg_set1_ps(NAN)))));
+    {
+        volatile float tiny = 1.0e-40f, flushed, kept;
+        const sg_fp_mode prev = sg_disable_denormals();
+        flushed = tiny * 0.5f;
+        // Classification doesn't depend on the floating point mode
+        assert_eq_cmp_ps(sg_isdenormal_ps(sg_set_ps(tiny, -tiny, 0.0f,
+            FLT_MIN)), true, true, false, false);
+        assert_eq_cmp_pd(sg_isdenormal_pd(sg_set_pd(-1.0e-310, 0.0)),
+            true, false);
+        sg_assert(sg_isdenormal_f32x1(tiny));
+        assert_eq_ps(sg_flush_denormals_ps(sg_set_ps(tiny, -tiny, FLT_MIN,
+            1.0f)), 0.0f, -0.0f, FLT_MIN, 1.0f);
+        sg_set_fp_mode(prev);
+        kept = tiny * 0.5f;
+        sg_assert(sg_get_fp_mode() == prev);
+        sg_assert(kept != 0.0f);
+        #if defined SIMD_GRANODI_SSE2 || defined SIMD_GRANODI_ARCH_ARM64
+        sg_assert(flushed == 0.0f);
+        #else
+        (void) flushed;
+        #endif
+    }
+
+    //printf("Classify test succeeded\n");
+}
+
 #ifdef __cplusplus
 
 static void test_opover() {
@@ -2428,6 +2954,118 @@ static void test_opover() {
     sg_assert(Vec_f64x1::min(Vec_f64x1{1}, Vec_f64x1{2}).debug_eq(1));
     sg_assert(Vec_f64x1::max(Vec_f64x1{1}, Vec_f64x1{2}).debug_eq(2));
 
+    // Horizontal reduction
+    sg_assert(Vec_pi32(4, -1, 3, 2).reduce_add() == 8);
+    sg_assert(Vec_pi32(4, -1, 3, 2).reduce_min() == -1);
+    sg_assert(Vec_pi32(4, -1, 3, 2).reduce_max() == 4);
+    sg_assert(Vec_pi64(-1, 3).reduce_add() == 2);
+    sg_assert(Vec_pi64(-1, 3).reduce_min() == -1);
+    sg_assert(Vec_pi64(-1, 3).reduce_max() == 3);
+    sg_assert(Vec_ps(1.0f, 2.0f, -3.0f, 5.0f).reduce_add() == 5.0f);
+    sg_assert(Vec_ps(1.0f, 2.0f, -3.0f, 5.0f).reduce_min() == -3.0f);
+    sg_assert(Vec_ps(1.0f, 2.0f, -3.0f, 5.0f).reduce_max() == 5.0f);
+    sg_assert(Vec_pd(-1.0, 3.0).reduce_add() == 2.0);
+    sg_assert(Vec_pd(-1.0, 3.0).reduce_min() == -1.0);
+    sg_assert(Vec_pd(-1.0, 3.0).reduce_max() == 3.0);
+
+    sg_assert(Vec_s32x2(-1, 3).reduce_add() == 2);
+    sg_assert(Vec_s32x2(-1, 3).reduce_min() == -1);
+    sg_assert(Vec_s32x2(-1, 3).reduce_max() == 3);
+    sg_assert(Vec_f32x2(-1.0f, 3.0f).reduce_add() == 2.0f);
+    sg_assert(Vec_f32x2(-1.0f, 3.0f).reduce_min() == -1.0f);
+    sg_assert(Vec_f32x2(-1.0f, 3.0f).reduce_max() == 3.0f);
+
+    sg_assert(Vec_pi32(4, -1, 3, 2).prefix_sum().debug_eq(8, 4, 5, 2));
+    sg_assert(Vec_pi64(-1, 3).prefix_sum().debug_eq(2, 3));
+    sg_assert(Vec_ps(1.0f, 2.0f, -3.0f, 5.0f).prefix_sum()
+        .debug_eq(5.0f, 4.0f, 2.0f, 5.0f));
+    sg_assert(Vec_pd(-1.0, 3.0).prefix_sum().debug_eq(2.0, 3.0));
+    sg_assert(Vec_s32x2(-1, 3).prefix_sum().debug_eq(2, 3));
+    sg_assert(Vec_f32x2(-1.0f, 3.0f).prefix_sum().debug_eq(2.0f, 3.0f));
+    sg_assert(Vec_f64x1{-2.0}.prefix_sum().debug_eq(-2.0));
+
+    sg_assert(Vec_s32x1{-2}.reduce_add() == -2);
+    sg_assert(Vec_s64x1{-2}.reduce_min() == -2);
+    sg_assert(Vec_f32x1{-2.0f}.reduce_max() == -2.0f);
+    sg_assert(Vec_f64x1{-2.0}.reduce_add() == -2.0);
+
+    // Saturating arithmetic
+    sg_assert(Vec_pi32(INT32_MAX, 1, INT32_MIN, 0).adds(Vec_pi32(1, 1, -1, -1))
+        .debug_eq(INT32_MAX, 2, INT32_MIN, -1));
+    sg_assert(Vec_pi64(INT64_MIN, 3).subs(Vec_pi64(1, 1))
+        .debug_eq(INT64_MIN, 2));
+    sg_assert(Vec_s32x2(INT32_MIN, 0).subs(Vec_s32x2(1, INT32_MIN))
+        .debug_eq(INT32_MIN, INT32_MAX));
+    sg_assert(Vec_s32x1{INT32_MAX}.adds(5).debug_eq(INT32_MAX));
+    sg_assert(Vec_s64x1{INT64_MAX}.adds(-5).debug_eq(INT64_MAX - 5));
+    sg_assert(Vec_pi64(-1, INT64_MAX).narrow_sat().debug_eq(0, 0, -1,
+        INT32_MAX));
+    sg_assert(Vec_s64x1{INT64_MIN}.narrow_sat().debug_eq(INT32_MIN));
+    {
+        int16_t s16[8];
+        Vec_pi32(0, 40000, -40000, 7).storeu_sat16(s16, Vec_pi32{-3});
+        sg_assert(s16[0] == 7 && s16[1] == -32768 && s16[2] == 32767 &&
+            s16[3] == 0 && s16[7] == -3);
+    }
+
+    // Multiply high and widening multiply
+    sg_assert(Vec_pi32(-1, 1 << 16, INT32_MIN, 3).mulhi(Vec_pi32(1, 1 << 16,
+        INT32_MIN, 3)).debug_eq(-1, 1, 1 << 30, 0));
+    sg_assert(Vec_pi32(-1, 0, 2, 0).mulhi_unsigned(Vec_pi32(-1, 0,
+        INT32_MIN, 0)).debug_eq(-2, 0, 1, 0));
+    sg_assert(Vec_pi32(0, -2, 0, INT32_MAX).mul_wide_even(Vec_pi32(0, 3, 0,
+        2)).debug_eq(-6, 2 * (int64_t) INT32_MAX));
+    sg_assert(Vec_pi64(INT64_MIN, 5).mulhi(Vec_pi64(2, -1)).debug_eq(-1, -1));
+    sg_assert(Vec_s32x2(INT32_MIN, 7).mulhi(Vec_s32x2(-2, 1))
+        .debug_eq(1, 0));
+    sg_assert(Vec_s32x2(INT32_MIN, 7).mul_wide(Vec_s32x2(-2, 1))
+        .debug_eq((int64_t) 1 << 32, 7));
+    sg_assert(Vec_s32x1{-5}.mulhi(1).debug_eq(-1));
+    sg_assert(Vec_s64x1{INT64_MIN}.mulhi(INT64_MIN).debug_eq(
+        (int64_t) 1 << 62));
+
+    // Bit manipulation
+    sg_assert(Vec_pi32(3, 0, -1, 8).popcount().debug_eq(2, 0, 32, 1));
+    sg_assert(Vec_pi32(3, 0, -1, 8).clz().debug_eq(30, 32, 0, 28));
+    sg_assert(Vec_pi32(3, 0, -1, 8).ctz().debug_eq(0, 32, 0, 3));
+    sg_assert(Vec_pi32(0, 0, 0, 1).reverse_bits().debug_eq(0, 0, 0,
+        INT32_MIN));
+    sg_assert(Vec_pi64(-1, 2).popcount().debug_eq(64, 1));
+    sg_assert(Vec_pi64(-1, 2).clz().debug_eq(0, 62));
+    sg_assert(Vec_pi64(0, 2).ctz().debug_eq(64, 1));
+    sg_assert(Vec_pi64(INT64_MIN, 0).reverse_bits().debug_eq(1, 0));
+    sg_assert(Vec_s32x2(5, 16).popcount().debug_eq(2, 1));
+    sg_assert(Vec_s32x2(5, 16).clz().debug_eq(29, 27));
+    sg_assert(Vec_s32x2(5, 16).ctz().debug_eq(0, 4));
+    sg_assert(Vec_s32x2(1, 2).reverse_bits().debug_eq(INT32_MIN, 1 << 30));
+    sg_assert(Vec_s32x1{12}.popcount().debug_eq(2));
+    sg_assert(Vec_s32x1{12}.clz().debug_eq(28));
+    sg_assert(Vec_s32x1{12}.ctz().debug_eq(2));
+    sg_assert(Vec_s32x1{1}.reverse_bits().debug_eq(INT32_MIN));
+    sg_assert(Vec_s64x1{12}.popcount().debug_eq(2));
+    sg_assert(Vec_s64x1{12}.clz().debug_eq(60));
+    sg_assert(Vec_s64x1{12}.ctz().debug_eq(2));
+    sg_assert(Vec_s64x1{1}.reverse_bits().debug_eq(INT64_MIN));
+
+    // Movemask, compress and transpose
+    sg_assert(Compare_ps(true, false, true, true).movemask() == 11);
+    sg_assert(Compare_pi64(true, false).movemask() == 2);
+    sg_assert(Compare_f32x1{true}.movemask() == 1);
+    sg_assert(Vec_ps(4.0f, 3.0f, 2.0f, 1.0f).compress(Vec_ps(4.0f, 3.0f,
+        2.0f, 1.0f) > 2.5f).debug_eq(0.0f, 0.0f, 4.0f, 3.0f));
+    sg_assert(Vec_pi32(4, 3, 2, 1).compress(Compare_pi32(false, true, false,
+        true)).debug_eq(0, 0, 3, 1));
+    {
+        Vec_ps r0{3.0f, 2.0f, 1.0f, 0.0f}, r1{7.0f, 6.0f, 5.0f, 4.0f},
+            r2{11.0f, 10.0f, 9.0f, 8.0f}, r3{15.0f, 14.0f, 13.0f, 12.0f};
+        Vec_ps::transpose(r0, r1, r2, r3);
+        sg_assert(r0.debug_eq(12.0f, 8.0f, 4.0f, 0.0f));
+        sg_assert(r3.debug_eq(15.0f, 11.0f, 7.0f, 3.0f));
+        Vec_pd d0{1.0, 0.0}, d1{3.0, 2.0};
+        Vec_pd::transpose(d0, d1);
+        sg_assert(d0.debug_eq(2.0, 0.0) && d1.debug_eq(3.0, 1.0));
+    }
+
     // Bitcast
     sg_assert(Vec_pi32{1}.bitcast<Vec_pi32>().debug_eq(1));
     sg_assert(Vec_pi32{1}.bitcast<Vec_pi64>().bitcast<Vec_pi32>().debug_eq(1));
@@ -2610,6 +3248,50 @@ static void test_opover() {
     sg_assert(Vec_f64x1{1.0}.to<Vec_f64x1>().debug_eq(1.0f));
     sg_assert(Vec_f64x1{1.0}.to<Vec_f32x1>().debug_eq(1.0f));
 
+    // Sign and exponent manipulation
+    sg_assert(Vec_ps(1.0f, 2.0f, 3.0f, 4.0f)
+        .copysign(Vec_ps(-0.0f, 0.0f, -5.0f, 5.0f))
+        .debug_eq(-1.0f, 2.0f, -3.0f, 4.0f));
+    sg_assert(Vec_pd(-0.0, 1.0).signbit().debug_valid_eq(true, false));
+    sg_assert(Vec_ps(Vec_ps::infinity()).is_inf()
+        .debug_valid_eq(true, true, true, true));
+    sg_assert(Vec_f32x2(1.0e-40f, 1.0f).is_denormal()
+        .debug_valid_eq(true, false));
+    sg_assert((Vec_f64x1{1.0} / Vec_f64x1{0.0}).is_finite()
+        .debug_valid_eq(false));
+    sg_assert((Vec_f32x1{0.0f} / Vec_f32x1{0.0f}).is_nan()
+        .debug_valid_eq(true));
+    {
+        Vec_pi32 exp;
+        sg_assert(Vec_ps(8.0f, 0.5f, -3.0f, 0.0f).frexp(exp)
+            .debug_eq(0.5f, 0.5f, -0.75f, 0.0f));
+        sg_assert(exp.debug_eq(4, 0, 2, 0));
+        Vec_s64x1 exp_d;
+        sg_assert(Vec_f64x1{-12.0}.frexp(exp_d).data() == -0.75);
+        sg_assert(exp_d.data() == 4);
+    }
+    sg_assert(Vec_pd(1.0, 3.0).ldexp(Vec_pi64(-1, 2)).debug_eq(0.5, 12.0));
+    sg_assert(Vec_f32x2(1.0f, 3.0f).ldexp(Vec_s32x2(200, -200))
+        .debug_eq(sg_infinity_f32x1, 0.0f));
+    sg_assert(Vec_f32x1{10.0f}.ldexp(3).data() == 80.0f);
+    sg_assert(Vec_ps(8.0f, 0.5f, -3.0f, 1.0f).ilogb().debug_eq(3, -1, 1, 0));
+    sg_assert(Vec_f64x1{0.0}.ilogb().data() == FP_ILOGB0);
+    sg_assert(Vec_ps(1.0e-40f, -1.0e-40f, 1.0f, 0.0f).flush_denormals()
+        .debug_eq(0.0f, -0.0f, 1.0f, 0.0f));
+    sg_assert(Vec_f64x1{1.0e-310}.flush_denormals().data() == 0.0);
+    {
+        const sg_fp_mode prev = sg_get_fp_mode();
+        {
+            SGDenormalGuard guard;
+            sg_assert(guard.previous_mode() == prev);
+            #if defined SIMD_GRANODI_SSE2 || defined SIMD_GRANODI_ARCH_ARM64
+            volatile float tiny = 1.0e-40f, flushed = tiny * 0.5f;
+            sg_assert(flushed == 0.0f);
+            #endif
+        }
+        sg_assert(sg_get_fp_mode() == prev);
+    }
+
     //printf("Vector operator overloading test succeeded\n");
 }
 
@@ -2964,3 +3646,1627 @@ static void test_opover_cmp() {
     //sg_assert(Vec_ps{1.0f}.to<Vec_f32x1>().debug_eq(1.0f));
 }
 #endif
+
+#ifdef __cplusplus
+
+// Distance in units in the last place, valid across zero
+static int64_t ulp_diff_f32(const float a, const float b) {
+    int64_t ia = sg_bitcast_f32x1_s32x1(a), ib = sg_bitcast_f32x1_s32x1(b);
+    if (ia < 0) ia = INT32_MIN - ia;
+    if (ib < 0) ib = INT32_MIN - ib;
+    return ia > ib ? ia - ib : ib - ia;
+}
+static int64_t ulp_diff_f64(const double a, const double b) {
+    int64_t ia = sg_bitcast_f64x1_s64x1(a), ib = sg_bitcast_f64x1_s64x1(b);
+    // Avoid overflow when mapping negative values
+    if (ia < 0) ia = -(ia & INT64_MAX);
+    if (ib < 0) ib = -(ib & INT64_MAX);
+    return ia > ib ? ia - ib : ib - ia;
+}
+
+// sin(pi * x) or cos(pi * x) in long double, with exact argument reduction
+static long double sincospi_ref(const long double x, const bool cos) {
+    const long double pi = 3.14159265358979323846264338327950288L,
+        n = std::nearbyint(2.0L*x), r = x - 0.5L*n;
+    int64_t q = static_cast<int64_t>(std::fmod(n, 4.0L));
+    if (q < 0) q += 4;
+    if (cos) ++q;
+    const long double s = (q % 2 == 0) ? std::sin(pi*r) : std::cos(pi*r);
+    return (q % 4 >= 2) ? -s : s;
+}
+
+// Max ulp error of f over [lo, hi], comparing all 4 lanes of Vec_ps with ref
+template <typename Function, typename RefFunction>
+static int64_t max_ulp_ps(Function f, RefFunction ref, const float lo,
+    const float hi, const int32_t steps)
+{
+    int64_t result = 0;
+    for (int32_t i = 0; i < steps; i += 4) {
+        float x[4], y[4];
+        for (int32_t j = 0; j < 4; ++j) {
+            x[j] = lo + (hi - lo) * static_cast<float>(i + j) / steps;
+        }
+        f(Vec_ps::loadu(x)).storeu(y);
+        for (int32_t j = 0; j < 4; ++j) {
+            result = std::max(result, ulp_diff_f32(y[j], ref(x[j])));
+        }
+    }
+    return result;
+}
+template <typename Function, typename RefFunction>
+static int64_t max_ulp_pd(Function f, RefFunction ref, const double lo,
+    const double hi, const int32_t steps)
+{
+    int64_t result = 0;
+    for (int32_t i = 0; i < steps; i += 2) {
+        double x[2], y[2];
+        for (int32_t j = 0; j < 2; ++j) {
+            x[j] = lo + (hi - lo) * static_cast<double>(i + j) / steps;
+        }
+        f(Vec_pd::loadu(x)).storeu(y);
+        for (int32_t j = 0; j < 2; ++j) {
+            result = std::max(result, ulp_diff_f64(y[j], ref(x[j])));
+        }
+    }
+    return result;
+}
+
+static void test_math() {
+    #define SG_PS_F(func) [](const Vec_ps x) { return func(x); }
+    #define SG_PD_F(func) [](const Vec_pd x) { return func(x); }
+    #define SG_F_REF(func) [](const float x) { return func(x); }
+    #define SG_D_REF(func) [](const double x) { return func(x); }
+
+    // Exponentials
+    sg_assert(max_ulp_ps(SG_PS_F(sg_exp), SG_F_REF(std::exp),
+        -87.0f, 88.0f, 10000) <= 2);
+    sg_assert(max_ulp_pd(SG_PD_F(sg_exp), SG_D_REF(std::exp),
+        -708.0, 709.0, 10000) <= 2);
+    sg_assert(max_ulp_ps(SG_PS_F(sg_expm1), SG_F_REF(std::expm1),
+        -10.0f, 10.0f, 10000) <= 3);
+    sg_assert(max_ulp_ps(SG_PS_F(sg_expm1), SG_F_REF(std::expm1),
+        -1e-3f, 1e-3f, 1000) <= 3);
+    sg_assert(max_ulp_pd(SG_PD_F(sg_expm1), SG_D_REF(std::expm1),
+        -10.0, 10.0, 10000) <= 3);
+    sg_assert(max_ulp_ps(SG_PS_F(sg_exp2), SG_F_REF(std::exp2),
+        -126.0f, 127.0f, 10000) <= 2);
+    sg_assert(max_ulp_pd(SG_PD_F(sg_exp2), SG_D_REF(std::exp2),
+        -1022.0, 1023.0, 10000) <= 2);
+    sg_assert(sg_exp(Vec_ps{100.0f}).debug_eq(Vec_ps::infinity()));
+    sg_assert(sg_exp(Vec_pd{1000.0}).debug_eq(Vec_pd::infinity()));
+    sg_assert(sg_exp(Vec_ps{-200.0f}).debug_eq(0.0f));
+    sg_assert(sg_exp(Vec_ps::minus_infinity()).debug_eq(0.0f));
+    sg_assert(sg_exp2(Vec_ps{3.0f, 2.0f, 1.0f, 0.0f})
+        .debug_eq(8.0f, 4.0f, 2.0f, 1.0f));
+    sg_assert(sg_expm1(Vec_pd{0.0}).debug_eq(0.0));
+
+    // Sigmoids and soft clipping
+    sg_assert(max_ulp_ps(SG_PS_F(sg_tanh), SG_F_REF(std::tanh),
+        -10.0f, 10.0f, 10000) <= 4);
+    sg_assert(max_ulp_ps(SG_PS_F(sg_tanh), SG_F_REF(std::tanh),
+        -1e-3f, 1e-3f, 1000) <= 4);
+    sg_assert(max_ulp_pd(SG_PD_F(sg_tanh), SG_D_REF(std::tanh),
+        -25.0, 25.0, 10000) <= 4);
+    sg_assert(sg_tanh(Vec_ps{100.0f, -100.0f, 0.0f, -0.0f})
+        .debug_eq(1.0f, -1.0f, 0.0f, -0.0f));
+    sg_assert(sg_tanh(Vec_pd::infinity()).debug_eq(1.0));
+    sg_assert(max_ulp_ps(SG_PS_F(sg_sigmoid), [](const float x) {
+            return static_cast<float>(1.0 / (1.0 + std::exp(-1.0 * x))); },
+        -20.0f, 20.0f, 10000) <= 4);
+    sg_assert(sg_sigmoid(Vec_pd{0.0}).debug_eq(0.5));
+    sg_assert(max_ulp_ps(SG_PS_F(sg_atan), SG_F_REF(std::atan),
+        -100.0f, 100.0f, 10000) <= 3);
+    sg_assert(max_ulp_ps(SG_PS_F(sg_atan), SG_F_REF(std::atan),
+        -2.0f, 2.0f, 10000) <= 3);
+    sg_assert(max_ulp_pd(SG_PD_F(sg_atan), SG_D_REF(std::atan),
+        -3.0, 3.0, 10000) <= 3);
+    sg_assert(sg_atan(Vec_ps::infinity())
+        .debug_eq(static_cast<float>(1.57079632679489661923)));
+    sg_assert(max_ulp_ps(SG_PS_F(sg_soft_clip_atan), [](const float x) {
+            return static_cast<float>(0.63661977236758134308 *
+                std::atan(1.57079632679489661923 * x)); },
+        -10.0f, 10.0f, 10000) <= 4);
+    sg_assert(sg_soft_clip_poly(Vec_ps{-3.0f, -1.0f, 0.5f, 2.0f})
+        .debug_eq(-1.0f, -1.0f, 0.6875f, 1.0f));
+
+    // Other float types
+    sg_assert(ulp_diff_f32(sg_tanh(Vec_f32x1{0.5f}).data(),
+        std::tanh(0.5f)) <= 4);
+    sg_assert(ulp_diff_f64(sg_tanh(Vec_f64x1{0.5}).data(),
+        std::tanh(0.5)) <= 4);
+    sg_assert(ulp_diff_f32(sg_exp(Vec_f32x2{2.0f, 0.5f}).get<1>(),
+        std::exp(2.0f)) <= 2);
+    sg_assert(ulp_diff_f32(sg_atan(Vec_f32x2{2.0f, 0.5f}).get<0>(),
+        std::atan(0.5f)) <= 3);
+
+    // Square root, logarithms
+    sg_assert(Vec_ps(16.0f, 9.0f, 4.0f, 0.0f).sqrt()
+        .debug_eq(4.0f, 3.0f, 2.0f, 0.0f));
+    sg_assert(Vec_pd{2.0}.sqrt().debug_eq(std::sqrt(2.0)));
+    sg_assert(Vec_f32x2(2.0f, 25.0f).sqrt().debug_eq(std::sqrt(2.0f), 5.0f));
+    sg_assert(Vec_f64x1{9.0}.sqrt().data() == 3.0);
+    sg_assert(max_ulp_ps(SG_PS_F(sg_log), SG_F_REF(std::log),
+        1e-3f, 1e3f, 10000) <= 2);
+    sg_assert(max_ulp_ps(SG_PS_F(sg_log), SG_F_REF(std::log),
+        0.5f, 2.0f, 10000) <= 2);
+    sg_assert(max_ulp_pd(SG_PD_F(sg_log), SG_D_REF(std::log),
+        0.5, 2.0, 10000) <= 2);
+    sg_assert(max_ulp_pd(SG_PD_F(sg_log), SG_D_REF(std::log),
+        1e-5, 1e5, 10000) <= 2);
+    sg_assert(max_ulp_ps(SG_PS_F(sg_log2), SG_F_REF(std::log2),
+        1e-3f, 1e3f, 10000) <= 2);
+    sg_assert(max_ulp_pd(SG_PD_F(sg_log2), SG_D_REF(std::log2),
+        1e-5, 1e5, 10000) <= 2);
+    sg_assert(max_ulp_ps(SG_PS_F(sg_log10), SG_F_REF(std::log10),
+        1e-3f, 1e3f, 10000) <= 3);
+    sg_assert(max_ulp_ps(SG_PS_F(sg_log1p), SG_F_REF(std::log1p),
+        -0.5f, 10.0f, 10000) <= 3);
+    sg_assert(max_ulp_ps(SG_PS_F(sg_log1p), SG_F_REF(std::log1p),
+        -1e-3f, 1e-3f, 1000) <= 3);
+    sg_assert(max_ulp_pd(SG_PD_F(sg_log1p), SG_D_REF(std::log1p),
+        -0.5, 10.0, 10000) <= 3);
+    sg_assert(sg_log2(Vec_ps{8.0f, 1.0f, 0.5f, 1e-40f})
+        .debug_eq(3.0f, 0.0f, -1.0f, std::log2(1e-40f)));
+    sg_assert(sg_log(Vec_pd{0.0, 1e-310}).debug_eq(
+        -std::numeric_limits<double>::infinity(), std::log(1e-310)));
+    sg_assert(sg_log(Vec_ps::infinity()).debug_eq(Vec_ps::infinity()));
+    sg_assert(std::isnan(sg_log(Vec_f32x1{-1.0f}).data()));
+
+    // Inverse trigonometric
+    sg_assert(max_ulp_ps(SG_PS_F(sg_asin), SG_F_REF(std::asin),
+        -1.0f, 1.0f, 10000) <= 2);
+    sg_assert(max_ulp_pd(SG_PD_F(sg_asin), SG_D_REF(std::asin),
+        -1.0, 1.0, 10000) <= 2);
+    sg_assert(max_ulp_ps(SG_PS_F(sg_acos), SG_F_REF(std::acos),
+        -1.0f, 1.0f, 10000) <= 2);
+    sg_assert(max_ulp_pd(SG_PD_F(sg_acos), SG_D_REF(std::acos),
+        -1.0, 1.0, 10000) <= 2);
+    sg_assert(sg_asin(Vec_ps{1.0f, -1.0f, 0.0f, -0.0f}).debug_eq(
+        std::asin(1.0f), std::asin(-1.0f), 0.0f, -0.0f));
+    {
+        int64_t max_err_ps = 0, max_err_pd = 0;
+        for (int32_t i = -50; i <= 50; ++i) {
+            for (int32_t j = -50; j <= 50; ++j) {
+                const float y = i * 0.37f, x = j * 0.21f;
+                max_err_ps = std::max(max_err_ps, ulp_diff_f32(
+                    sg_atan2(Vec_ps{y}, Vec_ps{x}).get<2>(),
+                    std::atan2(y, x)));
+                max_err_pd = std::max(max_err_pd, ulp_diff_f64(
+                    sg_atan2(Vec_pd{y}, Vec_pd{x}).get<1>(),
+                    std::atan2(static_cast<double>(y),
+                        static_cast<double>(x))));
+            }
+        }
+        sg_assert(max_err_ps <= 3);
+        sg_assert(max_err_pd <= 3);
+        const float zeros[4][2] = { { 0.0f, 0.0f }, { 0.0f, -0.0f },
+            { -0.0f, 0.0f }, { -0.0f, -0.0f } };
+        for (int32_t i = 0; i < 4; ++i) {
+            sg_assert(sg_atan2(Vec_f32x1{zeros[i][0]}, Vec_f32x1{zeros[i][1]})
+                .debug_eq(std::atan2(zeros[i][0], zeros[i][1])));
+        }
+        const float inf = std::numeric_limits<float>::infinity();
+        sg_assert(sg_atan2(Vec_ps{inf, -inf, 1.0f, inf},
+            Vec_ps{inf, 1.0f, -inf, -inf}).debug_eq(std::atan2(inf, inf),
+            std::atan2(-inf, 1.0f), std::atan2(1.0f, -inf),
+            std::atan2(inf, -inf)));
+    }
+
+    // Hyperbolic
+    sg_assert(max_ulp_ps(SG_PS_F(sg_sinh), SG_F_REF(std::sinh),
+        -89.0f, 89.0f, 10000) <= 4);
+    sg_assert(max_ulp_ps(SG_PS_F(sg_sinh), SG_F_REF(std::sinh),
+        -2.0f, 2.0f, 10000) <= 4);
+    sg_assert(max_ulp_pd(SG_PD_F(sg_sinh), SG_D_REF(std::sinh),
+        -2.0, 2.0, 10000) <= 4);
+    sg_assert(max_ulp_pd(SG_PD_F(sg_sinh), SG_D_REF(std::sinh),
+        -710.0, 710.0, 10000) <= 4);
+    sg_assert(max_ulp_ps(SG_PS_F(sg_cosh), SG_F_REF(std::cosh),
+        -89.0f, 89.0f, 10000) <= 3);
+    sg_assert(max_ulp_pd(SG_PD_F(sg_cosh), SG_D_REF(std::cosh),
+        -710.0, 710.0, 10000) <= 3);
+    sg_assert(sg_sinh(Vec_ps{100.0f, -100.0f, 0.0f, -0.0f}).debug_eq(
+        Vec_ps::infinity().get<0>(), Vec_ps::minus_infinity().get<0>(),
+        0.0f, -0.0f));
+    sg_assert(max_ulp_ps(SG_PS_F(sg_asinh), SG_F_REF(std::asinh),
+        -10.0f, 10.0f, 10000) <= 3);
+    sg_assert(max_ulp_ps(SG_PS_F(sg_asinh), SG_F_REF(std::asinh),
+        -1e5f, 1e5f, 10000) <= 3);
+    sg_assert(max_ulp_pd(SG_PD_F(sg_asinh), SG_D_REF(std::asinh),
+        -10.0, 10.0, 10000) <= 3);
+    sg_assert(max_ulp_pd(SG_PD_F(sg_asinh), SG_D_REF(std::asinh),
+        -1e300, 1e300, 10000) <= 3);
+
+    // Powers
+    {
+        int64_t max_err_ps = 0, max_err_pd = 0;
+        for (int32_t i = 0; i < 200; ++i) {
+            for (int32_t j = -100; j <= 100; ++j) {
+                const float x = 0.013f + i * 0.11f, y = j * 0.173f;
+                max_err_ps = std::max(max_err_ps, ulp_diff_f32(
+                    sg_pow(Vec_ps{x}, Vec_ps{y}).get<3>(), static_cast<float>(
+                        std::pow(static_cast<double>(x),
+                            static_cast<double>(y)))));
+                max_err_pd = std::max(max_err_pd, ulp_diff_f64(
+                    sg_pow(Vec_pd{x}, y).get<0>(), std::pow(
+                        static_cast<double>(x), static_cast<double>(y))));
+            }
+        }
+        sg_assert(max_err_ps <= 1);
+        sg_assert(max_err_pd <= 2);
+        const float inf = std::numeric_limits<float>::infinity();
+        const float xs[] = { -2.0f, -0.0f, 0.0f, 1.0f, -1.0f, inf, -inf,
+            0.5f, 2.0f, 1e-40f },
+            ys[] = { -3.0f, -2.0f, -0.5f, 0.0f, 0.5f, 2.0f, 3.0f, inf, -inf,
+            1e30f, 160.0f, -160.0f };
+        for (const float x : xs) {
+            for (const float y : ys) {
+                const float result = sg_pow(Vec_f32x1{x}, y).data(),
+                    expected = std::pow(x, y);
+                sg_assert(std::isnan(result) ? std::isnan(expected) :
+                    ulp_diff_f32(result, expected) <= 1);
+            }
+        }
+    }
+    sg_assert(max_ulp_ps(SG_PS_F(sg_cbrt), SG_F_REF(std::cbrt),
+        -1000.0f, 1000.0f, 10000) <= 1);
+    sg_assert(max_ulp_pd(SG_PD_F(sg_cbrt), [](const double x) {
+            return static_cast<double>(std::cbrt(static_cast<long double>(x)));
+        }, -1e300, 1e300, 10000) <= 1);
+    sg_assert(max_ulp_pd(SG_PD_F(sg_cbrt), [](const double x) {
+            return static_cast<double>(std::cbrt(static_cast<long double>(x)));
+        }, -1.0, 1.0, 10000) <= 1);
+    sg_assert(sg_cbrt(Vec_ps{-27.0f, 8.0f, -0.0f, 1e-40f})
+        .debug_eq(-3.0f, 2.0f, -0.0f, std::cbrt(1e-40f)));
+    {
+        int64_t max_err_ps = 0, max_err_pd = 0;
+        for (int32_t i = -50; i < 50; ++i) {
+            for (int32_t j = -50; j <= 50; ++j) {
+                const float x = i * 1.3e-3f, y = j * 0.7e-3f;
+                const float scales[] = { 1.0f, 1e30f, 1e-30f, 1e-36f };
+                for (const float scale : scales) {
+                    const float x_scaled = x * scale, y_scaled = y * scale;
+                    max_err_ps = std::max(max_err_ps, ulp_diff_f32(
+                        sg_hypot(Vec_ps{x_scaled}, Vec_ps{y_scaled}).get<1>(),
+                        std::hypot(x_scaled, y_scaled)));
+                }
+                max_err_pd = std::max(max_err_pd, ulp_diff_f64(
+                    sg_hypot(Vec_pd{x * 1e300}, Vec_pd{y * 1e300}).get<1>(),
+                    std::hypot(x * 1e300, y * 1e300)));
+            }
+        }
+        sg_assert(max_err_ps <= 1);
+        sg_assert(max_err_pd <= 1);
+        sg_assert(sg_hypot(Vec_ps{3.0f, 0.0f, 1.0f, -5.0f},
+            Vec_ps{4.0f, 0.0f, -Vec_ps::infinity().get<0>(), 12.0f})
+            .debug_eq(5.0f, 0.0f, Vec_ps::infinity().get<0>(), 13.0f));
+    }
+
+    // Decibels
+    sg_assert(max_ulp_ps(SG_PS_F(sg_db_to_gain), [](const float x) {
+            return static_cast<float>(std::pow(10.0, x / 20.0)); },
+        -200.0f, 200.0f, 10000) <= 1);
+    sg_assert(max_ulp_pd(SG_PD_F(sg_db_to_gain), [](const double x) {
+            return static_cast<double>(std::pow(10.0L, x / 20.0L)); },
+        -200.0, 200.0, 10000) <= 1);
+    sg_assert(max_ulp_ps(SG_PS_F(sg_gain_to_db), [](const float x) {
+            return static_cast<float>(20.0 * std::log10(
+                static_cast<double>(x))); },
+        1e-6f, 10.0f, 10000) <= 1);
+    sg_assert(max_ulp_pd(SG_PD_F(sg_gain_to_db), [](const double x) {
+            return static_cast<double>(20.0L * std::log10(
+                static_cast<long double>(x))); },
+        1e-6, 10.0, 10000) <= 1);
+    sg_assert(sg_db_to_gain(Vec_ps{20.0f, 0.0f, -40.0f, -1000.0f})
+        .debug_eq(10.0f, 1.0f, 0.01f, 0.0f));
+    sg_assert(sg_gain_to_db(Vec_pd{0.0, 100.0})
+        .debug_eq(Vec_pd::minus_infinity().get<0>(), 40.0));
+
+    // Fast approximations
+    for (int32_t i = -1000; i <= 1000; ++i) {
+        const float db = i * 0.1f, gain = std::pow(10.0f, db / 20.0f);
+        sg_assert(std::abs(sg_db_to_gain_fast(Vec_ps{db}).get<0>() - gain) <
+            2e-5f * gain);
+        sg_assert(std::abs(sg_gain_to_db_fast(Vec_ps{gain}).get<0>() - db) <
+            1e-4f);
+        sg_assert(std::abs(sg_gain_to_db_fast(Vec_f64x1{gain}).data() - db) <
+            1e-4);
+        const float x = 0.01f + (i + 1000) * 0.005f;
+        const float pow_expected = std::pow(x, 2.7f);
+        sg_assert(std::abs(sg_pow_fast(Vec_ps{x}, 2.7f).get<0>() -
+            pow_expected) < 2e-5f * pow_expected);
+        sg_assert(std::abs(sg_exp2_fast(Vec_pd{db}).get<0>() -
+            std::exp2(db)) < 2e-5 * std::exp2(db));
+    }
+    sg_assert(sg_db_to_gain_fast(Vec_ps::minus_infinity()).debug_eq(0.0f));
+    sg_assert(sg_gain_to_db_fast(Vec_ps{0.0f})
+        .debug_eq(Vec_ps::minus_infinity()));
+
+    // sin(pi * x) and cos(pi * x)
+    #define SG_SINPI_REF(T, cos) [](const T x) { \
+        return static_cast<T>(sincospi_ref(x, cos)); }
+    sg_assert(max_ulp_ps(SG_PS_F(sg_sinpi), SG_SINPI_REF(float, false),
+        -4.0f, 4.0f, 10000) <= 1);
+    sg_assert(max_ulp_ps(SG_PS_F(sg_cospi), SG_SINPI_REF(float, true),
+        -4.0f, 4.0f, 10000) <= 1);
+    sg_assert(max_ulp_ps(SG_PS_F(sg_sinpi), SG_SINPI_REF(float, false),
+        1e5f, 1e6f, 10000) <= 1);
+    sg_assert(max_ulp_pd(SG_PD_F(sg_sinpi), SG_SINPI_REF(double, false),
+        -4.0, 4.0, 10000) <= 1);
+    sg_assert(max_ulp_pd(SG_PD_F(sg_cospi), SG_SINPI_REF(double, true),
+        1e9, 1e10, 10000) <= 1);
+    #undef SG_SINPI_REF
+    {
+        Vec_ps s, c;
+        sg_sincospi(Vec_ps(1e30f, -3.0f, 0.5f, -0.0f), s, c);
+        sg_assert(s.debug_eq(0.0f, -0.0f, 1.0f, -0.0f));
+        sg_assert(c.debug_eq(1.0f, -1.0f, 0.0f, 1.0f));
+        sg_assert(sg_sinpi(Vec_pd::infinity()).is_nan()
+            .debug_valid_eq(true));
+        sg_assert(sg_cospi(Vec_f32x1{-1.0f}).data() == -1.0f);
+        sg_assert(sg_sinpi(Vec_f32x2{0.5f, 1.5f}).debug_eq(1.0f, -1.0f));
+        sg_assert(sg_cospi(Vec_f64x1{2.0}).data() == 1.0);
+    }
+
+    #undef SG_PS_F
+    #undef SG_PD_F
+    #undef SG_F_REF
+    #undef SG_D_REF
+}
+
+static void test_dsp() {
+    // FIR impulse response
+    {
+        const float taps[] = { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f };
+        SGFir fir{taps, 5, 3};
+        float x[9] = { 1.0f }, y[9];
+        fir.process(x, y, 9);
+        for (int32_t i = 0; i < 9; ++i) {
+            sg_assert(y[i] == (i < 5 ? taps[i] : 0.0f));
+        }
+    }
+
+    // Oversampling a sine, with an identity waveshaper, only adds latency
+    const int32_t n = 2000;
+    const double pi = 3.14159265358979323846, freq = 0.02;
+    std::vector<float> in(n), out(n);
+    for (int32_t i = 0; i < n; ++i) {
+        in[i] = static_cast<float>(std::sin(2.0*pi*freq*i));
+    }
+    for (int32_t factor = 1; factor <= 4; factor *= 2) {
+        SGOversampler os{factor, 64};
+        // Odd sized blocks, to test splitting into max_block sized pieces
+        for (int32_t i = 0; i < n; i += 100) {
+            os.process(&in[i], &out[i], 100, [](const Vec_ps x) { return x; });
+        }
+        for (int32_t i = 200; i < n; ++i) {
+            const double expected = std::sin(2.0*pi*freq*(i - os.latency()));
+            sg_assert(std::abs(out[i] - expected) < 1e-3);
+        }
+    }
+
+    // Oversampled tanh stays bounded
+    SGOversampler os{4, 256};
+    for (int32_t i = 0; i < n; ++i) in[i] *= 10.0f;
+    os.process(in.data(), out.data(), n,
+        [](const Vec_ps x) { return sg_tanh(x); });
+    for (int32_t i = 0; i < n; ++i) sg_assert(std::abs(out[i]) < 1.1f);
+
+    // THD+N of tanh(2 sin(x)) at 11.7 kHz (sample rate 48 kHz). The 3rd
+    // harmonic and above should be removed, not aliased back below Nyquist,
+    // so everything but the fundamental counts as distortion. The
+    // fundamental is an exact DFT bin, so it is removed by projection
+    {
+        const int32_t size = 4096, bin = 1000, warm_up = 1024;
+        std::vector<float> sine(size + warm_up), shaped(size + warm_up);
+        for (int32_t i = 0; i < size + warm_up; ++i) {
+            sine[i] = float(2.0*std::sin(2.0*pi*bin*i/size));
+        }
+        for (int32_t factor = 1; factor <= 4; factor *= 2) {
+            SGOversampler thd_os{factor, 256};
+            thd_os.process(sine.data(), shaped.data(), size + warm_up,
+                [](const Vec_ps x) { return sg_tanh(x); });
+            const float *const y = shaped.data() + warm_up;
+            double c = 0.0, s = 0.0;
+            for (int32_t i = 0; i < size; ++i) {
+                c += y[i]*std::cos(2.0*pi*bin*i/size);
+                s += y[i]*std::sin(2.0*pi*bin*i/size);
+            }
+            c *= 2.0/size; s *= 2.0/size;
+            double fundamental = 0.0, residual = 0.0;
+            for (int32_t i = 0; i < size; ++i) {
+                const double f = c*std::cos(2.0*pi*bin*i/size) +
+                    s*std::sin(2.0*pi*bin*i/size);
+                fundamental += f*f;
+                residual += (y[i] - f)*(y[i] - f);
+            }
+            const double thd_db = 10.0*std::log10(residual/fundamental);
+            // At 1x the aliased harmonics are only about 15 dB down
+            sg_assert(factor == 1 ? thd_db > -20.0 :
+                thd_db < (factor == 2 ? -30.0 : -80.0));
+        }
+    }
+
+    // PCM round trips are exact
+    {
+        std::vector<int16_t> pcm16(65536), pcm16_out(65536);
+        for (int32_t i = 0; i < 65536; ++i) pcm16[i] = int16_t(i - 32768);
+        std::vector<float> f(65537);
+        sg_pcm16_to_float(pcm16.data(), f.data(), 65535);
+        sg_float_to_pcm16(f.data(), pcm16_out.data(), 65535);
+        for (int32_t i = 0; i < 65535; ++i) {
+            sg_assert(pcm16_out[i] == pcm16[i]);
+            sg_assert(f[i] == (i - 32768) / 32768.0f);
+        }
+
+        const int32_t values[] = { -8388608, -8388607, -65536, -1, 0, 1,
+            255, 256, 65535, 8388607, 12345 };
+        const std::size_t count = sizeof(values) / sizeof(values[0]);
+        uint8_t pcm24[3*count], pcm24_out[3*count];
+        for (std::size_t i = 0; i < count; ++i) {
+            const uint32_t u = static_cast<uint32_t>(values[i]);
+            pcm24[3*i] = uint8_t(u);
+            pcm24[3*i + 1] = uint8_t(u >> 8);
+            pcm24[3*i + 2] = uint8_t(u >> 16);
+        }
+        sg_pcm24_to_float(pcm24, f.data(), count);
+        sg_float_to_pcm24(f.data(), pcm24_out, count);
+        for (std::size_t i = 0; i < count; ++i) {
+            sg_assert(f[i] == values[i] / 8388608.0f);
+        }
+        for (std::size_t i = 0; i < 3*count; ++i) {
+            sg_assert(pcm24_out[i] == pcm24[i]);
+        }
+
+        const int32_t values32[] = { INT32_MIN, -256, 0, 256, 1 << 30,
+            2147483520 };
+        int32_t pcm32_out[6];
+        sg_pcm32_to_float(values32, f.data(), 6);
+        sg_float_to_pcm32(f.data(), pcm32_out, 6);
+        for (int32_t i = 0; i < 6; ++i) sg_assert(pcm32_out[i] == values32[i]);
+    }
+
+    // Saturation and rounding
+    {
+        const float x[] = { 1.0f, -1.0f, 1.5f, -1.5f, 1e30f, -1e30f,
+            0.5f / 32768.0f, 1.5f / 32768.0f, -0.6f / 32768.0f };
+        int16_t pcm16[9];
+        sg_float_to_pcm16(x, pcm16, 9);
+        const int16_t expected16[] = { 32767, -32768, 32767, -32768, 32767,
+            -32768, 0, 2, -1 };
+        for (int32_t i = 0; i < 9; ++i) sg_assert(pcm16[i] == expected16[i]);
+        int32_t pcm32[6];
+        sg_float_to_pcm32(x, pcm32, 6);
+        sg_assert(pcm32[0] == 2147483520 && pcm32[1] == INT32_MIN);
+        sg_assert(pcm32[4] == 2147483520 && pcm32[5] == INT32_MIN);
+        uint8_t pcm24[6];
+        sg_float_to_pcm24(x + 2, pcm24, 2);
+        sg_assert(pcm24[0] == 0xff && pcm24[1] == 0xff && pcm24[2] == 0x7f);
+        sg_assert(pcm24[3] == 0x00 && pcm24[4] == 0x00 && pcm24[5] == 0x80);
+    }
+
+    // Dithered quantization is unbiased, and stays within 3 LSB
+    for (int32_t type = 0; type < 2; ++type) {
+        SGDither dither{type == 0 ? SGDitherType::tpdf : SGDitherType::shaped,
+            1};
+        const int32_t count = 40001;
+        const float level = 0.3f / 32768.0f;
+        std::vector<float> x(count, level);
+        std::vector<int16_t> pcm(count);
+        sg_float_to_pcm16(x.data(), pcm.data(), count, &dither);
+        double sum = 0.0, diff_sum = 0.0;
+        for (int32_t i = 0; i < count; ++i) {
+            sg_assert(pcm[i] >= -3 && pcm[i] <= 3);
+            sum += pcm[i];
+            if (i > 0) diff_sum += std::abs(pcm[i] - pcm[i - 1]);
+        }
+        sg_assert(std::abs(sum / count - 0.3) < 0.02);
+        // The shaped noise has more high frequency content, so larger
+        // differences between consecutive samples
+        sg_assert(type == 0 ? diff_sum / count < 0.6 : diff_sum / count > 0.8);
+    }
+
+    // Peak and RMS
+    {
+        const float x[] = { 0.5f, -0.25f, 0.125f, -0.75f, 0.5f, -0.5f,
+            0.25f, 0.875f, -0.9f };
+        sg_assert(sg_peak(x, 9) == 0.9f);
+        sg_assert(sg_peak(x, 8) == 0.875f);
+        sg_assert(sg_peak(x, 3) == 0.5f);
+        sg_assert(sg_peak(x, 0) == 0.0f);
+        double sum = 0.0;
+        for (int32_t i = 0; i < 9; ++i) sum += double(x[i]) * x[i];
+        sg_assert(std::abs(sg_rms(x, 9) - std::sqrt(sum / 9)) < 1e-7);
+        sg_assert(sg_rms(x, 0) == 0.0f);
+        // A full scale sine has an RMS of 1/sqrt(2)
+        std::vector<float> sine(48000);
+        for (std::size_t i = 0; i < sine.size(); ++i) {
+            sine[i] = sg_sinpi(Vec_f32x1{2.0f*(i % 48) / 48.0f}).data();
+        }
+        sg_assert(std::abs(sg_rms(sine.data(), sine.size()) -
+            0.70710678) < 1e-6);
+    }
+
+    // Loudness: a 0 dBFS 997Hz sine in one channel reads -3.01 LUFS,
+    // whichever channel it is in. 5 channels uses 2 groups of 4
+    for (int32_t channel = 0; channel < 5; channel += 4) {
+        const double rate = 48000.0;
+        const std::size_t n = 480000;
+        std::vector<float> sine(n), silence(n, 0.0f);
+        for (std::size_t i = 0; i < n; ++i) {
+            sine[i] = static_cast<float>(std::sin(2.0*3.14159265358979323846*
+                997.0*static_cast<double>(i) / rate));
+        }
+        const float *channels[5];
+        for (int32_t c = 0; c < 5; ++c) channels[c] = silence.data();
+        channels[channel] = sine.data();
+        SGLoudnessMeter meter{rate, 5};
+        // Blocks of an odd length, to test sub-blocks spanning calls
+        for (std::size_t i = 0; i < n; i += 1001) {
+            const float *offset[5];
+            for (int32_t c = 0; c < 5; ++c) offset[c] = channels[c] + i;
+            meter.process(offset, std::min<std::size_t>(1001, n - i));
+        }
+        sg_assert(std::abs(meter.momentary() + 3.01) < 0.01);
+        sg_assert(std::abs(meter.short_term() + 3.01) < 0.01);
+        sg_assert(std::abs(meter.integrated() + 3.01) < 0.01);
+
+        // The same again at -30 dB falls below the relative gate. Only the
+        // gating blocks that span the change lower the integrated loudness
+        for (std::size_t i = 0; i < n; ++i) sine[i] *= 0.031622777f;
+        meter.process(channels, n);
+        sg_assert(std::abs(meter.short_term() + 33.01) < 0.01);
+        sg_assert(std::abs(meter.integrated() + 3.01) < 0.1);
+
+        // Channel weights scale the energy
+        meter.reset();
+        meter.set_channel_weight(channel, 0.5);
+        meter.process(channels, n);
+        sg_assert(std::abs(meter.integrated() + 36.02) < 0.01);
+
+        // Silence is below the absolute gate
+        meter.reset();
+        channels[channel] = silence.data();
+        meter.process(channels, n);
+        sg_assert(std::isinf(meter.integrated()));
+        sg_assert(std::isinf(meter.momentary()));
+    }
+    // Linear ramp, including a partial block at the end
+    {
+        SGRamp ramp;
+        ramp.set_target(1.0f, 6);
+        sg_assert(ramp.is_ramping());
+        const float step = 1.0f / 6.0f;
+        sg_assert(ramp.next().debug_eq(3*step, 2*step, step, 0.0f));
+        sg_assert(ramp.next(1).debug_eq(1.0f, 1.0f, 5*step, 4*step));
+        sg_assert(std::abs(ramp.next(1).get<0>() - 5*step) < 1e-7f);
+        sg_assert(!ramp.is_ramping() && ramp.value() == 1.0f);
+        sg_assert(ramp.next().debug_eq(1.0f));
+
+        // Exponential ramp: a constant ratio between samples, ending exactly
+        // on the target
+        SGRamp exp_ramp{1.0f, SGRampType::exponential};
+        exp_ramp.set_target(0.001f, 4801);
+        std::vector<float> values(4804);
+        for (std::size_t i = 0; i < values.size(); i += 4) {
+            exp_ramp.next().storeu(values.data() + i);
+        }
+        const double ratio = std::pow(0.001, 1.0 / 4801);
+        for (std::size_t i = 0; i < 4801; ++i) {
+            sg_assert(std::abs(values[i] / std::pow(ratio, double(i)) - 1.0) <
+                1e-5);
+        }
+        for (std::size_t i = 4801; i < values.size(); ++i) {
+            sg_assert(values[i] == 0.001f);
+        }
+    }
+
+    // Gain, crossfade, pan and mix
+    {
+        const float x[] = { 1.0f, -2.0f, 3.0f, -4.0f, 5.0f, -6.0f, 7.0f };
+        const float y[] = { 0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f };
+        float out[7], out2[7];
+
+        SGRamp gain{2.0f};
+        sg_apply_gain(x, out, 7, gain);
+        for (int32_t i = 0; i < 7; ++i) sg_assert(out[i] == 2.0f*x[i]);
+        gain.set_target(0.0f, 4);
+        sg_apply_gain(x, out, 7, gain);
+        const float expected[] = { 2.0f, -3.0f, 3.0f, -2.0f, 0.0f, 0.0f,
+            0.0f };
+        for (int32_t i = 0; i < 7; ++i) sg_assert(out[i] == expected[i]);
+
+        SGRamp position{0.0f};
+        sg_crossfade(x, y, out, 7, position);
+        for (int32_t i = 0; i < 7; ++i) sg_assert(out[i] == x[i]);
+        position.set_value(1.0f);
+        sg_crossfade(x, y, out, 7, position);
+        for (int32_t i = 0; i < 7; ++i) sg_assert(out[i] == y[i]);
+        // Equal power: the two gains are the sine and cosine of one angle
+        const float one[] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f },
+            zero[] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+        position.set_value(0.0f);
+        position.set_target(1.0f, 7);
+        sg_crossfade(one, zero, out, 7, position);
+        position.set_value(0.0f);
+        position.set_target(1.0f, 7);
+        sg_crossfade(zero, one, out2, 7, position);
+        for (int32_t i = 0; i < 7; ++i) {
+            sg_assert(std::abs(out[i]*out[i] + out2[i]*out2[i] - 1.0f) <
+                1e-6f);
+            sg_assert(i == 0 || out2[i] > out2[i - 1]);
+        }
+
+        SGRamp pan{0.0f};
+        sg_pan(x, out, out2, 7, pan);
+        for (int32_t i = 0; i < 7; ++i) {
+            sg_assert(std::abs(out[i] - x[i]*0.70710678f) < 1e-6f);
+            sg_assert(out[i] == out2[i]);
+        }
+        pan.set_value(-1.0f);
+        sg_pan(x, out, out2, 7, pan);
+        for (int32_t i = 0; i < 7; ++i) {
+            sg_assert(out[i] == x[i] && out2[i] == 0.0f);
+        }
+
+        const float *inputs[] = { x, y, one };
+        const float gains[] = { 2.0f, -1.0f, 0.25f };
+        for (int32_t i = 0; i < 7; ++i) out[i] = 1.0f;
+        sg_mix_accumulate(inputs, gains, 3, out, 7);
+        for (int32_t i = 0; i < 7; ++i) {
+            sg_assert(out[i] == 1.0f + 2.0f*x[i] - 0.5f + 0.25f);
+        }
+        sg_mix_accumulate(inputs, nullptr, 2, out, 5);
+        sg_assert(out[4] == 1.0f + 3.0f*x[4] + 0.25f && out[5] ==
+            1.0f + 2.0f*x[5] - 0.25f);
+    }
+    // Envelope follower: rising elements use the attack coefficient, and
+    // falling elements use the release coefficient
+    {
+        SGEnvelopeFollower follower{1000.0f, 1.0f, 10.0f};
+        const float attack = std::exp(-1.0f), release = std::exp(-0.1f);
+        Vec_ps env = follower.process(Vec_ps{0.0f, 0.0f, 1.0f, 1.0f});
+        sg_assert(std::abs(env.get<0>() - (1.0f - attack)) < 1e-6f);
+        sg_assert(env.get<3>() == 0.0f);
+        env = follower.process(Vec_ps{1.0f, 1.0f, 0.0f, 0.0f});
+        sg_assert(std::abs(env.get<0>() - (1.0f - attack)*release) < 1e-6f);
+        sg_assert(std::abs(env.get<3>() - (1.0f - attack)) < 1e-6f);
+
+        follower.reset();
+        const float x[] = { -1.0f, -1.0f, 0.0f }, y[] = { 0.5f, 0.0f, 0.0f };
+        float env_x[3], env_y[3];
+        const float *in[] = { x, y };
+        float *out[] = { env_x, env_y };
+        follower.process(in, out, 2, 3);
+        sg_assert(std::abs(env_x[1] - (1.0f - attack*attack)) < 1e-6f);
+        sg_assert(std::abs(env_y[0] - 0.5f*(1.0f - attack)) < 1e-6f);
+        sg_assert(std::abs(env_x[2] - env_x[1]*release) < 1e-6f);
+    }
+
+    // Soft knee gain computer: threshold -20 dB, ratio 4, knee 10 dB
+    {
+        const Vec_ps db = sg_gain_computer_db(Vec_ps{0.0f, -15.0f, -20.0f,
+            -40.0f}, -20.0f, 4.0f, 10.0f);
+        sg_assert(db.get<3>() == -15.0f && db.get<0>() == 0.0f);
+        sg_assert(std::abs(db.get<2>() + 3.75f) < 1e-6f);
+        sg_assert(std::abs(db.get<1>() + 0.9375f) < 1e-6f);
+        // The knee meets the straight lines at its edges
+        const Vec_ps edge = sg_gain_computer_db(Vec_ps{-15.0001f, -14.9999f,
+            -24.9999f, -25.0001f}, -20.0f, 4.0f, 10.0f);
+        sg_assert(std::abs(edge.get<3>() - edge.get<2>()) < 1e-3f);
+        sg_assert(std::abs(edge.get<1>() - edge.get<0>()) < 1e-3f);
+        sg_assert(edge.get<0>() == 0.0f);
+        // Hard knee
+        sg_assert(sg_gain_computer_db(Vec_ps{-10.0f, -20.0f, -20.0f, -30.0f},
+            -20.0f, 2.0f, 0.0f).debug_eq(-5.0f, 0.0f, 0.0f, 0.0f));
+        // 0 dB and -10 dB are reduced by 15 dB and 7.5 dB
+        const Vec_ps gain = sg_compressor_gain(Vec_ps{1.0f, 0.31622777f,
+            0.01f, 0.0f}, -20.0f, 4.0f, 0.0f);
+        sg_assert(std::abs(gain.get<3>() - 0.17782794f) < 1e-6f);
+        sg_assert(std::abs(gain.get<2>() - 0.42169650f) < 1e-6f);
+        sg_assert(gain.get<1>() == 1.0f && gain.get<0>() == 1.0f);
+    }
+
+    // Sliding maximum
+    {
+        const float x[] = { 1.0f, 5.0f, 2.0f, 3.0f, 0.0f, -1.0f, 4.0f, 0.0f,
+            -2.0f, -3.0f };
+        float out[8];
+        sg_sliding_max_kernel(x, 3, out, 8);
+        const float expected[] = { 5.0f, 5.0f, 3.0f, 3.0f, 4.0f, 4.0f, 4.0f,
+            0.0f };
+        for (int32_t i = 0; i < 8; ++i) sg_assert(out[i] == expected[i]);
+    }
+
+    // Sliding max and min against a direct loop, for short windows and the
+    // block algorithm, and streaming in blocks of odd lengths
+    {
+        SGXorshift128Plus gen{5};
+        std::vector<float> x(1200);
+        for (std::size_t i = 0; i < x.size(); i += 4) {
+            sg_random_bipolar(gen).storeu(x.data() + i);
+        }
+        const std::size_t windows[] = { 1, 3, 15, 16, 17, 64, 333 };
+        for (const std::size_t window : windows) {
+            const std::size_t n = x.size() - window + 1;
+            std::vector<float> out_max(n), out_min(n), stream(x.size());
+            sg_sliding_max_kernel(x.data(), window, out_max.data(), n);
+            sg_sliding_min_kernel(x.data(), window, out_min.data(), n);
+            for (std::size_t i = 0; i < n; ++i) {
+                sg_assert(out_max[i] == *std::max_element(x.begin() + i,
+                    x.begin() + i + window));
+                sg_assert(out_min[i] == *std::min_element(x.begin() + i,
+                    x.begin() + i + window));
+            }
+            SGSlidingMax sliding_max{window};
+            SGSlidingMin sliding_min{window};
+            for (std::size_t i = 0; i < x.size(); i += 37) {
+                const std::size_t count = std::min<std::size_t>(37,
+                    x.size() - i);
+                sliding_max.process(x.data() + i, stream.data() + i, count);
+            }
+            for (std::size_t i = 0; i < x.size(); ++i) {
+                const std::size_t begin = i + 1 >= window ? i + 1 - window : 0;
+                sg_assert(stream[i] == *std::max_element(x.begin() + begin,
+                    x.begin() + i + 1));
+            }
+            // In place, in one block
+            stream = x;
+            sliding_min.process(stream.data(), stream.data(), stream.size());
+            for (std::size_t i = window - 1; i < x.size(); ++i) {
+                sg_assert(stream[i] == out_min[i + 1 - window]);
+            }
+            sliding_min.reset();
+            sliding_min.process(x.data(), stream.data(), 1);
+            sg_assert(stream[0] == x[0]);
+        }
+    }
+
+    // Lookahead limiter: a loud stereo burst never exceeds the ceiling, and
+    // once the input is quiet again, the output is the delayed input
+    {
+        const float rate = 48000.0f;
+        const std::size_t n = 24000;
+        std::vector<float> left(n), right(n), out_l(n), out_r(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            const float level = i >= 4800 && i < 9600 ? 4.0f : 0.25f;
+            left[i] = level * sg_sinpi(Vec_f32x1{float(i % 48) / 24.0f})
+                .data();
+            right[i] = i == 6000 ? 8.0f : 0.5f*left[i];
+        }
+        SGLookaheadLimiter limiter{2, rate, 0.5f, 2.0f, 20.0f, 100};
+        sg_assert(limiter.latency() == 95);
+        const float *in[] = { left.data(), right.data() };
+        float *out[] = { out_l.data(), out_r.data() };
+        // Blocks of an odd length, to test state carried across calls
+        for (std::size_t i = 0; i < n; i += 333) {
+            const float *in_offset[] = { in[0] + i, in[1] + i };
+            float *out_offset[] = { out[0] + i, out[1] + i };
+            limiter.process(in_offset, out_offset,
+                std::min<std::size_t>(333, n - i));
+        }
+        sg_assert(sg_peak(out_l.data(), n) <= 0.5f + 1e-6f);
+        sg_assert(sg_peak(out_r.data(), n) <= 0.5f + 1e-6f);
+        sg_assert(sg_peak(out_r.data(), n) > 0.49f);
+        // Until the lookahead reaches the burst
+        for (std::size_t i = 0; i < 4500; ++i) {
+            sg_assert(out_l[i + 95] == left[i]);
+        }
+        for (std::size_t i = 20000; i < n - 95; ++i) {
+            sg_assert(std::abs(out_l[i + 95] - left[i]) < 1e-4f);
+        }
+
+        // In place
+        limiter.reset();
+        limiter.process(in, out, n);
+        std::vector<float> left_copy(left), right_copy(right);
+        float *in_place[] = { left_copy.data(), right_copy.data() };
+        limiter.reset();
+        limiter.process(in_place, in_place, n);
+        sg_assert(left_copy == out_l && right_copy == out_r);
+    }
+    // Interpolation
+    sg_assert(sg_interp_linear(Vec_ps{1.0f}, Vec_ps{3.0f},
+        Vec_ps{1.0f, 0.75f, 0.5f, 0.0f}).debug_eq(3.0f, 2.5f, 2.0f, 1.0f));
+    sg_assert(sg_interp_hermite(Vec_ps{0.0f}, Vec_ps{1.0f}, Vec_ps{2.0f},
+        Vec_ps{3.0f}, Vec_ps{1.0f, 0.75f, 0.25f, 0.0f})
+        .debug_eq(2.0f, 1.75f, 1.25f, 1.0f));
+    sg_assert(sg_interp_hermite(Vec_f32x1{0.0f}, Vec_f32x1{1.0f},
+        Vec_f32x1{0.0f}, Vec_f32x1{-1.0f}, Vec_f32x1{0.5f}).data() ==
+        0.625f);
+
+    // Delay line: channel 0 is a ramp, channel 1 is a sine. Blocks of odd
+    // lengths wrap around the ring buffer many times
+    {
+        SGDelayLine delay{100, 2, 64};
+        std::vector<float> ramp(5000), sine(5000);
+        for (std::size_t i = 0; i < ramp.size(); ++i) {
+            ramp[i] = static_cast<float>(i);
+            sine[i] = std::sin(0.05f*static_cast<float>(i));
+        }
+        float out[64], out2[64], delays[64];
+        std::size_t t = 0;
+        for (std::size_t block = 1; t + block <= ramp.size();
+            block = block % 57 + 7)
+        {
+            const float *in[] = { ramp.data() + t, sine.data() + t };
+            delay.write(in, block);
+            // Whole and fractional delays reproduce a ramp exactly
+            const float ramp_delays[] = { 0.0f, 1.0f, 2.25f, 37.5f, 100.0f };
+            for (int32_t interp = 0; interp < 3; ++interp) {
+                const SGInterpType type = static_cast<SGInterpType>(interp);
+                for (const float d : ramp_delays) {
+                    if (d < interp) continue;
+                    delay.read(0, d, out, block, type);
+                    for (std::size_t i = 0; i < block; ++i) {
+                        const float expected = type == SGInterpType::none ?
+                            std::floor(t + i - d + 0.5f) : t + i - d;
+                        sg_assert(t + i < d + 2 || out[i] == expected);
+                    }
+                }
+            }
+            // Modulated delays give the same result as fixed delays
+            for (std::size_t i = 0; i < block; ++i) {
+                delays[i] = 2.0f + 90.0f*(0.5f + 0.5f*std::sin(0.01f*(t + i)));
+            }
+            for (int32_t interp = 0; interp < 3; ++interp) {
+                const SGInterpType type = static_cast<SGInterpType>(interp);
+                delay.read_modulated(1, delays, out, block, type);
+                for (std::size_t i = 0; i < block; ++i) {
+                    delay.read(1, delays[i], out2, block, type);
+                    sg_assert(t + i < 100 || std::abs(out[i] - out2[i]) <
+                        1e-5f);
+                }
+            }
+            // Taps sum
+            const float tap_delays[] = { 3.0f, 10.5f }, gains[] = { 0.5f,
+                -2.0f };
+            delay.read_taps(0, tap_delays, gains, 2, out, block);
+            for (std::size_t i = 0; i < block; ++i) {
+                sg_assert(t + i < 20 || out[i] == 0.5f*(t + i - 3.0f) -
+                    2.0f*(t + i - 10.5f));
+            }
+            t += block;
+        }
+        // Hermite interpolation of a sine is accurate
+        delay.read(1, 10.5f, out, 7, SGInterpType::hermite);
+        for (std::size_t i = 0; i < 7; ++i) {
+            sg_assert(std::abs(out[i] - std::sin(0.05f*(t - 7 + i - 10.5f))) <
+                1e-5f);
+        }
+    }
+}
+
+static void test_random() {
+    // Known answers from the Random123 and PCG reference implementations
+    {
+        Vec_pi32 c0, c1, c2, c3;
+        sg_philox4x32_10(c0, c1, c2, c3, Vec_pi32{}, Vec_pi32{});
+        sg_assert(c0.debug_eq(int32_t(0x6627e8d5)));
+        sg_assert(c1.debug_eq(int32_t(0xe169c58d)));
+        sg_assert(c2.debug_eq(int32_t(0xbc57ac4c)));
+        sg_assert(c3.debug_eq(int32_t(0x9b00dbd8)));
+        c0 = c1 = c2 = c3 = Vec_pi32{-1};
+        sg_philox4x32_10(c0, c1, c2, c3, Vec_pi32{-1}, Vec_pi32{-1});
+        sg_assert(c0.debug_eq(int32_t(0x408f276d)));
+        sg_assert(c3.debug_eq(int32_t(0x6d5451fd)));
+
+        // Block 0 of stream 0, with a key of 0, is in element 0
+        SGPhilox4x32 philox;
+        sg_assert(philox.next_pi32().get<0>() == int32_t(0x6627e8d5));
+        sg_assert(philox.next_pi32().get<0>() == int32_t(0xe169c58d));
+        philox.seek(0);
+        sg_assert(philox.next_pi32().get<0>() == int32_t(0x6627e8d5));
+    }
+    {
+        // pcg32_srandom_r(42, 54), where 54 = 4*13 + 2
+        SGPcg32 pcg{42, 13};
+        const uint32_t expected[] = { 0xa15c02b7, 0x7b47f409, 0xba1d3330,
+            0x83d2f293, 0xbfa4784b, 0xcbed606e };
+        for (int32_t i = 0; i < 6; ++i) {
+            sg_assert(pcg.next_pi32().get<2>() == int32_t(expected[i]));
+        }
+    }
+    {
+        // Scalar xorshift128+, seeded the same way
+        uint64_t seed = 7, s[4][2];
+        for (int32_t i = 0; i < 4; ++i) {
+            s[i][0] = sg_splitmix64_(seed);
+            s[i][1] = sg_splitmix64_(seed);
+        }
+        SGXorshift128Plus xorshift{7};
+        for (int32_t n = 0; n < 10; ++n) {
+            const Vec_pi32 v = xorshift.next_pi32();
+            int32_t expected[4];
+            for (int32_t i = 0; i < 4; ++i) {
+                uint64_t x = s[i][0];
+                const uint64_t y = s[i][1];
+                expected[i] = int32_t((x + y) >> 32);
+                s[i][0] = y;
+                x ^= x << 23;
+                s[i][1] = x ^ y ^ (x >> 18) ^ (y >> 5);
+            }
+            sg_assert(v.debug_eq(expected[3], expected[2], expected[1],
+                expected[0]));
+        }
+    }
+
+    // Statistics of each distribution, for each generator
+    const int32_t n = 100000;
+    for (int32_t gen_index = 0; gen_index < 3; ++gen_index) {
+        SGXorshift128Plus xorshift{1};
+        SGPcg32 pcg{1};
+        SGPhilox4x32 philox{1};
+        double sum_u = 0.0, sum_u2 = 0.0, sum_b = 0.0, sum_g = 0.0,
+            sum_g2 = 0.0;
+        int32_t within_1 = 0, bins[16] = { 0 };
+        for (int32_t i = 0; i < n; ++i) {
+            Vec_pi32 bits;
+            Vec_ps u, b, g0, g1;
+            if (gen_index == 0) {
+                bits = xorshift.next_pi32(); u = sg_random_unit(xorshift);
+                b = sg_random_bipolar(xorshift);
+                sg_random_gaussian_pair(xorshift, g0, g1);
+            } else if (gen_index == 1) {
+                bits = pcg.next_pi32(); u = sg_random_unit(pcg);
+                b = sg_random_bipolar(pcg);
+                sg_random_gaussian_pair(pcg, g0, g1);
+            } else {
+                bits = philox.next_pi32(); u = sg_random_unit(philox);
+                b = sg_random_bipolar(philox);
+                sg_random_gaussian_pair(philox, g0, g1);
+            }
+            sg_assert((u >= 0.0f && u < 1.0f).debug_valid_eq(true));
+            sg_assert((b >= -1.0f && b < 1.0f).debug_valid_eq(true));
+            int32_t bits_array[4];
+            float u_array[4], b_array[4], g_array[8];
+            bits.storeu(bits_array);
+            u.storeu(u_array); b.storeu(b_array);
+            g0.storeu(g_array); g1.storeu(g_array + 4);
+            for (int32_t j = 0; j < 4; ++j) {
+                ++bins[uint32_t(bits_array[j]) >> 28];
+                sum_u += u_array[j]; sum_u2 += u_array[j]*u_array[j];
+                sum_b += b_array[j];
+            }
+            for (int32_t j = 0; j < 8; ++j) {
+                sum_g += g_array[j]; sum_g2 += g_array[j]*g_array[j];
+                if (std::abs(g_array[j]) < 1.0f) ++within_1;
+            }
+        }
+        const double count = 4.0*n;
+        sg_assert(std::abs(sum_u / count - 0.5) < 0.005);
+        sg_assert(std::abs(sum_u2 / count - 1.0/3.0) < 0.005);
+        sg_assert(std::abs(sum_b / count) < 0.01);
+        sg_assert(std::abs(sum_g / (2.0*count)) < 0.01);
+        sg_assert(std::abs(sum_g2 / (2.0*count) - 1.0) < 0.01);
+        sg_assert(std::abs(within_1 / (2.0*count) - 0.6827) < 0.005);
+        // Chi-squared test of the top 4 bits, with 15 degrees of freedom.
+        // 37.7 is the 0.1% critical value
+        double chi2 = 0.0;
+        for (int32_t j = 0; j < 16; ++j) {
+            const double diff = bins[j] - count / 16.0;
+            chi2 += diff*diff / (count / 16.0);
+        }
+        sg_assert(chi2 < 37.7);
+    }
+}
+
+
+static void test_memory() {
+    // Ring buffer, from one thread. The capacity rounds up to 8, and pushing
+    // and popping 3 at a time wraps around the end
+    {
+        SGSpscRing<Vec_ps> ring{5};
+        sg_assert(ring.capacity() == 8);
+        sg_assert(ring.read_available() == 0 && ring.write_available() == 8);
+        Vec_ps in[10], out[10];
+        for (int32_t i = 0; i < 10; ++i) in[i] = Vec_ps{float(i)};
+        sg_assert(ring.push(in, 10) == 8);
+        sg_assert(ring.push(in, 1) == 0);
+        sg_assert(ring.pop(out, 3) == 3);
+        sg_assert(out[2].debug_eq(2.0f));
+        int32_t next_in = 8, next_out = 3;
+        for (int32_t round = 0; round < 10; ++round) {
+            for (int32_t i = 0; i < 3; ++i) in[i] = Vec_ps{float(next_in + i)};
+            sg_assert(ring.push(in, 3) == 3);
+            next_in += 3;
+            sg_assert(ring.pop(out, 3) == 3);
+            for (int32_t i = 0; i < 3; ++i) {
+                sg_assert(out[i].debug_eq(float(next_out + i)));
+            }
+            next_out += 3;
+        }
+
+        // In place access: the span stops at the end of the buffer
+        std::size_t count;
+        const Vec_ps *read = ring.read_span(count);
+        sg_assert(count > 0 && count <= 5 && read[0].debug_eq(float(next_out)));
+        ring.commit_read(count);
+        next_out += static_cast<int32_t>(count);
+        Vec_ps *write = ring.write_span(count);
+        sg_assert(count > 0);
+        write[0] = Vec_ps{float(next_in)};
+        ring.commit_write(1);
+        ++next_in;
+        while (ring.read_available() > 0) {
+            sg_assert(ring.pop(out, 1) == 1);
+            sg_assert(out[0].debug_eq(float(next_out)));
+            ++next_out;
+        }
+        sg_assert(next_out == next_in);
+    }
+
+    // Ring buffer, between two threads. Every element arrives, in order
+    {
+        SGSpscRing<Vec_pi32> ring{64};
+        const int32_t total = 100000;
+        std::thread producer{[&ring]() {
+            Vec_pi32 block[7];
+            int32_t sent = 0;
+            while (sent < total) {
+                const int32_t count = std::min(7, total - sent);
+                for (int32_t i = 0; i < count; ++i) {
+                    block[i] = Vec_pi32{sent + i};
+                }
+                int32_t pushed = 0;
+                while (pushed < count) {
+                    const std::size_t n = ring.push(block + pushed,
+                        count - pushed);
+                    if (n == 0) std::this_thread::yield();
+                    pushed += static_cast<int32_t>(n);
+                }
+                sent += count;
+            }
+        }};
+        int32_t received = 0;
+        bool in_order = true;
+        while (received < total) {
+            std::size_t count;
+            const Vec_pi32 *span = ring.read_span(count);
+            if (count == 0) std::this_thread::yield();
+            for (std::size_t i = 0; i < count; ++i) {
+                if (!span[i].debug_eq(received)) in_order = false;
+                ++received;
+            }
+            ring.commit_read(count);
+        }
+        producer.join();
+        sg_assert(in_order && ring.read_available() == 0);
+    }
+
+    // Structure of arrays
+    {
+        struct Particle { float x, y, z; int32_t id; float mass; };
+        typedef SGSoa<float, float, float, int32_t, float> Particles;
+        Particles soa{13};
+        sg_assert(soa.capacity() == 16 && soa.size() == 0);
+        Particle in[18], out[18];
+        for (int32_t i = 0; i < 18; ++i) {
+            in[i] = Particle{float(i), float(2*i), float(-i), 100 + i,
+                0.5f*float(i)};
+        }
+        soa.assign_aos(in, 18);
+        sg_assert(soa.size() == 16 && soa.group_count() == 4);
+        sg_assert(soa.load<0>(1).debug_eq(7.0f, 6.0f, 5.0f, 4.0f));
+        sg_assert(soa.load<3>(3).debug_eq(115, 114, 113, 112));
+        sg_assert(soa.get<4>(9) == 4.5f && soa.get<2>(15) == -15.0f);
+        soa.copy_to_aos(out);
+        for (int32_t i = 0; i < 16; ++i) {
+            sg_assert(out[i].x == in[i].x && out[i].y == in[i].y &&
+                out[i].z == in[i].z && out[i].id == in[i].id &&
+                out[i].mass == in[i].mass);
+        }
+
+        // Keep the even ids, in order
+        sg_assert(soa.compact([&soa](const std::size_t g) {
+            return (soa.load<3>(g) & 1) == 0;
+        }) == 8);
+        for (int32_t i = 0; i < 8; ++i) {
+            sg_assert(soa.get<3>(i) == 100 + 2*i &&
+                soa.get<0>(i) == float(2*i));
+        }
+        sg_assert(soa.load<1>(1).debug_eq(28.0f, 24.0f, 20.0f, 16.0f));
+
+        soa.swap_remove(2);
+        sg_assert(soa.size() == 7 && soa.get<3>(2) == 114 &&
+            soa.get<4>(2) == 7.0f);
+        sg_assert(soa.push_back(1.0f, 2.0f, 3.0f, 4, 5.0f));
+        sg_assert(soa.size() == 8 && soa.get<3>(7) == 4 &&
+            soa.get<2>(7) == 3.0f);
+        soa.store<4>(0, soa.load<4>(0) * 2.0f);
+        sg_assert(soa.get<4>(1) == 2.0f);
+
+        // Uneven sizes go through the scalar path, and compact() ignores
+        // the padding lanes
+        soa.assign_aos(in + 1, 6);
+        sg_assert(soa.compact([](const std::size_t) {
+            return Compare_ps{true};
+        }) == 6);
+        soa.copy_to_aos(out);
+        for (int32_t i = 0; i < 6; ++i) {
+            sg_assert(out[i].id == in[i + 1].id && out[i].y == in[i + 1].y &&
+                out[i].mass == in[i + 1].mass);
+        }
+        for (int32_t i = 0; i < 16; ++i) {
+            sg_assert(soa.push_back(0.0f, 0.0f, 0.0f, i, 0.0f) == (i < 10));
+        }
+    }
+
+    // Bitset scanning. The set bits are spread out so that the scans skip
+    // empty groups of words, with a partial group at the end
+    {
+        std::vector<uint32_t> words(203, 0);
+        std::vector<std::size_t> bits;
+        for (std::size_t i = 5; i < 32*words.size(); i += 1 + (i*i % 347)) {
+            words[i/32] |= uint32_t(1) << (i % 32);
+            bits.push_back(i);
+        }
+        words.back() |= uint32_t(1) << 31;
+        bits.push_back(32*words.size() - 1);
+        sg_assert(sg_bitset_count(words.data(), words.size()) == bits.size());
+        std::vector<std::size_t> found;
+        sg_bitset_for_each(words.data(), words.size(),
+            [&found](const std::size_t i) { found.push_back(i); });
+        sg_assert(found == bits);
+        std::size_t next = 0;
+        for (std::size_t k = 0; k < bits.size(); ++k) {
+            next = sg_bitset_find_next(words.data(), words.size(), next);
+            sg_assert(next == bits[k]);
+            ++next;
+        }
+        sg_assert(sg_bitset_find_next(words.data(), words.size(), next) ==
+            SIZE_MAX);
+        sg_assert(sg_bitset_find_next(words.data(), 3, 96) == SIZE_MAX);
+        sg_assert(sg_bitset_find_next(words.data(), words.size(),
+            bits[3] + 1) == bits[4]);
+    }
+
+    // Arena
+    {
+        SGArena arena{1000};
+        sg_assert(arena.capacity() == 1024 && arena.used() == 0);
+        Vec_ps *const a = arena.alloc<Vec_ps>(5);
+        sg_assert(a != nullptr && a[4].debug_eq(0.0f));
+        sg_assert(reinterpret_cast<std::uintptr_t>(a) % 64 == 0);
+        for (int32_t i = 0; i < 5; ++i) a[i] = Vec_ps{float(i)};
+        const std::size_t after_a = arena.used();
+        {
+            SGArenaScope scope{arena};
+            float *const b = arena.alloc<float>(3);
+            sg_assert(b != nullptr &&
+                reinterpret_cast<std::uintptr_t>(b) % 64 == 0);
+            sg_assert(reinterpret_cast<char*>(b) >=
+                reinterpret_cast<char*>(a + 5));
+            b[0] = b[1] = b[2] = 1.0f;
+            sg_assert(arena.used() > after_a && arena.guards_intact());
+        }
+        sg_assert(arena.used() == after_a && a[4].debug_eq(4.0f));
+        const std::size_t peak = arena.peak();
+        sg_assert(peak > after_a);
+
+        // Per block reuse hands back the same memory
+        arena.reset();
+        sg_assert(arena.used() == 0 && arena.alloc<Vec_ps>(5) == a);
+        sg_assert(arena.peak() == peak && !arena.overflowed());
+
+        #ifdef NDEBUG
+        // Release builds return nullptr rather than asserting
+        sg_assert(arena.alloc<Vec_pd>(100) == nullptr && arena.overflowed());
+        sg_assert(arena.alloc<Vec_pd>(SIZE_MAX/8) == nullptr);
+        arena.clear_overflowed();
+        sg_assert(!arena.overflowed());
+        #else
+        // Writing past the end of an allocation is caught by the guard
+        arena.reset();
+        int32_t *const c = arena.alloc<int32_t>(4);
+        sg_assert(arena.guards_intact());
+        c[4] = 1;
+        sg_assert(!arena.guards_intact());
+        #endif
+    }
+}
+
+static void test_fixed() {
+    // Q31. Conversion saturates to the largest float below 1.0
+    sg_assert(SGQ31::from_ps(Vec_ps(1.0f, -1.0f, 0.5f, -0.25f)).raw()
+        .debug_eq(2147483520, INT32_MIN, 1 << 30, -(1 << 29)));
+    sg_assert(SGQ31::from_ps(Vec_ps(2.0f, -3.0f, 0.0f, 1.0f/1073741824.0f))
+        .raw().debug_eq(2147483520, INT32_MIN, 0, 2));
+    sg_assert(SGQ31{Vec_pi32(INT32_MIN, 1 << 30, -(1 << 30), 3)}.to_ps()
+        .debug_eq(-1.0f, 0.5f, -0.5f, 3.0f/2147483648.0f));
+    {
+        const SGQ31 a{Vec_pi32(INT32_MIN, INT32_MAX, 1 << 30, -(1 << 30))},
+            b{Vec_pi32(INT32_MIN, 1, 1 << 30, 1 << 29)};
+        sg_assert((a + b).raw().debug_eq(INT32_MIN, INT32_MAX, INT32_MAX,
+            -(1 << 29)));
+        sg_assert((a - b).raw().debug_eq(0, INT32_MAX - 1, 0, -(3 << 29)));
+        sg_assert((-a).raw().debug_eq(INT32_MAX, -INT32_MAX, -(1 << 30),
+            1 << 30));
+        sg_assert((a * b).raw().debug_eq(INT32_MAX, 1, 1 << 29, -(1 << 28)));
+        sg_assert(a.mul_add(b, b).raw().debug_eq(-1, 2, 3 << 29, 1 << 28));
+    }
+
+    // Q15, bit-exact against a scalar reference
+    {
+        int16_t s[8] = { -32768, 32767, 16384, -16384, 1, -1, 0, 12345 };
+        const SGQ15 lo = SGQ15::loadu(s), hi = SGQ15::loadu(s + 4);
+        sg_assert(lo.raw().debug_eq(-16384, 16384, 32767, -32768));
+        sg_assert(lo.to_ps().debug_eq(-0.5f, 0.5f, 32767.0f/32768.0f, -1.0f));
+        sg_assert((lo * lo).raw().debug_eq(8192, 8192, 32766, 32767));
+        sg_assert((lo + lo).raw().debug_eq(-32768, 32767, 32767, -32768));
+        sg_assert((-lo).raw().debug_eq(16384, -16384, -32767, 32767));
+        sg_assert(SGQ15::from_ps(Vec_ps(1.0f, -2.0f, 0.25f, 1.0f/65536.0f))
+            .raw().debug_eq(32767, -32768, 8192, 0));
+        int16_t out[8];
+        SGQ15::storeu(out, lo * hi, hi.mul_add(lo, lo));
+        uint32_t state = 1;
+        for (int32_t i = 0; i < 8; ++i) {
+            const int32_t a = s[i], b = s[(i + 4) % 8];
+            const int32_t prod = i < 4 ? a*b : a*b + b*32768;
+            int32_t expected = (prod + 16384) >> 15;
+            expected = std::min(32767, std::max(-32768, expected));
+            sg_assert(out[i] == expected);
+        }
+        for (int32_t i = 0; i < 1000; ++i) {
+            int16_t x[4], y[4], z[4], result[4];
+            for (int32_t j = 0; j < 4; ++j) {
+                state = state*1664525u + 1013904223u;
+                x[j] = static_cast<int16_t>(state >> 16);
+                y[j] = static_cast<int16_t>(state);
+                state = state*1664525u + 1013904223u;
+                z[j] = static_cast<int16_t>(state >> 8);
+            }
+            SGQ15::loadu(x).mul_add(SGQ15::loadu(y), SGQ15::loadu(z))
+                .storeu(result);
+            for (int32_t j = 0; j < 4; ++j) {
+                const int32_t expected = (int32_t(x[j])*y[j] +
+                    int32_t(z[j])*32768 + 16384) >> 15;
+                sg_assert(result[j] == std::min(32767,
+                    std::max(-32768, expected)));
+            }
+        }
+    }
+}
+
+static void test_array() {
+    // Scans, against a scalar loop, for lengths with and without a partial
+    // vector at the end, serial and parallel, and in place
+    for (std::size_t n = 0; n < 40; n += 3) {
+        for (std::size_t threads = 1; threads <= 3; ++threads) {
+            std::vector<int32_t> in_i(n), out_i(n);
+            std::vector<double> in_d(n), out_d(n);
+            std::vector<float> data_f(n);
+            int32_t sum_i = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                in_i[i] = int32_t(i*i % 13) - 6;
+                in_d[i] = 0.5*double(in_i[i]);
+                data_f[i] = 0.25f*float(in_i[i]);
+            }
+            sg_assert(sg_inclusive_scan(in_i.data(), out_i.data(), n,
+                threads) == sg_exclusive_scan(in_i.data(), in_i.data(), n,
+                    threads));
+            for (std::size_t i = 0; i < n; ++i) {
+                sg_assert(in_i[i] == sum_i);
+                sum_i += int32_t(i*i % 13) - 6;
+                sg_assert(out_i[i] == sum_i);
+            }
+            // Small integers in floating point, so the sums are exact in
+            // any order
+            const double total_d = sg_exclusive_scan(in_d.data(),
+                out_d.data(), n, threads);
+            const float total_f = sg_inclusive_scan(data_f.data(),
+                data_f.data(), n, threads);
+            sg_assert(total_d == 0.5*double(sum_i) &&
+                total_f == 0.25f*float(sum_i));
+            double check_d = 0.0;
+            for (std::size_t i = 0; i < n; ++i) {
+                sg_assert(out_d[i] == check_d);
+                check_d += in_d[i];
+                sg_assert(data_f[i] == 0.5f*float(check_d));
+            }
+        }
+    }
+    {
+        int64_t in[5] = { 1, -2, 3, -4, 5000000000 }, out[5];
+        sg_assert(sg_inclusive_scan(in, out, 5) == 4999999998);
+        sg_assert(out[0] == 1 && out[1] == -1 && out[3] == -2 &&
+            out[4] == 4999999998);
+    }
+    {
+        // Mixed magnitudes in the scalar tail: the exclusive value mustn't be
+        // recovered by subtracting the element back out
+        const float in3[3] = { 0.1f, 1e10f, 1.0f },
+            in6[6] = { 1.0f, 2.0f, 3.0f, 4.0f, 1e10f, 1.0f };
+        float out3[3], out6[6];
+        sg_exclusive_scan(in3, out3, 3);
+        sg_assert(out3[0] == 0.0f && out3[1] == 0.1f &&
+            out3[2] == 0.1f + 1e10f);
+        sg_assert(sg_exclusive_scan(in6, out6, 6) == 10.0f + 1e10f + 1.0f);
+        sg_assert(out6[4] == 10.0f && out6[5] == 10.0f + 1e10f);
+        // Integer sums wrap in the tail, as they do in the vector path
+        const int32_t in_i[3] = { INT32_MAX, 1, 1 };
+        int32_t out_i[3];
+        sg_assert(sg_inclusive_scan(in_i, out_i, 3) == INT32_MIN + 1);
+        sg_assert(out_i[0] == INT32_MAX && out_i[1] == INT32_MIN);
+        // and when the block totals are combined for a parallel scan
+        int32_t in16[16], out16[16];
+        std::fill(in16, in16 + 16, 0);
+        in16[0] = INT32_MAX; in16[8] = 1; in16[15] = 1;
+        std::size_t threads;
+        for (threads = 1; threads <= 4; ++threads) {
+            sg_assert(sg_inclusive_scan(in16, out16, 16, threads) ==
+                INT32_MIN + 1);
+            sg_assert(out16[7] == INT32_MAX && out16[8] == INT32_MIN &&
+                out16[15] == INT32_MIN + 1);
+            sg_assert(sg_exclusive_scan(in16, out16, 16, threads) ==
+                INT32_MIN + 1);
+            sg_assert(out16[8] == INT32_MAX && out16[9] == INT32_MIN &&
+                out16[15] == INT32_MIN);
+        }
+    }
+
+    // Argmax, argmin and find first, against std::max_element etc, with the
+    // extremes at each position and repeated
+    for (std::size_t n = 1; n < 20; ++n) {
+        std::vector<float> f(n);
+        std::vector<double> d(n);
+        std::vector<int32_t> i32(n);
+        for (std::size_t pos = 0; pos < n; ++pos) {
+            for (std::size_t i = 0; i < n; ++i) {
+                i32[i] = int32_t(i*7 % 5) - 2;
+                if (i == pos) i32[i] = 9;
+                if (i == n - 1 - pos) i32[i] = -9;
+                f[i] = float(i32[i]); d[i] = double(i32[i]);
+            }
+            sg_assert(sg_argmax(i32.data(), n) == std::size_t(
+                std::max_element(i32.begin(), i32.end()) - i32.begin()));
+            sg_assert(sg_argmin(f.data(), n) == std::size_t(
+                std::min_element(f.begin(), f.end()) - f.begin()));
+            sg_assert(sg_argmax(d.data(), n) == std::size_t(
+                std::max_element(d.begin(), d.end()) - d.begin()));
+            sg_assert(sg_find_first_if(f.data(), n,
+                [](const Vec_ps x) { return x > 8.0f; }) == std::size_t(
+                    std::find(f.begin(), f.end(), 9.0f) - f.begin()));
+            sg_assert(sg_find_first_if(d.data(), n,
+                [](const Vec_pd x) { return x < -8.0; }) == n - 1 - pos);
+            sg_assert(sg_find_first_if(i32.data(), n,
+                [](const Vec_pi32 x) { return x > 100; }) == n);
+        }
+    }
+    {
+        const float f[7] = { 1.0f, 3.0f, 3.0f, 2.0f, 3.0f, -1.0f, 3.0f };
+        sg_assert(sg_argmax(f, 7) == 1 && sg_argmin(f, 7) == 5);
+        sg_assert(sg_argmax(f, 0) == 0);
+        const float nan_first[6] = { NAN, 1.0f, 2.0f, 0.0f, 5.0f, 1.0f };
+        sg_assert(sg_argmax(nan_first, 6) < 6);
+        const int64_t l[3] = { 4, 8, 8 };
+        sg_assert(sg_argmax(l, 3) == 1 && sg_argmin(l, 3) == 0);
+        sg_assert(sg_find_first_if(l, 3,
+            [](const Vec_pi64 x) { return x == 8; }) == 1);
+    }
+
+    // Sorting networks, against std::sort, with repeated values. Values are
+    // each key's original index
+    {
+        SGXorshift128Plus gen{11};
+        for (int32_t trial = 0; trial < 200; ++trial) {
+            int32_t keys[16], values[16], sorted[16];
+            float keys_f[16];
+            (gen.next_pi32() & 15).storeu(keys);
+            (gen.next_pi32() & 15).storeu(keys + 4);
+            (gen.next_pi32() & 15).storeu(keys + 8);
+            (gen.next_pi32() & 15).storeu(keys + 12);
+            for (int32_t i = 0; i < 16; ++i) {
+                keys_f[i] = float(keys[i]) - 7.5f;
+            }
+
+            std::copy(keys, keys + 4, sorted);
+            std::sort(sorted, sorted + 4);
+            sg_assert(sg_sort4(Vec_pi32::loadu(keys)).debug_eq(
+                Vec_pi32::loadu(sorted)));
+            Vec_ps k0 = Vec_ps::loadu(keys_f);
+            Vec_pi32 v0{3, 2, 1, 0};
+            sg_sort4(k0, v0);
+            sg_assert(k0.debug_eq(Vec_pi32::loadu(sorted).to<Vec_ps>() -
+                7.5f));
+            v0.storeu(values);
+            for (int32_t i = 0; i < 4; ++i) {
+                sg_assert(keys_f[values[i]] == float(sorted[i]) - 7.5f);
+            }
+
+            std::copy(keys, keys + 8, sorted);
+            std::sort(sorted, sorted + 8);
+            Vec_pi32 a = Vec_pi32::loadu(keys), b = Vec_pi32::loadu(keys + 4);
+            sg_sort8(a, b);
+            sg_assert(a.debug_eq(Vec_pi32::loadu(sorted)) &&
+                b.debug_eq(Vec_pi32::loadu(sorted + 4)));
+            a = Vec_pi32::loadu(keys); b = Vec_pi32::loadu(keys + 4);
+            Vec_pi32 va{3, 2, 1, 0}, vb{7, 6, 5, 4};
+            sg_sort8(a, b, va, vb);
+            sg_assert(a.debug_eq(Vec_pi32::loadu(sorted)) &&
+                b.debug_eq(Vec_pi32::loadu(sorted + 4)));
+            va.storeu(values); vb.storeu(values + 4);
+            for (int32_t i = 0; i < 8; ++i) {
+                sg_assert(keys[values[i]] == sorted[i]);
+            }
+
+            std::copy(keys, keys + 16, sorted);
+            std::sort(sorted, sorted + 16);
+            Vec_ps f[4];
+            Vec_pi32 v[4];
+            for (int32_t i = 0; i < 4; ++i) {
+                f[i] = Vec_ps::loadu(keys_f + 4*i);
+                v[i] = Vec_pi32{3, 2, 1, 0} + 4*i;
+            }
+            sg_sort16(f[0], f[1], f[2], f[3], v[0], v[1], v[2], v[3]);
+            for (int32_t i = 0; i < 4; ++i) {
+                sg_assert(f[i].debug_eq(Vec_pi32::loadu(sorted + 4*i)
+                    .to<Vec_ps>() - 7.5f));
+                v[i].storeu(values + 4*i);
+            }
+            for (int32_t i = 0; i < 16; ++i) {
+                sg_assert(keys_f[values[i]] == float(sorted[i]) - 7.5f);
+            }
+            for (int32_t i = 0; i < 4; ++i) f[i] = Vec_ps::loadu(keys_f + 4*i);
+            sg_sort16(f[0], f[1], f[2], f[3]);
+            for (int32_t i = 0; i < 4; ++i) {
+                sg_assert(f[i].debug_eq(Vec_pi32::loadu(sorted + 4*i)
+                    .to<Vec_ps>() - 7.5f));
+            }
+
+            const std::size_t n = std::size_t(trial % 17);
+            std::copy(keys, keys + n, sorted);
+            sg_sort_small(keys, n);
+            std::sort(sorted, sorted + n);
+            sg_assert(std::equal(keys, keys + n, sorted));
+        }
+    }
+
+    // Merge, against std::merge, with both halves of one array
+    for (std::size_t na = 0; na < 30; na += 3) {
+        for (std::size_t nb = 0; nb < 30; nb += 5) {
+            std::vector<float> in(na + nb), out(na + nb), expected(na + nb);
+            for (std::size_t i = 0; i < in.size(); ++i) {
+                in[i] = float((i*i*7 + na) % 11);
+            }
+            std::sort(in.begin(), in.begin() + na);
+            std::sort(in.begin() + na, in.end());
+            sg_merge(in.data(), na, in.data() + na, nb, out.data());
+            std::merge(in.begin(), in.begin() + na, in.begin() + na, in.end(),
+                expected.begin());
+            sg_assert(out == expected);
+        }
+    }
+    {
+        // Runs that interleave unevenly
+        const int32_t a[] = { 0, 1, 2, 3, 5, 50, 51, 52, 53, 54, 55, 56 };
+        const int32_t b[] = { 4, 4, 4, 4, 6 };
+        int32_t out[17], expected[17];
+        sg_merge(a, 12, b, 5, out);
+        std::merge(a, a + 12, b, b + 5, expected);
+        sg_assert(std::equal(out, out + 17, expected));
+    }
+
+    // Median filters against std::nth_element, with repeated values, serial
+    // and parallel
+    for (std::size_t taps = 3; taps <= 9; taps += 2) {
+        const std::size_t n = 203;
+        std::vector<float> in_f(n + taps - 1), out_f(n), out_f3(n);
+        std::vector<int32_t> in_i(n + taps - 1), out_i(n);
+        for (std::size_t i = 0; i < in_f.size(); ++i) {
+            in_i[i] = int32_t((i*i*5 + i*3) % 17) - 8;
+            in_f[i] = 0.5f*float(in_i[i]);
+        }
+        sg_median_filter(in_f.data(), taps, out_f.data(), n);
+        sg_median_filter(in_f.data(), taps, out_f3.data(), n, 3);
+        sg_median_filter(in_i.data(), taps, out_i.data(), n);
+        sg_assert(out_f == out_f3);
+        for (std::size_t i = 0; i < n; ++i) {
+            int32_t window[9];
+            std::copy(in_i.begin() + i, in_i.begin() + i + taps, window);
+            std::nth_element(window, window + taps/2, window + taps);
+            sg_assert(out_i[i] == window[taps/2]);
+            sg_assert(out_f[i] == 0.5f*float(window[taps/2]));
+        }
+    }
+    {
+        // An impulse is removed, and a step is kept
+        const double in[] = { 0.0, 0.0, 9.0, 0.0, 0.0, 1.0, 1.0, 1.0 };
+        double out[6];
+        sg_median_filter(in, 3, out, 6);
+        sg_assert(out[0] == 0.0 && out[1] == 0.0 && out[2] == 0.0 &&
+            out[3] == 0.0 && out[4] == 1.0 && out[5] == 1.0);
+    }
+
+    // Histograms against a scalar loop, serial and parallel, with values out
+    // of range and NaN
+    {
+        const std::size_t n = 1003;
+        std::vector<float> f(n);
+        std::vector<int32_t> i32(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            i32[i] = int32_t((i*i*37 + i) % 2001) - 1000;
+            f[i] = 0.125f*float(i32[i]);
+        }
+        f[10] = NAN; i32[11] = INT32_MIN; i32[12] = INT32_MAX;
+        uint32_t expected_f[24] = {}, expected_i[7] = {};
+        for (std::size_t i = 0; i < n; ++i) {
+            const float bin = (f[i] + 100.0f)*0.125f;
+            expected_f[f[i] != f[i] || bin < 0.0f ? 0 : bin >= 23.0f ? 23 :
+                int32_t(bin)] += 2;
+            expected_i[std::min<int64_t>(6, std::max<int64_t>(0,
+                int64_t(i32[i]) + 3))] += 2;
+        }
+        for (std::size_t threads = 1; threads <= 4; threads += 3) {
+            uint32_t counts_f[24] = {}, counts_i[7] = {};
+            // Counts are added to
+            sg_histogram(f.data(), n, -100.0f, 92.0f, counts_f, 24, threads);
+            sg_histogram(f.data(), n, -100.0f, 92.0f, counts_f, 24, threads);
+            sg_histogram(i32.data(), n, -3, counts_i, 7, threads);
+            sg_histogram(i32.data(), n, -3, counts_i, 7, threads);
+            sg_assert(std::equal(counts_f, counts_f + 24, expected_f));
+            sg_assert(std::equal(counts_i, counts_i + 7, expected_i));
+        }
+        const float x[] = { -1.0f, 0.5f, 7.0f, 0.25f };
+        uint32_t counts[3] = {};
+        sg_histogram(x, 0, 0.0f, 1.0f, counts, 3);
+        sg_histogram(x, 3, 0.0f, 1.0f, counts, 3);
+        sg_assert(counts[0] == 1 && counts[1] == 1 && counts[2] == 1);
+    }
+
+    // Dot products and sums: exact for small integers in every mode, for
+    // lengths with and without a partial vector
+    {
+        const SGSumMode modes[] = { SGSumMode::fast, SGSumMode::widened,
+            SGSumMode::kahan, SGSumMode::pairwise };
+        for (std::size_t n = 0; n < 700; n += 53) {
+            std::vector<float> a(n), b(n);
+            double dot = 0.0, sum = 0.0, sum_sq = 0.0;
+            for (std::size_t i = 0; i < n; ++i) {
+                a[i] = float(int32_t(i % 7) - 3);
+                b[i] = float(int32_t(i % 5) - 1);
+                dot += double(a[i])*b[i];
+                sum += a[i];
+                sum_sq += double(a[i])*a[i];
+            }
+            for (const SGSumMode mode : modes) {
+                sg_assert(sg_dot(a.data(), b.data(), n, mode) == dot);
+                sg_assert(sg_sum(a.data(), n, mode) == sum);
+                sg_assert(sg_sum_sq(a.data(), n, mode) == sum_sq);
+            }
+        }
+    }
+    {
+        // Precision: 0.1f summed a million times, which float accumulation
+        // gets wrong in the 4th significant figure. Every mode but fast gets
+        // close to the double precision result
+        const std::size_t n = 1000003;
+        const std::vector<float> a(n, 0.1f), ones(n, 1.0f);
+        const double expected = double(n)*double(0.1f);
+        const double fast = sg_sum(a.data(), n);
+        sg_assert(std::abs(fast - expected) < 1e-2*expected);
+        sg_assert(std::abs(sg_sum(a.data(), n, SGSumMode::widened) -
+            expected) < 1e-12*expected);
+        sg_assert(std::abs(sg_sum(a.data(), n, SGSumMode::kahan) -
+            expected) < 1e-7*expected);
+        sg_assert(std::abs(sg_sum(a.data(), n, SGSumMode::pairwise) -
+            expected) < 1e-6*expected);
+        sg_assert(std::abs(sg_dot(a.data(), ones.data(), n,
+            SGSumMode::widened) - expected) < 1e-12*expected);
+        sg_assert(std::abs(sg_sum_sq(a.data(), n, SGSumMode::widened) -
+            double(n)*double(0.1f)*double(0.1f)) < 1e-12*expected);
+    }
+    {
+        float x[7] = { 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f },
+            y[7] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+        sg_axpy(0.5f, x, y, 7);
+        sg_scale(2.0f, y, 7);
+        for (int32_t i = 0; i < 7; ++i) sg_assert(y[i] == float(i + 3));
+        double d[3] = { 1.0, 2.0, 3.0 };
+        sg_axpy(-1.0, d, d, 3);
+        sg_scale(3.0, d, 2);
+        sg_assert(d[0] == 0.0 && d[1] == 0.0 && d[2] == 0.0);
+    }
+}
+
+#endif